@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+"""
+
+from __future__ import (absolute_import, division,
+                        print_function, unicode_literals)
+import argparse
+
+import numpy
+
+LEVELS = ['transaction', 'message', 'packet']
+
+
+def load(filename):
+  """Maps a record table (.rtab) written by ssparse.
+
+  Returns the level and a dict of numpy arrays by column name. The arrays view
+  the mapped file when it holds a single row group.
+  """
+  data = numpy.memmap(filename, dtype=numpy.uint8, mode='r')
+  if bytes(data[:8]) != b'RTAB0001':
+    raise ValueError('not a record table: ' + filename)
+  words = data.view('<u8')
+  level = LEVELS[int(words[1])]
+  count = int(words[2])
+  columns = []
+  for col in range(count):
+    start = 24 + 32 * col
+    name = bytes(data[start:start + 24]).rstrip(b'\0').decode()
+    dtype = '<f8' if int(words[start // 8 + 3]) == 1 else '<u8'
+    columns.append((name, dtype))
+
+  # row groups
+  groups = {name: [] for name, _ in columns}
+  pos = 3 + 4 * count
+  while pos < len(words):
+    rows = int(words[pos])
+    pos += 1
+    for name, dtype in columns:
+      groups[name].append(words[pos:pos + rows].view(dtype))
+      pos += rows
+  table = {}
+  for name, dtype in columns:
+    if len(groups[name]) == 1:
+      table[name] = groups[name][0]
+    else:
+      table[name] = numpy.concatenate(groups[name] or
+                                      [numpy.empty(0, dtype)])
+  return level, table
+
+
+def main(args):
+  level, table = load(args.infile)
+  rows = len(next(iter(table.values())))
+  print('{0} table with {1} rows'.format(level, rows))
+  for name, values in table.items():
+    print('  {0} ({1})'.format(name, values.dtype))
+  if args.csv:
+    names = list(table.keys())
+    with open(args.csv, 'w') as out:
+      out.write(','.join(names) + '\n')
+      for row in range(rows):
+        out.write(','.join(str(table[name][row]) for name in names) + '\n')
+
+
+if __name__ == '__main__':
+  ap = argparse.ArgumentParser()
+  ap.add_argument('infile',
+                  help='input record table (.rtab)')
+  ap.add_argument('-c', '--csv', type=str,
+                  help='also write the table as csv')
+  args = ap.parse_args()
+  main(args)
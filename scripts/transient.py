@@ -33,174 +33,41 @@
 from __future__ import (absolute_import, division,
                         print_function, unicode_literals)
 import argparse
-import handycsv
-import gzip
-import math
-import numpy
-import os
 import subprocess
 import sys
-import tempfile
 
 def main(args):
-  TOLERANCE = 1e-6
-
-  # read file to find start and end
-  filename = args.infile
-  lines = 0
-  start = float('inf')
-  end = 0
-  opener = gzip.open if filename.endswith('.gz') else open
-  with opener(filename, 'rb') as fd:
-    for line in fd:
-      line = line.decode('utf-8').strip()
-      if line.find('F') != -1:
-        cols = line.split(',')
-        send_time = int(cols[2])
-        recv_time = int(cols[2])
-        if args.scalar:
-          send_time *= args.scalar
-          recv_time *= args.scalar
-        if send_time < start:
-          start = send_time
-        if recv_time > end:
-          end = recv_time
-
   # check times
-  if args.mintime and args.maxtime:
+  if args.mintime is not None and args.maxtime is not None:
     assert args.mintime <= args.maxtime, "start must be <= end"
-  if args.mintime:
-    assert (args.mintime < end + TOLERANCE and
-            args.mintime >= start - TOLERANCE) \
-            ("Start [" + str(args.mintime) + "] not in sim range: " +
-             str(s) + "-" + str(e))
-    start = args.mintime
-  if args.maxtime:
-    assert (args.maxtime > start - TOLERANCE and
-            args.maxtime <= e + TOLERANCE) \
-            ("End [" + str(args.maxtime) + "] not in sim range: " +
-             + str(s) + "-" + str(e))
-    end = args.maxtime
-  if start == float('inf') or end == 0:
-    outfile = args.outfile
-    opener = gzip.open if outfile.endswith('.gz') else open
-    with opener(outfile, 'wb') as fd:
-      fd.write(''.encode('utf-8'))
-    exit(0)
-
-  # create buckets
-  numBins = args.buckets
-  binWidth = (end - start) / numBins
-  binTimesOrg = numpy.linspace(start, end - binWidth, numBins)
-  binTimes = numpy.append(binTimesOrg, end)
-
-  print("Running ssparse for range {0}-{1} with {2} bins"
-        .format(start, end, numBins))
-  # call bin -> tmp file
-  hopFiles = []
-  latFiles = []
-  error = None
-  for idx in range(numBins):
-    b_start = binTimes[idx]
-    b_end = binTimes[idx+1]
-
-    hopfile_fd, hopfile_name = tempfile.mkstemp(prefix='trans_')
-    latfile_fd, latfile_name = tempfile.mkstemp(prefix='trans_')
-    os.close(hopfile_fd)
-    os.close(latfile_fd)
-    hopFiles.append(hopfile_name)
-    latFiles.append(latfile_name)
-
-    # ssparse cmd
-    cmd = ('{0} -c {1} -l {2} -f +{3}={4}-{5} {6}'
-           .format(args.ssparse,
-                   hopfile_name,
-                   latfile_name,
-                   args.time, b_start, b_end,
-                   args.infile))
-    if args.scalar:
-      cmd += (' -s {0}'.format(args.scalar))
-
-    if args.filters:
-      for filter in args.filters:
-        cmd += ' -f {0}'.format(filter)
 
+  # the default bounds come from the index of the log
+  if args.mintime is None or args.maxtime is None:
     try:
-      subprocess.check_call(cmd, shell=True)
+      subprocess.check_call([args.ssparse, 'index', args.infile])
     except subprocess.CalledProcessError:
-      error = True
-    if error:
-      break
+      exit(-1)
+
+  # ssparse bins the packets in a single pass
+  cmd = [args.ssparse, '--transient', args.outfile,
+         '--bins', str(args.buckets), '--bin-time', args.time]
+  if args.mintime is not None:
+    cmd += ['--bin-start', str(args.mintime)]
+  if args.maxtime is not None:
+    cmd += ['--bin-end', str(args.maxtime)]
+  if args.scalar:
+    cmd += ['-s', str(args.scalar)]
+  if args.filters:
+    for filter in args.filters:
+      cmd += ['-f', filter]
+  cmd.append(args.infile)
 
-  if error:
-    assert(len(hopFiles) == len(latFiles))
-    for hopfile, latfile in zip(hopFiles,latFiles):
-      os.remove(hopfile)
-      os.remove(latfile)
+  print("Running ssparse with {0} bins".format(args.buckets))
+  try:
+    subprocess.check_call(cmd)
+  except subprocess.CalledProcessError:
     exit(-1)
 
-  # headers
-  uColsLat = []
-  gridsLat = []
-  uColsHop = []
-  gridsHop = []
-  assert(len(hopFiles) == len(latFiles))
-  for hopfile, latfile in zip(hopFiles,latFiles):
-    gLat = handycsv.GridStats.read(latfile)
-    gridsLat.append(gLat)
-    currColsLat = gLat.column_names()
-
-    gHop = handycsv.GridStats.read(hopfile)
-    gridsHop.append(gHop)
-    currColsHop = gHop.column_names()
-
-    for x in currColsLat:
-      if x not in uColsLat:
-        uColsLat.append(x)
-
-    for x in currColsHop:
-      if x not in uColsHop:
-        uColsHop.append(x)
-
-  # sort hops
-  PerHops = []
-  PerMinHops = []
-  PerNonMinHops = []
-  for x in uColsHop:
-    if "PerHops" in x:
-      PerHops.append(x)
-    if "PerMinHops" in x:
-      PerMinHops.append(x)
-    if "PerNonMinHops" in x:
-      PerNonMinHops.append(x)
-
-  sColsHop = ['AveHops']
-  sColsHop.extend(PerHops)
-  sColsHop.append('AveMinHops')
-  sColsHop.append('PerMinimal')
-  sColsHop.extend(PerMinHops)
-  sColsHop.append('AveNonMinHops')
-  sColsHop.append('PerNonMinimal')
-  sColsHop.extend(PerNonMinHops)
-
-  # delete tmp files
-  for hopfile, latfile in zip(hopFiles,latFiles):
-    os.remove(hopfile)
-    os.remove(latfile)
-
-  # write out.csv
-  fGrid = handycsv.GridStats.create('Time', binTimesOrg, sColsHop + uColsLat)
-
-  assert len(gridsLat) == len(binTimesOrg) and len(gridsHop) == len(binTimesOrg)
-  for gridLat, gridHop, binTime in zip(gridsLat, gridsHop, binTimesOrg):
-    for colHop in uColsHop:
-      value = gridHop.get('Packet', colHop, default='nan')
-      fGrid.set(binTime, colHop, value)
-    for colLat in uColsLat:
-      value = gridLat.get('Packet', colLat, default='nan')
-      fGrid.set(binTime, colLat, value)
-  fGrid.write(args.outfile)
-
 
 if __name__ == '__main__':
   ap = argparse.ArgumentParser()
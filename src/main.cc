@@ -29,27 +29,210 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include <ex/Exception.h>
-#include <fio/InFile.h>
 #include <prim/prim.h>
-#include <strop/strop.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <tclap/CmdLine.h>
+#include <unistd.h>
 
+#include <cstdio>
 #include <string>
 #include <vector>
 
+#include "parse/BinaryFormat.h"
+#include "parse/BinaryReader.h"
+#include "parse/BinaryWriter.h"
+#include "parse/BlockIndex.h"
+#include "parse/Codec.h"
 #include "parse/Engine.h"
-#include "parse/util.h"
+#include "parse/IndexBuilder.h"
+#include "parse/IndexedParser.h"
+#include "parse/ParallelParser.h"
+#include "parse/Parser.h"
+#include "parse/Pipeline.h"
+#include "parse/QuantileSketch.h"
+#include "parse/Query.h"
+#include "parse/Reader.h"
+#include "parse/Transient.h"
+
+// converts a text message log into the binary format
+static s32 convert(s32 _argc, char** _argv) {
+  std::string inputFile;
+  std::string outputFile;
+  u32 threads;
+
+  std::string description =
+      ("Convert SuperSim output files (.mpf) to the binary format (.mpfb).");
+
+  try {
+    // create the command line parser
+    TCLAP::CmdLine cmd(description, ' ', "1.0");
+
+    // define command line args
+    TCLAP::UnlabeledValueArg<std::string> inputFileArg(
+        "inputfile", "input file to be converted (- for stdin)", true, "",
+        "filename", cmd);
+    TCLAP::UnlabeledValueArg<std::string> outputFileArg(
+        "outputfile", "output binary file", true, "", "filename", cmd);
+    TCLAP::ValueArg<u32> threadsArg("", "threads", "number of threads", false,
+                                    1, "u32", cmd);
+
+    // parse the command line
+    cmd.parse(_argc, _argv);
+
+    // copy the values out to variables
+    inputFile = inputFileArg.getValue();
+    outputFile = outputFileArg.getValue();
+    threads = threadsArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    throw std::runtime_error(e.error().c_str());
+  }
+
+  // feed the contents of the file into the binary writer
+  Reader reader(inputFile, threads);
+  BinaryWriter writer(outputFile);
+  Parser parser(&writer);
+  parser.parse(&reader);
+  writer.complete();
+
+  return 0;
+}
+
+// writes the sidecar index of a text message log
+static s32 index(s32 _argc, char** _argv) {
+  std::string inputFile;
+  std::string indexFile;
+  u64 blockSize;
+
+  std::string description =
+      ("Write the sidecar index (.ssi) of a SuperSim output file (.mpf) which "
+       "lets filtered runs skip the irrelevant parts of the file.");
+
+  try {
+    // create the command line parser
+    TCLAP::CmdLine cmd(description, ' ', "1.0");
+
+    // define command line args
+    TCLAP::UnlabeledValueArg<std::string> inputFileArg(
+        "inputfile", "input file to be indexed", true, "", "filename", cmd);
+    TCLAP::UnlabeledValueArg<std::string> indexFileArg(
+        "indexfile", "output index file (default: <inputfile>.ssi)", false,
+        "", "filename", cmd);
+    TCLAP::ValueArg<u64> blockSizeArg("", "blocksize",
+                                      "text bytes per index block", false,
+                                      1 << 22, "u64", cmd);
+
+    // parse the command line
+    cmd.parse(_argc, _argv);
+
+    // copy the values out to variables
+    inputFile = inputFileArg.getValue();
+    indexFile = indexFileArg.getValue();
+    blockSize = blockSizeArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    throw std::runtime_error(e.error().c_str());
+  }
+
+  if (indexFile.empty()) {
+    indexFile = BlockIndex::defaultFilename(inputFile);
+  }
+  IndexBuilder builder(blockSize);
+  builder.build(inputFile).write(indexFile);
+
+  return 0;
+}
+
+// loads the index of the input file, the default index is only used if it
+// exists and is up to date
+static bool loadIndex(const std::string& _inputFile,
+                      const std::string& _indexFile, BlockIndex* _index) {
+  if (_inputFile == "-" || isBinaryFile(_inputFile)) {
+    if (!_indexFile.empty()) {
+      throw ex::Exception("Only plain and gzip files can be indexed: %s\n",
+                          _inputFile.c_str());
+    }
+    return false;
+  }
+  std::string indexFile = _indexFile;
+  if (indexFile.empty()) {
+    indexFile = BlockIndex::defaultFilename(_inputFile);
+    if (access(indexFile.c_str(), R_OK) != 0) {
+      return false;
+    }
+  }
+  _index->read(indexFile);
+  if (!_index->matches(_inputFile)) {
+    if (!_indexFile.empty()) {
+      throw ex::Exception("Index file is out of date: %s\n",
+                          indexFile.c_str());
+    }
+    return false;
+  }
+  return true;
+}
+
+// returns the text size of the input file if it is known ahead of time, else 0
+static u64 textSize(const std::string& _inputFile, const BlockIndex& _index,
+                    bool _indexed) {
+  if (_indexed) {
+    return _index.textSize();
+  }
+  struct stat st;
+  if (_inputFile == "-" || stat(_inputFile.c_str(), &st) != 0 ||
+      !S_ISREG(st.st_mode)) {
+    return 0;
+  }
+  // only plain files are their text
+  s32 fd = open(_inputFile.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  char magic[FORMAT_MAGIC_SIZE];
+  ssize_t size = pread(fd, magic, sizeof(magic), 0);
+  close(fd);
+  if (size < 0 || detectFormat(magic, size) != Format::PLAIN) {
+    return 0;
+  }
+  return st.st_size;
+}
 
 s32 main(s32 _argc, char** _argv) {
+  // subcommands
+  if (_argc > 1 && std::string(_argv[1]) == "convert") {
+    return convert(_argc - 1, _argv + 1);
+  }
+  if (_argc > 1 && std::string(_argv[1]) == "index") {
+    return index(_argc - 1, _argv + 1);
+  }
+
   std::string inputFile;
   std::string transactionFile;
   std::string messageFile;
   std::string packetFile;
   std::string latencyfile;
   std::string hopcountfile;
+  std::string matrixFile;
+  std::string throughputFile;
   f64 scalar;
   bool packetHeaderLatency;
+  u32 threads;
+  bool pipeline;
+  std::string indexFile;
+  std::string transientFile;
+  u32 bins;
+  f64 binWidth;
+  std::string binTime;
+  std::string throughputBy;
+  f64 binStart;
+  f64 binEnd;
+  std::vector<std::string> queryStrs;
+  std::string queriesFile;
+  bool filterStats;
   std::vector<std::string> filterStrs;
+  std::vector<std::string> whereStrs;
+  bool sketch;
+  f64 sketchError;
+  bool fixedTimes;
 
   std::string description =
       ("Parse and analyze SuperSim output files (.mpf). "
@@ -61,7 +244,9 @@ s32 main(s32 _argc, char** _argv) {
 
     // define command line args
     TCLAP::UnlabeledValueArg<std::string> inputFileArg(
-        "inputfile", "input file to be parsed", true, "", "filename", cmd);
+        "inputfile", "input file to be parsed (- for stdin)", true, "",
+        "filename", cmd);
+    // record outputs named *.rtab are written as record tables
     TCLAP::ValueArg<std::string> transactionFileArg(
         "t", "transactionfile", "output transaction latencies file", false, "",
         "filename", cmd);
@@ -77,12 +262,72 @@ s32 main(s32 _argc, char** _argv) {
     TCLAP::ValueArg<std::string> hopcountFileArg(
         "c", "hopcountfile", "output aggregate hopcounts file", false, "",
         "filename", cmd);
+    TCLAP::ValueArg<std::string> matrixFileArg(
+        "", "matrix", "output source x destination traffic matrix file", false,
+        "", "filename", cmd);
+    TCLAP::ValueArg<std::string> throughputFileArg(
+        "", "throughput", "output delivered counts per time bin file", false,
+        "", "filename", cmd);
     TCLAP::ValueArg<f64> scalarArg("s", "scalar", "latency scalar", false, 1.0,
                                    "f64", cmd);
     TCLAP::SwitchArg packetHeaderLatencyArg(
         "", "headerlatency", "use header latency for packets", cmd, false);
     TCLAP::MultiArg<std::string> filterStrsArg(
         "f", "filter", "acceptance filters", false, "filter description", cmd);
+    TCLAP::MultiArg<std::string> whereStrsArg(
+        "", "where", "filter expression, e.g. '(app=0 | pc=2) & !op=7'", false,
+        "expression", cmd);
+    TCLAP::MultiArg<std::string> queryStrsArg(
+        "", "query", "additional query (name:filters:outputs)", false,
+        "query description", cmd);
+    TCLAP::ValueArg<std::string> queriesFileArg(
+        "", "queries", "file of additional queries, one per line", false, "",
+        "filename", cmd);
+    TCLAP::SwitchArg sketchArg(
+        "", "sketch", "estimate latency percentiles in bounded memory", cmd,
+        false);
+    TCLAP::ValueArg<f64> sketchErrorArg(
+        "", "sketch-error", "relative error of sketched percentiles", false,
+        QuantileSketch::DEFAULT_ERROR, "f64", cmd);
+    TCLAP::SwitchArg fixedTimesArg(
+        "", "fixed-times",
+        "write record times with 6 decimals like earlier versions", cmd,
+        false);
+    TCLAP::SwitchArg filterStatsArg(
+        "", "filter-stats", "print filter evaluation and rejection counts",
+        cmd, false);
+    TCLAP::ValueArg<u32> threadsArg("", "threads", "number of threads", false,
+                                    1, "u32", cmd);
+    TCLAP::SwitchArg pipelineArg(
+        "", "pipeline", "read, decode, and analyze on separate threads", cmd,
+        false);
+    TCLAP::ValueArg<std::string> indexFileArg(
+        "", "index", "sidecar index file (default: <inputfile>.ssi if present)",
+        false, "", "filename", cmd);
+    TCLAP::ValueArg<std::string> transientFileArg(
+        "", "transient", "output time-binned packet aggregates file", false,
+        "", "filename", cmd);
+    TCLAP::ValueArg<u32> binsArg("", "bins", "number of time bins", false, 40,
+                                 "u32", cmd);
+    TCLAP::ValueArg<f64> binWidthArg(
+        "", "bin-width",
+        "width of the time bins (overrides --bins, required by --throughput)",
+        false, 0.0, "f64", cmd);
+    TCLAP::ValueArg<std::string> binTimeArg(
+        "", "bin-time", "packet time used for binning (send or recv)", false,
+        "send", "type", cmd);
+    TCLAP::ValueArg<f64> binStartArg(
+        "", "bin-start",
+        "start of the first bin (default: first flit send, needs an index)",
+        false, -1.0, "f64", cmd);
+    TCLAP::ValueArg<f64> binEndArg(
+        "", "bin-end",
+        "end of the last bin (default: last flit receive, needs an index)",
+        false, -1.0, "f64", cmd);
+    TCLAP::ValueArg<std::string> throughputByArg(
+        "", "throughput-by",
+        "split the throughput by destination or application (none, dst, app)",
+        false, "none", "type", cmd);
 
     // parse the command line
     cmd.parse(_argc, _argv);
@@ -94,85 +339,134 @@ s32 main(s32 _argc, char** _argv) {
     packetFile = packetFileArg.getValue();
     latencyfile = latencyFileArg.getValue();
     hopcountfile = hopcountFileArg.getValue();
+    matrixFile = matrixFileArg.getValue();
+    throughputFile = throughputFileArg.getValue();
     scalar = scalarArg.getValue();
     packetHeaderLatency = packetHeaderLatencyArg.getValue();
     filterStrs = filterStrsArg.getValue();
+    whereStrs = whereStrsArg.getValue();
+    queryStrs = queryStrsArg.getValue();
+    queriesFile = queriesFileArg.getValue();
+    filterStats = filterStatsArg.getValue();
+    sketch = sketchArg.getValue();
+    sketchError = sketchErrorArg.getValue();
+    fixedTimes = fixedTimesArg.getValue();
+    threads = threadsArg.getValue();
+    pipeline = pipelineArg.getValue();
+    indexFile = indexFileArg.getValue();
+    transientFile = transientFileArg.getValue();
+    bins = binsArg.getValue();
+    binWidth = binWidthArg.getValue();
+    binTime = binTimeArg.getValue();
+    binStart = binStartArg.getValue();
+    binEnd = binEndArg.getValue();
+    throughputBy = throughputByArg.getValue();
   } catch (TCLAP::ArgException& e) {
     throw std::runtime_error(e.error().c_str());
   }
 
-  // create a processing engine
-  Engine engine(transactionFile, messageFile, packetFile, latencyfile,
-                hopcountfile, scalar, packetHeaderLatency, filterStrs);
-
   // create input file object
   if (inputFile.size() == 0) {
     throw ex::Exception("How do you expect to open a file without a name?\n");
   }
-  fio::InFile inFile(inputFile);
 
-  // feed the contents of the file into the processing engine line by line
-  std::string line;
-  std::vector<std::string> words;
-  for (s64 lineNum = 1; true; lineNum++) {
-    fio::InFile::Status sts = inFile.getLine(&line);
-    if (sts == fio::InFile::Status::ERROR) {
-      throw ex::Exception("Error while reading input file\n");
+  // an index lets filtered runs skip the irrelevant blocks
+  BlockIndex blockIndex;
+  bool indexed = loadIndex(inputFile, indexFile, &blockIndex);
+
+  // time-binned aggregates are computed in the same pass, the default bounds
+  // are the flit times of the log which only an index knows ahead of it
+  std::shared_ptr<Transient> transient;
+  if (transientFile.size() > 0) {
+    bool recvTime;
+    if (binTime == "send" || binTime == "start") {
+      recvTime = false;
+    } else if (binTime == "recv" || binTime == "end") {
+      recvTime = true;
+    } else {
+      throw ex::Exception("Invalid bin time: %s\n", binTime.c_str());
     }
-    if (sts == fio::InFile::Status::END) {
-      break;
+    if (binStart < 0 || binEnd < 0) {
+      if (!indexed) {
+        throw ex::Exception(
+            "The bin bounds of an unindexed input must be given with "
+            "--bin-start and --bin-end: %s\n",
+            inputFile.c_str());
+      }
+      u64 minSendTime, maxRecvTime;
+      if (blockIndex.flitTimes(&minSendTime, &maxRecvTime)) {
+        if (binStart < 0) {
+          binStart = minSendTime * scalar;
+        }
+        if (binEnd < 0) {
+          binEnd = maxRecvTime * scalar;
+        }
+      }
     }
+    transient = std::make_shared<Transient>(transientFile, recvTime, bins,
+                                            binWidth, binStart, binEnd);
+  }
 
-    line = strop::trim(line);
-    words.clear();
-    u64 wordCount = split(line, &words);
-    if (wordCount == 0) {
-      continue;  // probably the last line
+  // the outputs given directly form the first query, it is left out if only
+  // additional queries have outputs
+  Query query;
+  query.filters = filterStrs;
+  query.expressions = whereStrs;
+  query.transactionsFile = transactionFile;
+  query.messagesFile = messageFile;
+  query.packetsFile = packetFile;
+  query.latencyFile = latencyfile;
+  query.hopCountFile = hopcountfile;
+  query.matrixFile = matrixFile;
+  query.throughputFile = throughputFile;
+  query.transient = transient;
+  std::vector<Query> queries;
+  if (queriesFile.size() > 0) {
+    queries = Query::readFile(queriesFile);
+  }
+  for (const std::string& queryStr : queryStrs) {
+    queries.push_back(Query::parse(queryStr));
+  }
+  if (queries.empty() || query.hasOutputs()) {
+    queries.insert(queries.begin(), query);
+  }
+  for (Query& each : queries) {
+    if (sketch) {
+      each.latencySketch = sketchError;
     }
+    each.fixedTimes = fixedTimes;
+    each.throughputBinWidth = binWidth;
+    each.throughputGrouping = Throughput::parseGrouping(throughputBy);
+  }
 
-    if (words.at(0) == "+T") {
-      // parse the transaction start command
-      u64 transId = toU64(words.at(1));
-      u64 transStart = toU64(words.at(2));
-      engine.transactionStart(transId, transStart);
-    } else if (words.at(0) == "-T") {
-      // parse the transaction end command
-      u64 transId = toU64(words.at(1));
-      u64 transEnd = toU64(words.at(2));
-      engine.transactionEnd(transId, transEnd);
-    } else if (words.at(0) == "+M") {
-      // parse the message start command
-      u32 msgId = toU32(words.at(1));
-      u32 msgSrc = toU32(words.at(2));
-      u32 msgDst = toU32(words.at(3));
-      u64 transId = toU64(words.at(4));
-      u32 protocolClass = toU32(words.at(5));
-      u32 minimalHops = toU32(words.at(6));
-      u32 opCode = toU32(words.at(7));
-      engine.messageStart(msgId, msgSrc, msgDst, transId, protocolClass,
-                          minimalHops, opCode);
-    } else if (words.at(0) == "-M") {
-      // parse the message end command
-      engine.messageEnd();
-    } else if (words.at(0) == "+P") {
-      // parse the packet start command
-      u32 pktId = toU32(words.at(1));
-      u32 hopCount = toU32(words.at(2));
-      engine.packetStart(pktId, hopCount);
-    } else if (words.at(0) == "-P") {
-      // parse the packet end command
-      engine.packetEnd();
-    } else if (words.at(0) == "F") {
-      // parse the flit occurrence command
-      u32 flitId = toU32(words.at(1));
-      u64 flitSend = toU64(words.at(2));
-      u64 flitRecv = toU64(words.at(3));
-      engine.flit(flitId, flitSend, flitRecv);
-    } else {
-      throw ex::Exception("Invalid line command. File corrupted :(\n");
-    }
+  // create a processing engine
+  Engine engine(queries, scalar, packetHeaderLatency);
+  IndexedParser indexedParser(&engine, &blockIndex);
+  engine.reserve(textSize(inputFile, blockIndex, indexed));
+
+  // feed the contents of the file into the processing engine
+  if (inputFile != "-" && isBinaryFile(inputFile)) {
+    BinaryReader reader(inputFile);
+    reader.read(&engine);
+  } else if (indexed && indexedParser.skips()) {
+    indexedParser.parse(inputFile);
+  } else if (threads > 1) {
+    Reader reader(inputFile, threads);
+    ParallelParser parser(&engine, threads);
+    parser.parse(&reader);
+  } else if (pipeline) {
+    Reader reader(inputFile, threads);
+    Pipeline parser(&engine);
+    parser.parse(&reader);
+  } else {
+    Reader reader(inputFile, threads);
+    Parser parser(&engine);
+    parser.parse(&reader);
   }
   engine.complete();
+  if (filterStats) {
+    std::printf("%s", engine.filterStats().c_str());
+  }
 
   return 0;
 }
@@ -0,0 +1,231 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Aggregate.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+const f64 TOLERANCE = 1e-6;
+
+// yields the first and last non-zero bucket of a histogram
+static bool histogramRange(const std::vector<u64>& _histogram, u32* _first,
+                           u32* _last) {
+  for (u32 s = 0; s < _histogram.size(); s++) {
+    if (_histogram[s] != 0) {
+      *_first = s;
+      break;
+    }
+  }
+  for (s32 e = (s32)_histogram.size() - 1; e >= 0; e--) {
+    if (_histogram[e] != 0) {
+      *_last = e;
+      return true;
+    }
+  }
+  return false;
+}
+
+// adds the share of packets of each hop count in the histogram range
+static void histogramColumns(const std::string& _name,
+                             const std::vector<u64>& _histogram, u64 _count,
+                             bool _used, Columns* _columns) {
+  u32 first = 0;
+  u32 last = 0;
+  if (!_used || !histogramRange(_histogram, &first, &last)) {
+    return;
+  }
+  f64 cumulative = 0.0;
+  for (u32 i = first; i <= last; i++) {
+    f64 share = (f64)_histogram[i] / (f64)_count;
+    cumulative += share;
+    _columns->emplace_back(_name + std::to_string(i), std::to_string(share));
+  }
+  assert(cumulative <= (1.00 + TOLERANCE) &&
+         cumulative >= (1.00 - TOLERANCE));
+  (void)cumulative;
+}
+
+void hopCountColumns(const HopCounts& _hops, Columns* _columns) {
+  _columns->clear();
+  if (_hops.pktCount == 0) {
+    for (const char* name : {"AveHops", "AveMinHops", "PerMinimal",
+                             "AveNonMinHops", "PerNonMinimal"}) {
+      _columns->emplace_back(name, "nan");
+    }
+    return;
+  }
+  f64 count = (f64)_hops.pktCount;
+
+  // total
+  _columns->emplace_back("AveHops",
+                         std::to_string((f64)_hops.totalHops / count));
+  histogramColumns("PerHops", _hops.hopCounts, _hops.pktCount, true,
+                   _columns);
+
+  // minimal
+  _columns->emplace_back("AveMinHops",
+                         std::to_string((f64)_hops.minHops / count));
+  _columns->emplace_back("PerMinimal",
+                         std::to_string((f64)_hops.minPktCount / count));
+  histogramColumns("PerMinHops", _hops.minHopCounts, _hops.pktCount,
+                   _hops.minPktCount > 0, _columns);
+
+  // non minimal
+  _columns->emplace_back("AveNonMinHops",
+                         std::to_string((f64)_hops.nonMinHops / count));
+  _columns->emplace_back("PerNonMinimal",
+                         std::to_string((f64)_hops.nonMinPktCount / count));
+  histogramColumns("PerNonMinHops", _hops.nonMinHopCounts, _hops.pktCount,
+                   _hops.nonMinPktCount > 0, _columns);
+
+  assert(_hops.minPktCount + _hops.nonMinPktCount == _hops.pktCount);
+}
+
+// the latency statistics in column order
+static const char* LATENCY_NAMES[] = {"Minimum", "Maximum", "Median", "90th%",
+                                      "99th%", "99.9th%", "99.99th%",
+                                      "99.999th%", "Mean", "Variance",
+                                      "StdDev"};
+static const f64 PERCENTILES[] = {0.50, 0.90, 0.99, 0.999, 0.9999, 0.99999};
+
+// moves the values of the ascending distinct ranks [_first, _last) into
+// their sorted positions, each selection splits the range of the others
+template <typename T>
+static void selectRanks(std::vector<T>* _values, u64 _begin, u64 _end,
+                        const u64* _first, const u64* _last) {
+  if (_first == _last) {
+    return;
+  }
+  const u64* middle = _first + (_last - _first) / 2;
+  std::nth_element(_values->begin() + _begin, _values->begin() + *middle,
+                   _values->begin() + _end);
+  selectRanks(_values, _begin, *middle, _first, middle);
+  selectRanks(_values, *middle + 1, _end, middle + 1, _last);
+}
+
+// the latency columns of samples that are scaled by _scalar
+template <typename T>
+static void sampleColumns(std::vector<T>* _latencies, f64 _scalar,
+                          Columns* _columns) {
+  _columns->clear();
+  u64 size = _latencies->size();
+  _columns->emplace_back("Count", std::to_string(size));
+  if (size == 0) {
+    for (const char* name : LATENCY_NAMES) {
+      _columns->emplace_back(name, "nan");
+    }
+    return;
+  }
+
+  // minimum, maximum, mean, and variance in one pass, the sums are shifted
+  // by the first value so they don't cancel. Older versions summed the sorted
+  // latencies twice in double precision with mut::variance(), so the last
+  // printed digit of the variance can differ from their outputs.
+  const T* data = _latencies->data();
+  T minimum = data[0];
+  T maximum = data[0];
+  long double shift = data[0];
+  long double sum = 0.0;
+  long double squares = 0.0;
+  for (u64 idx = 0; idx < size; idx++) {
+    T value = data[idx];
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+    long double diff = value - shift;
+    sum += diff;
+    squares += diff * diff;
+  }
+  f64 mean = (f64)(shift + sum / size) * _scalar;
+  f64 variance = (f64)((squares - sum * sum / size) / size) * _scalar * _scalar;
+  f64 stdDev = std::sqrt(variance);
+
+  // the percentiles are selected rather than sorted
+  u64 pmax = size - 1;
+  std::vector<u64> ranks;
+  for (f64 percentile : PERCENTILES) {
+    ranks.push_back((u64)round(pmax * percentile));
+  }
+  std::vector<u64> distinct = ranks;
+  distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                 distinct.end());
+  selectRanks(_latencies, 0, size, distinct.data(),
+              distinct.data() + distinct.size());
+
+  std::vector<f64> values = {minimum * _scalar, maximum * _scalar};
+  for (u64 rank : ranks) {
+    values.push_back(_latencies->at(rank) * _scalar);
+  }
+  values.push_back(mean);
+  values.push_back(variance);
+  values.push_back(stdDev);
+  for (u32 idx = 0; idx < values.size(); idx++) {
+    _columns->emplace_back(LATENCY_NAMES[idx], std::to_string(values[idx]));
+  }
+}
+
+void latencyColumns(std::vector<f64>* _latencies, Columns* _columns) {
+  sampleColumns(_latencies, 1.0, _columns);
+}
+
+void latencyColumns(LatencySamples* _latencies, f64 _scalar,
+                    Columns* _columns) {
+  if (_latencies->wide()) {
+    sampleColumns(_latencies->wideSamples(), _scalar, _columns);
+  } else {
+    sampleColumns(_latencies->narrow(), _scalar, _columns);
+  }
+}
+
+void latencyColumns(const QuantileSketch& _sketch, Columns* _columns) {
+  _columns->clear();
+  _columns->emplace_back("Count", std::to_string(_sketch.count()));
+  std::vector<std::string> values;
+  if (_sketch.count() == 0) {
+    values.assign(sizeof(LATENCY_NAMES) / sizeof(LATENCY_NAMES[0]), "nan");
+  } else {
+    values.push_back(std::to_string(_sketch.minimum()));
+    values.push_back(std::to_string(_sketch.maximum()));
+    for (f64 percentile : PERCENTILES) {
+      values.push_back(std::to_string(_sketch.quantile(percentile)));
+    }
+    values.push_back(std::to_string(_sketch.mean()));
+    values.push_back(std::to_string(_sketch.variance()));
+    values.push_back(std::to_string(std::sqrt(_sketch.variance())));
+  }
+  for (u32 idx = 0; idx < values.size(); idx++) {
+    _columns->emplace_back(LATENCY_NAMES[idx], values[idx]);
+  }
+
+  // the bound of the percentile columns
+  _columns->emplace_back("RelativeError",
+                         std::to_string(_sketch.relativeError()));
+}
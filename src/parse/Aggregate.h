@@ -0,0 +1,60 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_AGGREGATE_H_
+#define PARSE_AGGREGATE_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parse/Partial.h"
+#include "parse/QuantileSketch.h"
+
+// the named values of an aggregate row
+typedef std::vector<std::pair<std::string, std::string> > Columns;
+
+// yields the columns of the packet hop count row
+void hopCountColumns(const HopCounts& _hops, Columns* _columns);
+
+// yields the columns of a latency row, reorders the latencies
+void latencyColumns(std::vector<f64>* _latencies, Columns* _columns);
+
+// the same for latencies in ticks, the values are scaled by _scalar
+void latencyColumns(LatencySamples* _latencies, f64 _scalar,
+                    Columns* _columns);
+
+// yields the columns of a latency row from a sketch, the percentiles are
+// estimates within the relative error given in the last column
+void latencyColumns(const QuantileSketch& _sketch, Columns* _columns);
+
+#endif  // PARSE_AGGREGATE_H_
@@ -0,0 +1,123 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Aggregate.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(Aggregate, latencyColumns) {
+  // selected percentiles match a full sort, including repeated ranks
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<u32> dist(0, 500);
+  for (u64 size : {1lu, 2lu, 7lu, 100lu, 12345lu}) {
+    std::vector<f64> latencies;
+    for (u64 idx = 0; idx < size; idx++) {
+      latencies.push_back(dist(rng) * 0.5);
+    }
+    std::vector<f64> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    f64 mean = 0.0;
+    for (f64 value : sorted) {
+      mean += value;
+    }
+    mean /= size;
+    f64 variance = 0.0;
+    for (f64 value : sorted) {
+      variance += (value - mean) * (value - mean);
+    }
+    variance /= size;
+
+    Columns columns;
+    latencyColumns(&latencies, &columns);
+    ASSERT_EQ(columns.size(), 12u);
+    ASSERT_EQ(columns[0].second, std::to_string(size));
+    ASSERT_EQ(columns[1].second, std::to_string(sorted.front()));
+    ASSERT_EQ(columns[2].second, std::to_string(sorted.back()));
+    u32 column = 3;
+    for (f64 percentile : {0.50, 0.90, 0.99, 0.999, 0.9999, 0.99999}) {
+      ASSERT_EQ(columns[column].first.back(), column == 3 ? 'n' : '%');
+      ASSERT_EQ(columns[column++].second,
+                std::to_string(sorted.at(std::round((size - 1) * percentile))))
+          << size << " " << percentile;
+    }
+    ASSERT_NEAR(std::stod(columns[9].second), mean, 1e-6);
+    ASSERT_NEAR(std::stod(columns[10].second), variance,
+                1e-6 * variance + 1e-6);
+    ASSERT_NEAR(std::stod(columns[11].second), std::sqrt(variance), 1e-6);
+  }
+
+  // no samples
+  std::vector<f64> empty;
+  Columns columns;
+  latencyColumns(&empty, &columns);
+  ASSERT_EQ(columns[0].second, "0");
+  ASSERT_EQ(columns[4].second, "nan");
+}
+
+TEST(Aggregate, latencySamples) {
+  // ticks are stored in 32 bits until a sample needs more
+  LatencySamples samples;
+  LatencySamples other;
+  for (u64 ticks : {4lu, 1lu, 3lu}) {
+    samples.add(ticks);
+  }
+  other.add(2);
+  samples.merge(&other);
+  ASSERT_EQ(other.size(), 0u);
+  ASSERT_FALSE(samples.wide());
+  ASSERT_EQ(*samples.narrow(), std::vector<u32>({4, 1, 3, 2}));
+
+  Columns columns;
+  latencyColumns(&samples, 0.5, &columns);
+  ASSERT_EQ(columns[0].second, "4");
+  ASSERT_EQ(columns[1].second, "0.500000");
+  ASSERT_EQ(columns[2].second, "2.000000");
+  ASSERT_EQ(columns[3].second, std::to_string(1.5));
+  ASSERT_EQ(columns[9].second, std::to_string(1.25));
+  ASSERT_EQ(columns[10].second, std::to_string(1.25 * 0.25));
+
+  other.add(1lu << 40);
+  samples.merge(&other);
+  ASSERT_TRUE(samples.wide());
+  std::vector<u64> wide = *samples.wideSamples();
+  std::sort(wide.begin(), wide.end());  // reordered by latencyColumns()
+  ASSERT_EQ(wide, std::vector<u64>({1, 2, 3, 4, 1lu << 40}));
+  samples.add(7);
+  ASSERT_EQ(samples.size(), 6u);
+  latencyColumns(&samples, 1.0, &columns);
+  ASSERT_EQ(columns[2].second, std::to_string((f64)(1lu << 40)));
+}
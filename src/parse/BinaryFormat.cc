@@ -0,0 +1,187 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BinaryFormat.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+const char BINARY_MAGIC[8] = {'M', 'P', 'F', 'B', '0', '0', '0', '1'};
+
+bool deltaColumn(Column _column) {
+  return _column == TRANS_START_TIME || _column == TRANS_END_TIME ||
+         _column == FLIT_SEND_TIME;
+}
+
+bool isBinaryFile(const std::string& _filename) {
+  // only regular files are checked, opening a pipe would consume it
+  struct stat st;
+  if (stat(_filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    return false;
+  }
+  s32 fd = open(_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  char magic[sizeof(BINARY_MAGIC)];
+  bool binary = pread(fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+                std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+  close(fd);
+  return binary;
+}
+
+void deltaEncode(u64* _values, u64 _count) {
+  u64 prev = 0;
+  for (u64 idx = 0; idx < _count; idx++) {
+    u64 val = _values[idx];
+    s64 delta = static_cast<s64>(val - prev);
+    _values[idx] =
+        (static_cast<u64>(delta) << 1) ^ static_cast<u64>(delta >> 63);
+    prev = val;
+  }
+}
+
+void deltaDecode(u64* _values, u64 _count) {
+  u64 prev = 0;
+  for (u64 idx = 0; idx < _count; idx++) {
+    u64 zigzag = _values[idx];
+    u64 delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    prev += delta;
+    _values[idx] = prev;
+  }
+}
+
+void encodeColumn(const u64* _values, u64 _count, std::vector<u8>* _out) {
+  for (u64 first = 0; first < _count; first += COLUMN_GROUP) {
+    u64 count = std::min(COLUMN_GROUP, _count - first);
+    const u64* values = _values + first;
+
+    // frame of reference
+    u64 base = *std::min_element(values, values + count);
+    u64 range = *std::max_element(values, values + count) - base;
+    u32 width = (range == 0) ? 0 : 64 - __builtin_clzl(range);
+
+    // group header
+    for (u64 val = base; true; val >>= 7) {
+      if (val < 0x80) {
+        _out->push_back(static_cast<u8>(val));
+        break;
+      }
+      _out->push_back(static_cast<u8>(val | 0x80));
+    }
+    _out->push_back(static_cast<u8>(width));
+
+    // packed offsets
+    u64 acc = 0;
+    u32 bits = 0;
+    for (u64 idx = 0; idx < count; idx++) {
+      u64 offset = values[idx] - base;
+      for (u32 done = 0; done < width; done += 32) {
+        u32 take = std::min(width - done, 32u);
+        acc |= ((offset >> done) & ((1lu << take) - 1)) << bits;
+        bits += take;
+        while (bits >= 8) {
+          _out->push_back(static_cast<u8>(acc));
+          acc >>= 8;
+          bits -= 8;
+        }
+      }
+    }
+    if (bits > 0) {
+      _out->push_back(static_cast<u8>(acc));
+    }
+  }
+  _out->insert(_out->end(), COLUMN_PADDING, 0);
+}
+
+bool decodeColumn(const u8* _data, u64 _size, u64 _count, u64* _values) {
+  if (_size < COLUMN_PADDING) {
+    return false;
+  }
+  u64 limit = _size - COLUMN_PADDING;
+  u64 pos = 0;
+  for (u64 first = 0; first < _count; first += COLUMN_GROUP) {
+    u64 count = std::min(COLUMN_GROUP, _count - first);
+    u64* values = _values + first;
+
+    // group header
+    u64 base = 0;
+    for (u32 shift = 0; true; shift += 7) {
+      if (pos >= limit || shift > 63) {
+        return false;
+      }
+      u8 byte = _data[pos++];
+      base |= static_cast<u64>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    if (pos >= limit) {
+      return false;
+    }
+    u32 width = _data[pos++];
+    u64 bytes = (count * width + 7) / 8;
+    if (width > 64 || pos + bytes > limit) {
+      return false;
+    }
+
+    // packed offsets
+    const u8* packed = _data + pos;
+    if (width == 0) {
+      std::fill(values, values + count, base);
+    } else if (width <= 56) {
+      u64 mask = (1lu << width) - 1;
+      for (u64 idx = 0; idx < count; idx++) {
+        u64 bit = idx * width;
+        u64 word;
+        std::memcpy(&word, packed + (bit >> 3), 8);
+        values[idx] = base + ((word >> (bit & 7)) & mask);
+      }
+    } else {
+      u64 mask = (width == 64) ? U64_MAX : (1lu << width) - 1;
+      for (u64 idx = 0; idx < count; idx++) {
+        u64 bit = idx * width;
+        u64 word;
+        std::memcpy(&word, packed + (bit >> 3), 8);
+        u64 val = word >> (bit & 7);
+        if ((bit & 7) != 0) {
+          val |= static_cast<u64>(packed[(bit >> 3) + 8]) << (64 - (bit & 7));
+        }
+        values[idx] = base + (val & mask);
+      }
+    }
+    pos += bytes;
+  }
+  return pos == limit;
+}
@@ -0,0 +1,103 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_BINARYFORMAT_H_
+#define PARSE_BINARYFORMAT_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+// The binary message log format (.mpfb) stores the record stream as blocks of
+// columns. A file starts with the 8 byte BINARY_MAGIC followed by blocks. Each
+// block starts with its size in bytes (excluding the size itself) followed by
+// the value count of each column and then each column as its encoded size and
+// its encoded bytes.
+//
+// The EVENT column orders the transaction starts, transaction ends, and whole
+// messages. Each message owns its packets (MSG_PKT_COUNT) and each packet owns
+// its flits (PKT_FLIT_COUNT) in file order.
+//
+// Columns are stored in groups of COLUMN_GROUP values. A group holds its
+// minimum as a varint, the bit width of the largest offset from the minimum,
+// and the bit-packed offsets. Time columns are delta encoded before packing.
+
+extern const char BINARY_MAGIC[8];
+
+const u64 COLUMN_GROUP = 128;
+
+// columns are padded so that decoding can use unaligned 8 byte loads
+const u64 COLUMN_PADDING = 16;
+
+enum class Event : u64 { TRANSACTION_START, TRANSACTION_END, MESSAGE };
+
+enum Column : u32 {
+  EVENT,
+  TRANS_START_ID,
+  TRANS_START_TIME,
+  TRANS_END_ID,
+  TRANS_END_TIME,
+  MSG_ID,
+  MSG_SRC,
+  MSG_DST,
+  MSG_TRANS_ID,
+  MSG_PROTOCOL_CLASS,
+  MSG_MIN_HOP_COUNT,
+  MSG_OP_CODE,
+  MSG_PKT_COUNT,
+  PKT_ID,
+  PKT_HOP_COUNT,
+  PKT_FLIT_COUNT,
+  FLIT_ID,
+  FLIT_SEND_TIME,
+  FLIT_LATENCY,
+  NUM_COLUMNS
+};
+
+// whether the column is delta encoded
+bool deltaColumn(Column _column);
+
+// returns true if the file is a regular file starting with BINARY_MAGIC
+bool isBinaryFile(const std::string& _filename);
+
+// converts values to zigzag encoded differences to the previous value
+void deltaEncode(u64* _values, u64 _count);
+
+// reverses deltaEncode()
+void deltaDecode(u64* _values, u64 _count);
+
+// appends the encoded column to _out
+void encodeColumn(const u64* _values, u64 _count, std::vector<u8>* _out);
+
+// decodes _count values, returns false if the data is malformed
+bool decodeColumn(const u8* _data, u64 _size, u64 _count, u64* _values);
+
+#endif  // PARSE_BINARYFORMAT_H_
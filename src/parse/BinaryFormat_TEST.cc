@@ -0,0 +1,167 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BinaryFormat.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parse/BinaryReader.h"
+#include "parse/BinaryWriter.h"
+#include "parse/RecordHandler.h"
+
+TEST(BinaryFormat, columns) {
+  std::mt19937_64 rnd(12345);
+  for (u32 width : {0u, 1u, 2u, 7u, 13u, 32u, 56u, 57u, 63u, 64u}) {
+    for (u64 count : {0lu, 1lu, 127lu, 128lu, 129lu, 1000lu}) {
+      std::vector<u64> values(count);
+      u64 base = rnd();
+      for (u64& val : values) {
+        u64 offset = (width == 64) ? rnd() : (rnd() & ((1lu << width) - 1));
+        val = (width == 64) ? offset : base + offset;
+      }
+      std::vector<u8> encoded;
+      encodeColumn(values.data(), values.size(), &encoded);
+      std::vector<u64> decoded(count);
+      ASSERT_TRUE(
+          decodeColumn(encoded.data(), encoded.size(), count, decoded.data()));
+      ASSERT_EQ(values, decoded);
+
+      // truncated data must be detected
+      if (count > 0 && width > 0) {
+        ASSERT_FALSE(decodeColumn(encoded.data(), encoded.size() - 1, count,
+                                  decoded.data()));
+      }
+    }
+  }
+}
+
+TEST(BinaryFormat, delta) {
+  std::vector<u64> values = {100, 105, 103, 103, 0, U64_MAX, 7};
+  std::vector<u64> copy = values;
+  deltaEncode(copy.data(), copy.size());
+  ASSERT_EQ(copy.at(1), 10lu);  // +5
+  ASSERT_EQ(copy.at(2), 3lu);   // -2
+  ASSERT_EQ(copy.at(3), 0lu);
+  deltaDecode(copy.data(), copy.size());
+  ASSERT_EQ(values, copy);
+}
+
+namespace {
+
+// records every call as text
+class Recorder : public RecordHandler {
+ public:
+  void transactionStart(u64 _transId, u64 _transStart) override {
+    text += "+T," + std::to_string(_transId) + "," +
+            std::to_string(_transStart) + "\n";
+  }
+  void transactionEnd(u64 _transId, u64 _transEnd) override {
+    text += "-T," + std::to_string(_transId) + "," +
+            std::to_string(_transEnd) + "\n";
+  }
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override {
+    text += "+M," + std::to_string(_msgId) + "," + std::to_string(_msgSrc) +
+            "," + std::to_string(_msgDst) + "," + std::to_string(_transId) +
+            "," + std::to_string(_protocolClass) + "," +
+            std::to_string(_minHopCount) + "," + std::to_string(_opCode) +
+            "\n";
+  }
+  void messageEnd() override {
+    text += "-M\n";
+  }
+  void packetStart(u32 _pktId, u32 _pktHopCount) override {
+    text += "+P," + std::to_string(_pktId) + "," +
+            std::to_string(_pktHopCount) + "\n";
+  }
+  void packetEnd() override {
+    text += "-P\n";
+  }
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override {
+    text += "F," + std::to_string(_flitId) + "," +
+            std::to_string(_flitSendTime) + "," +
+            std::to_string(_flitReceiveTime) + "\n";
+  }
+
+  std::string text;
+};
+
+}  // namespace
+
+static void generate(RecordHandler* _handler, u64 _transactions) {
+  std::mt19937_64 rnd(6789);
+  u64 time = 1000;
+  for (u64 trans = 0; trans < _transactions; trans++) {
+    u64 transId = (trans % 3lu) << 56 | trans;
+    time += rnd() % 10;
+    _handler->transactionStart(transId, time);
+    u32 msgs = 1 + rnd() % 3;
+    for (u32 msg = 0; msg < msgs; msg++) {
+      _handler->messageStart(msg, rnd() % 64, rnd() % 64, transId, rnd() % 4,
+                             rnd() % 6, rnd() % 300);
+      u32 pkts = rnd() % 4;
+      for (u32 pkt = 0; pkt < pkts; pkt++) {
+        _handler->packetStart(pkt, rnd() % 8);
+        u32 flits = 1 + rnd() % 5;
+        for (u32 flit = 0; flit < flits; flit++) {
+          u64 send = time + flit;
+          _handler->flit(flit, send, send + rnd() % 1000);
+        }
+        _handler->packetEnd();
+      }
+      _handler->messageEnd();
+    }
+    _handler->transactionEnd(transId, time + 2000);
+  }
+}
+
+TEST(BinaryFormat, roundTrip) {
+  std::string filename = testing::TempDir() + "roundtrip.mpfb";
+  Recorder expected;
+  generate(&expected, 100000);
+
+  BinaryWriter writer(filename);
+  generate(&writer, 100000);
+  writer.complete();
+  ASSERT_TRUE(isBinaryFile(filename));
+
+  Recorder actual;
+  BinaryReader reader(filename);
+  reader.read(&actual);
+  ASSERT_EQ(expected.text, actual.text);
+  std::remove(filename.c_str());
+}
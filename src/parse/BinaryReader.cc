@@ -0,0 +1,198 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BinaryReader.h"
+
+#include <ex/Exception.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+BinaryReader::BinaryReader(const std::string& _filename)
+    : filename_(_filename), fd_(-1), map_(nullptr), mapSize_(0), pos_(0) {
+  fd_ = open(filename_.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw ex::Exception("Unable to open input file: %s\n", filename_.c_str());
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    throw ex::Exception("Unable to stat input file: %s\n", filename_.c_str());
+  }
+  mapSize_ = st.st_size;
+  if (mapSize_ < sizeof(BINARY_MAGIC)) {
+    throw ex::Exception("Invalid binary file: %s\n", filename_.c_str());
+  }
+  void* map = mmap(nullptr, mapSize_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (map == MAP_FAILED) {
+    throw ex::Exception("Unable to map input file: %s\n", filename_.c_str());
+  }
+  madvise(map, mapSize_, MADV_SEQUENTIAL);
+  map_ = static_cast<const u8*>(map);
+  if (std::memcmp(map_, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) {
+    throw ex::Exception("Invalid binary file: %s\n", filename_.c_str());
+  }
+  pos_ = sizeof(BINARY_MAGIC);
+}
+
+BinaryReader::~BinaryReader() {
+  if (map_ != nullptr) {
+    munmap(const_cast<u8*>(map_), mapSize_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void BinaryReader::read(RecordHandler* _handler) {
+  while (nextBlock()) {
+    replay(_handler);
+  }
+}
+
+bool BinaryReader::nextBlock() {
+  if (pos_ == mapSize_) {
+    return false;
+  }
+
+  u64 blockSize;
+  if (pos_ + sizeof(blockSize) > mapSize_) {
+    throw ex::Exception("Binary file is truncated: %s\n", filename_.c_str());
+  }
+  std::memcpy(&blockSize, map_ + pos_, sizeof(blockSize));
+  pos_ += sizeof(blockSize);
+  if (blockSize > mapSize_ - pos_) {
+    throw ex::Exception("Binary file is truncated: %s\n", filename_.c_str());
+  }
+  const u8* block = map_ + pos_;
+  u64 end = blockSize;
+  pos_ += blockSize;
+
+  // column counts
+  u64 offset = NUM_COLUMNS * sizeof(u64);
+  if (offset > end) {
+    throw ex::Exception("Binary file is corrupted: %s\n", filename_.c_str());
+  }
+  for (u32 col = 0; col < NUM_COLUMNS; col++) {
+    u64 count;
+    std::memcpy(&count, block + col * sizeof(u64), sizeof(count));
+    columns_[col].resize(count);
+  }
+
+  // columns
+  for (u32 col = 0; col < NUM_COLUMNS; col++) {
+    u64 size;
+    if (offset + sizeof(size) > end) {
+      throw ex::Exception("Binary file is corrupted: %s\n", filename_.c_str());
+    }
+    std::memcpy(&size, block + offset, sizeof(size));
+    offset += sizeof(size);
+    std::vector<u64>& values = columns_[col];
+    if (size > end - offset ||
+        !decodeColumn(block + offset, size, values.size(), values.data())) {
+      throw ex::Exception("Binary file is corrupted: %s\n", filename_.c_str());
+    }
+    if (deltaColumn(static_cast<Column>(col))) {
+      deltaDecode(values.data(), values.size());
+    }
+    offset += size;
+  }
+  return true;
+}
+
+void BinaryReader::replay(RecordHandler* _handler) const {
+  const std::vector<u64>& events = columns_[EVENT];
+  u64 transStart = 0;
+  u64 transEnd = 0;
+  u64 msg = 0;
+  u64 pkt = 0;
+  u64 flit = 0;
+
+  // the counts must be consistent before any data is trusted
+  u64 pkts = 0;
+  u64 flits = 0;
+  for (u64 count : columns_[MSG_PKT_COUNT]) {
+    pkts += count;
+  }
+  for (u64 count : columns_[PKT_FLIT_COUNT]) {
+    flits += count;
+  }
+  u64 counts[3] = {0, 0, 0};
+  for (u64 event : events) {
+    if (event > static_cast<u64>(Event::MESSAGE)) {
+      throw ex::Exception("Binary file is corrupted: %s\n", filename_.c_str());
+    }
+    counts[event]++;
+  }
+  if (counts[0] != columns_[TRANS_START_ID].size() ||
+      counts[1] != columns_[TRANS_END_ID].size() ||
+      counts[2] != columns_[MSG_ID].size() ||
+      pkts != columns_[PKT_ID].size() || flits != columns_[FLIT_ID].size()) {
+    throw ex::Exception("Binary file is corrupted: %s\n", filename_.c_str());
+  }
+
+  for (u64 event : events) {
+    switch (static_cast<Event>(event)) {
+      case Event::TRANSACTION_START:
+        _handler->transactionStart(columns_[TRANS_START_ID][transStart],
+                                   columns_[TRANS_START_TIME][transStart]);
+        transStart++;
+        break;
+
+      case Event::TRANSACTION_END:
+        _handler->transactionEnd(columns_[TRANS_END_ID][transEnd],
+                                 columns_[TRANS_END_TIME][transEnd]);
+        transEnd++;
+        break;
+
+      case Event::MESSAGE:
+        _handler->messageStart(
+            columns_[MSG_ID][msg], columns_[MSG_SRC][msg],
+            columns_[MSG_DST][msg], columns_[MSG_TRANS_ID][msg],
+            columns_[MSG_PROTOCOL_CLASS][msg], columns_[MSG_MIN_HOP_COUNT][msg],
+            columns_[MSG_OP_CODE][msg]);
+        for (u64 p = 0; p < columns_[MSG_PKT_COUNT][msg]; p++, pkt++) {
+          _handler->packetStart(columns_[PKT_ID][pkt],
+                                columns_[PKT_HOP_COUNT][pkt]);
+          for (u64 f = 0; f < columns_[PKT_FLIT_COUNT][pkt]; f++, flit++) {
+            u64 send = columns_[FLIT_SEND_TIME][flit];
+            _handler->flit(columns_[FLIT_ID][flit], send,
+                           send + columns_[FLIT_LATENCY][flit]);
+          }
+          _handler->packetEnd();
+        }
+        _handler->messageEnd();
+        msg++;
+        break;
+    }
+  }
+}
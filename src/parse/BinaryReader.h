@@ -0,0 +1,65 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_BINARYREADER_H_
+#define PARSE_BINARYREADER_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/BinaryFormat.h"
+#include "parse/RecordHandler.h"
+
+// This class reads a binary message log (.mpfb) and feeds the records into a
+// handler in their original order.
+class BinaryReader {
+ public:
+  explicit BinaryReader(const std::string& _filename);
+  ~BinaryReader();
+
+  // feeds every record into the handler
+  void read(RecordHandler* _handler);
+
+ private:
+  // decodes the block at pos_ into the columns
+  bool nextBlock();
+  void replay(RecordHandler* _handler) const;
+
+  std::string filename_;
+  s32 fd_;
+  const u8* map_;
+  u64 mapSize_;
+  u64 pos_;
+  std::vector<u64> columns_[NUM_COLUMNS];
+};
+
+#endif  // PARSE_BINARYREADER_H_
@@ -0,0 +1,194 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BinaryWriter.h"
+
+#include <ex/Exception.h>
+
+// blocks are cut at the first message boundary after either limit
+const u64 BLOCK_EVENTS = 1 << 16;
+const u64 BLOCK_FLITS = 1 << 20;
+
+BinaryWriter::BinaryWriter(const std::string& _filename)
+    : filename_(_filename), inMessage_(false), inPacket_(false) {
+  file_ = std::fopen(filename_.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw ex::Exception("Unable to open output file: %s\n", filename_.c_str());
+  }
+  write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+}
+
+BinaryWriter::~BinaryWriter() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+void BinaryWriter::transactionStart(u64 _transId, u64 _transStart) {
+  if (inMessage_) {
+    throw ex::Exception("'+T' inside a message. File corrupted :(\n");
+  }
+  columns_[EVENT].push_back(static_cast<u64>(Event::TRANSACTION_START));
+  columns_[TRANS_START_ID].push_back(_transId);
+  columns_[TRANS_START_TIME].push_back(_transStart);
+  flushIfFull();
+}
+
+void BinaryWriter::transactionEnd(u64 _transId, u64 _transEnd) {
+  if (inMessage_) {
+    throw ex::Exception("'-T' inside a message. File corrupted :(\n");
+  }
+  columns_[EVENT].push_back(static_cast<u64>(Event::TRANSACTION_END));
+  columns_[TRANS_END_ID].push_back(_transId);
+  columns_[TRANS_END_TIME].push_back(_transEnd);
+  flushIfFull();
+}
+
+void BinaryWriter::messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst,
+                                u64 _transId, u32 _protocolClass,
+                                u32 _minHopCount, u32 _opCode) {
+  if (inMessage_) {
+    throw ex::Exception("Two '+M's without '-M'. File corrupted :(\n");
+  }
+  inMessage_ = true;
+  columns_[EVENT].push_back(static_cast<u64>(Event::MESSAGE));
+  columns_[MSG_ID].push_back(_msgId);
+  columns_[MSG_SRC].push_back(_msgSrc);
+  columns_[MSG_DST].push_back(_msgDst);
+  columns_[MSG_TRANS_ID].push_back(_transId);
+  columns_[MSG_PROTOCOL_CLASS].push_back(_protocolClass);
+  columns_[MSG_MIN_HOP_COUNT].push_back(_minHopCount);
+  columns_[MSG_OP_CODE].push_back(_opCode);
+  columns_[MSG_PKT_COUNT].push_back(0);
+}
+
+void BinaryWriter::messageEnd() {
+  if (!inMessage_ || inPacket_) {
+    throw ex::Exception("Misplaced '-M'. File corrupted :(\n");
+  }
+  inMessage_ = false;
+  flushIfFull();
+}
+
+void BinaryWriter::packetStart(u32 _pktId, u32 _pktHopCount) {
+  if (!inMessage_) {
+    throw ex::Exception("Missing '+M'. File corrupted :(\n");
+  }
+  if (inPacket_) {
+    throw ex::Exception("Two '+P's without '-P'. File corrupted :(\n");
+  }
+  inPacket_ = true;
+  columns_[MSG_PKT_COUNT].back()++;
+  columns_[PKT_ID].push_back(_pktId);
+  columns_[PKT_HOP_COUNT].push_back(_pktHopCount);
+  columns_[PKT_FLIT_COUNT].push_back(0);
+}
+
+void BinaryWriter::packetEnd() {
+  if (!inPacket_) {
+    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+  }
+  inPacket_ = false;
+}
+
+void BinaryWriter::flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) {
+  if (!inPacket_) {
+    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+  }
+  if (_flitSendTime > _flitReceiveTime) {
+    throw ex::Exception(
+        "Flit received before it was sent? "
+        "File corrupted :(\n");
+  }
+  columns_[PKT_FLIT_COUNT].back()++;
+  columns_[FLIT_ID].push_back(_flitId);
+  columns_[FLIT_SEND_TIME].push_back(_flitSendTime);
+  columns_[FLIT_LATENCY].push_back(_flitReceiveTime - _flitSendTime);
+}
+
+void BinaryWriter::complete() {
+  if (inMessage_) {
+    throw ex::Exception("Missing '-M'. File corrupted :(\n");
+  }
+  flush();
+  if (std::fclose(file_) != 0) {
+    file_ = nullptr;
+    throw ex::Exception("Error while writing output file: %s\n",
+                        filename_.c_str());
+  }
+  file_ = nullptr;
+}
+
+void BinaryWriter::flushIfFull() {
+  if (!inMessage_ && (columns_[EVENT].size() >= BLOCK_EVENTS ||
+                      columns_[FLIT_ID].size() >= BLOCK_FLITS)) {
+    flush();
+  }
+}
+
+void BinaryWriter::flush() {
+  if (columns_[EVENT].empty()) {
+    return;
+  }
+
+  // column counts
+  block_.clear();
+  for (u32 col = 0; col < NUM_COLUMNS; col++) {
+    u64 count = columns_[col].size();
+    const u8* bytes = reinterpret_cast<const u8*>(&count);
+    block_.insert(block_.end(), bytes, bytes + sizeof(count));
+  }
+
+  // encoded columns
+  for (u32 col = 0; col < NUM_COLUMNS; col++) {
+    std::vector<u64>& values = columns_[col];
+    if (deltaColumn(static_cast<Column>(col))) {
+      deltaEncode(values.data(), values.size());
+    }
+    encoded_.clear();
+    encodeColumn(values.data(), values.size(), &encoded_);
+    u64 size = encoded_.size();
+    const u8* bytes = reinterpret_cast<const u8*>(&size);
+    block_.insert(block_.end(), bytes, bytes + sizeof(size));
+    block_.insert(block_.end(), encoded_.begin(), encoded_.end());
+    values.clear();
+  }
+
+  u64 size = block_.size();
+  write(&size, sizeof(size));
+  write(block_.data(), block_.size());
+}
+
+void BinaryWriter::write(const void* _data, u64 _size) {
+  if (std::fwrite(_data, 1, _size, file_) != _size) {
+    throw ex::Exception("Error while writing output file: %s\n",
+                        filename_.c_str());
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_BINARYWRITER_H_
+#define PARSE_BINARYWRITER_H_
+
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "parse/BinaryFormat.h"
+#include "parse/RecordHandler.h"
+
+// This class writes the records it receives as a binary message log (.mpfb).
+class BinaryWriter : public RecordHandler {
+ public:
+  explicit BinaryWriter(const std::string& _filename);
+  ~BinaryWriter() override;
+
+  void transactionStart(u64 _transId, u64 _transStart) override;
+  void transactionEnd(u64 _transId, u64 _transEnd) override;
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override;
+  void messageEnd() override;
+  void packetStart(u32 _pktId, u32 _pktHopCount) override;
+  void packetEnd() override;
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override;
+
+  // writes the last block and closes the file
+  void complete();
+
+ private:
+  void flushIfFull();
+  void flush();
+  void write(const void* _data, u64 _size);
+
+  std::string filename_;
+  FILE* file_;
+  bool inMessage_;
+  bool inPacket_;
+  std::vector<u64> columns_[NUM_COLUMNS];
+  std::vector<u8> block_;
+  std::vector<u8> encoded_;
+};
+
+#endif  // PARSE_BINARYWRITER_H_
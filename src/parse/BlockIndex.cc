@@ -0,0 +1,289 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BlockIndex.h"
+
+#include <ex/Exception.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+const char INDEX_MAGIC[8] = {'S', 'S', 'I', 'X', '0', '0', '0', '2'};
+
+static void put(std::vector<u8>* _out, u64 _value) {
+  const u8* bytes = reinterpret_cast<const u8*>(&_value);
+  _out->insert(_out->end(), bytes, bytes + sizeof(_value));
+}
+
+namespace {
+
+// reads the index fields in order, any overrun means the file is corrupted
+class IndexCursor {
+ public:
+  IndexCursor(const std::string& _filename, const std::vector<u8>& _data)
+      : filename_(_filename), data_(_data), pos_(0) {}
+
+  u64 get() {
+    u64 value;
+    bytes(&value, sizeof(value));
+    return value;
+  }
+
+  void bytes(void* _dst, u64 _size) {
+    if (_size > data_.size() - pos_) {
+      throw ex::Exception("Index file is corrupted: %s\n", filename_.c_str());
+    }
+    std::memcpy(_dst, data_.data() + pos_, _size);
+    pos_ += _size;
+  }
+
+  bool done() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  const std::string& filename_;
+  const std::vector<u8>& data_;
+  u64 pos_;
+};
+
+}  // namespace
+
+static bool statFile(const std::string& _filename, u64* _size, u64* _time) {
+  struct stat st;
+  if (stat(_filename.c_str(), &st) != 0) {
+    return false;
+  }
+  *_size = st.st_size;
+  *_time = static_cast<u64>(st.st_mtim.tv_sec) * 1000000000lu +
+           st.st_mtim.tv_nsec;
+  return true;
+}
+
+/*** Block struct ***/
+
+BlockIndex::Block::Block()
+    : bit(0),
+      textOffset(0),
+      recordOffset(0),
+      minTime(U64_MAX),
+      maxTime(0),
+      minTransId(U64_MAX),
+      maxTransId(0) {}
+
+BlockIndex::Block::~Block() {}
+
+void BlockIndex::Block::setWindow(const std::vector<u8>& _window) {
+  window.clear();
+  if (_window.empty()) {
+    return;
+  }
+  uLongf size = compressBound(_window.size());
+  window.resize(sizeof(u64) + size);
+  u64 windowSize = _window.size();
+  std::memcpy(window.data(), &windowSize, sizeof(windowSize));
+  if (compress2(window.data() + sizeof(u64), &size, _window.data(),
+                _window.size(), Z_BEST_SPEED) != Z_OK) {
+    throw ex::Exception("Unable to compress the index window\n");
+  }
+  window.resize(sizeof(u64) + size);
+}
+
+void BlockIndex::Block::getWindow(std::vector<u8>* _window) const {
+  _window->clear();
+  if (window.empty()) {
+    return;
+  }
+  u64 windowSize;
+  std::memcpy(&windowSize, window.data(), sizeof(windowSize));
+  _window->resize(windowSize);
+  uLongf size = windowSize;
+  if (uncompress(_window->data(), &size, window.data() + sizeof(u64),
+                 window.size() - sizeof(u64)) != Z_OK ||
+      size != windowSize) {
+    throw ex::Exception("Index file is corrupted, invalid window\n");
+  }
+}
+
+void BlockIndex::Block::addTime(u64 _time) {
+  minTime = std::min(minTime, _time);
+  maxTime = std::max(maxTime, _time);
+}
+
+void BlockIndex::Block::addTransId(u64 _transId) {
+  minTransId = std::min(minTransId, _transId);
+  maxTransId = std::max(maxTransId, _transId);
+}
+
+bool BlockIndex::Block::empty() const {
+  return minTime > maxTime;
+}
+
+/*** BlockIndex class ***/
+
+BlockIndex::BlockIndex()
+    : inputSize_(0),
+      inputTime_(0),
+      format_(Format::PLAIN),
+      textSize_(0),
+      minSendTime_(U64_MAX),
+      maxRecvTime_(0) {}
+
+BlockIndex::BlockIndex(const std::string& _inputFile, Format _format,
+                       u64 _textSize, u64 _minSendTime, u64 _maxRecvTime,
+                       std::vector<Block>&& _blocks)
+    : format_(_format),
+      textSize_(_textSize),
+      minSendTime_(_minSendTime),
+      maxRecvTime_(_maxRecvTime),
+      blocks_(std::move(_blocks)) {
+  if (!statFile(_inputFile, &inputSize_, &inputTime_)) {
+    throw ex::Exception("Unable to stat input file: %s\n", _inputFile.c_str());
+  }
+}
+
+BlockIndex::~BlockIndex() {}
+
+std::string BlockIndex::defaultFilename(const std::string& _inputFile) {
+  return _inputFile + ".ssi";
+}
+
+void BlockIndex::read(const std::string& _filename) {
+  FILE* file = std::fopen(_filename.c_str(), "rb");
+  if (file == nullptr) {
+    throw ex::Exception("Unable to open index file: %s\n", _filename.c_str());
+  }
+  std::vector<u8> data;
+  u8 buffer[1 << 16];
+  u64 bytes;
+  while ((bytes = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + bytes);
+  }
+  std::fclose(file);
+
+  IndexCursor cursor(_filename, data);
+  char magic[sizeof(INDEX_MAGIC)];
+  cursor.bytes(magic, sizeof(magic));
+  if (std::memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+    throw ex::Exception("Invalid index file: %s\n", _filename.c_str());
+  }
+  inputSize_ = cursor.get();
+  inputTime_ = cursor.get();
+  format_ = static_cast<Format>(cursor.get());
+  textSize_ = cursor.get();
+  minSendTime_ = cursor.get();
+  maxRecvTime_ = cursor.get();
+  blocks_.resize(cursor.get());
+  for (Block& block : blocks_) {
+    block.bit = cursor.get();
+    block.textOffset = cursor.get();
+    block.window.resize(cursor.get());
+    cursor.bytes(block.window.data(), block.window.size());
+    block.recordOffset = cursor.get();
+    block.minTime = cursor.get();
+    block.maxTime = cursor.get();
+    block.minTransId = cursor.get();
+    block.maxTransId = cursor.get();
+    block.open.resize(cursor.get());
+    for (std::pair<u64, u64>& open : block.open) {
+      open.first = cursor.get();
+      open.second = cursor.get();
+    }
+  }
+  if (!cursor.done()) {
+    throw ex::Exception("Index file is corrupted: %s\n", _filename.c_str());
+  }
+}
+
+void BlockIndex::write(const std::string& _filename) const {
+  std::vector<u8> data(INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+  put(&data, inputSize_);
+  put(&data, inputTime_);
+  put(&data, static_cast<u64>(format_));
+  put(&data, textSize_);
+  put(&data, minSendTime_);
+  put(&data, maxRecvTime_);
+  put(&data, blocks_.size());
+  for (const Block& block : blocks_) {
+    put(&data, block.bit);
+    put(&data, block.textOffset);
+    put(&data, block.window.size());
+    data.insert(data.end(), block.window.begin(), block.window.end());
+    put(&data, block.recordOffset);
+    put(&data, block.minTime);
+    put(&data, block.maxTime);
+    put(&data, block.minTransId);
+    put(&data, block.maxTransId);
+    put(&data, block.open.size());
+    for (const std::pair<u64, u64>& open : block.open) {
+      put(&data, open.first);
+      put(&data, open.second);
+    }
+  }
+
+  FILE* file = std::fopen(_filename.c_str(), "wb");
+  if (file == nullptr) {
+    throw ex::Exception("Unable to open index file: %s\n", _filename.c_str());
+  }
+  bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  ok &= std::fclose(file) == 0;
+  if (!ok) {
+    throw ex::Exception("Error while writing index file: %s\n",
+                        _filename.c_str());
+  }
+}
+
+bool BlockIndex::matches(const std::string& _inputFile) const {
+  u64 size, time;
+  return statFile(_inputFile, &size, &time) && size == inputSize_ &&
+         time == inputTime_;
+}
+
+Format BlockIndex::format() const {
+  return format_;
+}
+
+u64 BlockIndex::textSize() const {
+  return textSize_;
+}
+
+const std::vector<BlockIndex::Block>& BlockIndex::blocks() const {
+  return blocks_;
+}
+
+bool BlockIndex::flitTimes(u64* _minSendTime, u64* _maxRecvTime) const {
+  *_minSendTime = minSendTime_;
+  *_maxRecvTime = maxRecvTime_;
+  return minSendTime_ != U64_MAX;
+}
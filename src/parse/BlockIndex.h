@@ -0,0 +1,128 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_BLOCKINDEX_H_
+#define PARSE_BLOCKINDEX_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parse/Codec.h"
+
+// The sidecar index of a message log (.ssi) cuts the text of the log into
+// blocks. Each block starts at a restart point of the input, a byte offset of
+// a plain file or a deflate block boundary and its preceding window in a gzip
+// file, and is tagged with a zone map: the range of times and transaction ids
+// that its records touch. The times of a transaction are part of the zone map
+// of every block holding one of its records. Each block also holds the
+// transactions that are open where its first record starts. The index also
+// holds the earliest flit send and the latest flit receive time of the log.
+//
+// An index file starts with the 8 byte INDEX_MAGIC, the size and modification
+// time of the indexed file, the input format, the text size, the flit times,
+// and the block count followed by the blocks.
+
+extern const char INDEX_MAGIC[8];
+
+class BlockIndex {
+ public:
+  struct Block {
+    Block();
+    ~Block();
+
+    // compresses and stores the window preceding the restart point
+    void setWindow(const std::vector<u8>& _window);
+
+    // yields the window preceding the restart point
+    void getWindow(std::vector<u8>* _window) const;
+
+    // widens the zone map
+    void addTime(u64 _time);
+    void addTransId(u64 _transId);
+
+    // returns true if the block holds records
+    bool empty() const;
+
+    // the restart point
+    u64 bit;         // position in the input in bits
+    u64 textOffset;  // position in the text
+    std::vector<u8> window;  // zlib compressed
+
+    // the text offset of the first record, at or after the restart point
+    u64 recordOffset;
+
+    // zone map
+    u64 minTime;
+    u64 maxTime;
+    u64 minTransId;
+    u64 maxTransId;
+
+    // the id and start time of each transaction open at the first record
+    std::vector<std::pair<u64, u64> > open;
+  };
+
+  BlockIndex();
+  BlockIndex(const std::string& _inputFile, Format _format, u64 _textSize,
+             u64 _minSendTime, u64 _maxRecvTime,
+             std::vector<Block>&& _blocks);
+  ~BlockIndex();
+
+  // the default index file of an input file
+  static std::string defaultFilename(const std::string& _inputFile);
+
+  void read(const std::string& _filename);
+  void write(const std::string& _filename) const;
+
+  // returns true if the index was built from the current contents of the
+  // input file
+  bool matches(const std::string& _inputFile) const;
+
+  Format format() const;
+  u64 textSize() const;
+  const std::vector<Block>& blocks() const;
+
+  // the earliest flit send and the latest flit receive time (unscaled),
+  // returns false if the log has no flits
+  bool flitTimes(u64* _minSendTime, u64* _maxRecvTime) const;
+
+ private:
+  u64 inputSize_;
+  u64 inputTime_;
+  Format format_;
+  u64 textSize_;
+  u64 minSendTime_;  // U64_MAX without flits
+  u64 maxRecvTime_;
+  std::vector<Block> blocks_;
+};
+
+#endif  // PARSE_BLOCKINDEX_H_
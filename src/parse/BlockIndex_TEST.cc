@@ -0,0 +1,163 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/BlockIndex.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "parse/Engine.h"
+#include "parse/IndexBuilder.h"
+#include "parse/IndexedParser.h"
+#include "parse/TestData_TEST.h"
+
+// runs the engine over the whole input or only the blocks the index selects
+static std::vector<std::string> run(const std::string& _input,
+                                    const BlockIndex* _index,
+                                    const std::vector<std::string>& _filters,
+                                    bool* _skips = nullptr) {
+  if (_index == nullptr) {
+    return runEngine(_input, _filters, parseLog, 0.5);
+  }
+  return runEngine(
+      _input, _filters,
+      [&](const std::string& _log, Engine* _engine) {
+        IndexedParser parser(_engine, _index);
+        if (_skips != nullptr) {
+          *_skips = parser.skips();
+        }
+        parser.parse(_log);
+      },
+      0.5);
+}
+
+TEST(BlockIndex, zoneMaps) {
+  std::string input = writeLog("blockindex.mpf", randomLog(500, 8));
+  IndexBuilder builder(4096, 1000);
+  BlockIndex index = builder.build(input);
+  ASSERT_EQ(index.format(), Format::PLAIN);
+  ASSERT_GT(index.blocks().size(), 10u);
+  ASSERT_EQ(index.textSize(), readFile(input).size());
+
+  u64 prevOffset = 0;
+  for (const BlockIndex::Block& block : index.blocks()) {
+    ASSERT_LE(block.textOffset, block.recordOffset);
+    ASSERT_LE(prevOffset, block.recordOffset);
+    ASSERT_FALSE(block.empty());
+    ASSERT_LE(block.minTime, block.maxTime);
+    ASSERT_LE(block.minTransId, block.maxTransId);
+    prevOffset = block.recordOffset;
+  }
+  ASSERT_TRUE(index.blocks().front().open.empty());
+  ASSERT_FALSE(index.blocks().back().open.empty());
+  std::remove(input.c_str());
+}
+
+TEST(BlockIndex, readWrite) {
+  std::string text = randomLog(500, 8);
+  std::string input = writeLog("blockindex.mpf.gz", gzipText(text));
+  IndexBuilder builder(4096, 1000);
+  BlockIndex index = builder.build(input);
+  ASSERT_EQ(index.format(), Format::GZIP);
+  ASSERT_EQ(index.textSize(), text.size());
+  ASSERT_TRUE(index.matches(input));
+
+  std::string indexFile = BlockIndex::defaultFilename(input);
+  index.write(indexFile);
+  BlockIndex copy;
+  copy.read(indexFile);
+  ASSERT_TRUE(copy.matches(input));
+  ASSERT_EQ(copy.format(), index.format());
+  ASSERT_EQ(copy.textSize(), index.textSize());
+  u64 minSendTime, maxRecvTime, copyMinSendTime, copyMaxRecvTime;
+  ASSERT_TRUE(index.flitTimes(&minSendTime, &maxRecvTime));
+  ASSERT_TRUE(copy.flitTimes(&copyMinSendTime, &copyMaxRecvTime));
+  ASSERT_EQ(copyMinSendTime, minSendTime);
+  ASSERT_EQ(copyMaxRecvTime, maxRecvTime);
+  ASSERT_LT(minSendTime, maxRecvTime);
+  ASSERT_EQ(copy.blocks().size(), index.blocks().size());
+  for (u64 idx = 0; idx < index.blocks().size(); idx++) {
+    const BlockIndex::Block& a = index.blocks()[idx];
+    const BlockIndex::Block& b = copy.blocks()[idx];
+    ASSERT_EQ(a.bit, b.bit);
+    ASSERT_EQ(a.textOffset, b.textOffset);
+    ASSERT_EQ(a.window, b.window);
+    ASSERT_EQ(a.recordOffset, b.recordOffset);
+    ASSERT_EQ(a.minTime, b.minTime);
+    ASSERT_EQ(a.maxTime, b.maxTime);
+    ASSERT_EQ(a.minTransId, b.minTransId);
+    ASSERT_EQ(a.maxTransId, b.maxTransId);
+    ASSERT_EQ(a.open, b.open);
+  }
+
+  // a changed input doesn't match anymore
+  writeLog("blockindex.mpf.gz", gzipText(text + "+T,1,1\n"));
+  ASSERT_FALSE(copy.matches(input));
+
+  writeLog("blockindex.mpf.gz.ssi", "SSIX0002");
+  ASSERT_THROW(copy.read(indexFile), ex::Exception);
+  std::remove(indexFile.c_str());
+  std::remove(input.c_str());
+}
+
+TEST(BlockIndex, matchesFullParse) {
+  std::string text = randomLog(2000, 8);
+  for (const std::string& input :
+       {writeLog("blockindex.mpf", text),
+        writeLog("blockindex.mpf.gz", gzipText(text))}) {
+    IndexBuilder builder(8192, 2000);
+    BlockIndex index = builder.build(input);
+    for (const std::vector<std::string>& filters :
+         {std::vector<std::string>({"+send=1500-2000"}),
+          std::vector<std::string>({"+recv=1000-1200,2500-2600", "-pc=1"}),
+          std::vector<std::string>({"-send=0-2200"}),
+          std::vector<std::string>({"+app=1", "+start=1800-3000"}),
+          std::vector<std::string>({"+trans=0-5"}),
+          std::vector<std::string>({"+trans=700-720"})}) {
+      SCOPED_TRACE(filters.at(0));
+      bool skips;
+      std::vector<std::string> outputs = run(input, &index, filters, &skips);
+      ASSERT_TRUE(skips);
+      ASSERT_EQ(run(input, nullptr, filters), outputs);
+    }
+
+    // nothing to skip
+    bool skips;
+    std::vector<std::string> outputs = run(input, &index, {"+pc=1"}, &skips);
+    ASSERT_FALSE(skips);
+    ASSERT_EQ(run(input, nullptr, {"+pc=1"}), outputs);
+    std::remove(input.c_str());
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Codec.h"
+
+#include <ex/Exception.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+Format detectFormat(const char* _data, u64 _size) {
+  const u8* data = reinterpret_cast<const u8*>(_data);
+  if (_size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+    return Format::GZIP;
+  }
+  if (_size >= 4) {
+    u32 magic = static_cast<u32>(data[0]) | static_cast<u32>(data[1]) << 8 |
+                static_cast<u32>(data[2]) << 16 |
+                static_cast<u32>(data[3]) << 24;
+    // zstd frames, or the skippable frames zstd files may start with
+    if (magic == 0xFD2FB528 || (magic & 0xFFFFFFF0) == 0x184D2A50) {
+      return Format::ZSTD;
+    }
+    if (magic == 0x184D2204) {
+      return Format::LZ4;
+    }
+  }
+  return Format::PLAIN;
+}
+
+InputStream::InputStream(const std::string& _filename, s32 _fd)
+    : filename_(_filename), fd_(_fd), aheadPos_(0) {}
+
+InputStream::~InputStream() {}
+
+u64 InputStream::peek(char* _buffer, u64 _size) {
+  // drop what was consumed already
+  ahead_.erase(ahead_.begin(), ahead_.begin() + aheadPos_);
+  aheadPos_ = 0;
+
+  while (ahead_.size() < _size) {
+    u64 size = ahead_.size();
+    ahead_.resize(_size);
+    u64 bytes = readFd(ahead_.data() + size, _size - size);
+    ahead_.resize(size + bytes);
+    if (bytes == 0) {
+      break;
+    }
+  }
+  u64 bytes = std::min(_size, ahead_.size());
+  std::memcpy(_buffer, ahead_.data(), bytes);
+  return bytes;
+}
+
+u64 InputStream::read(char* _buffer, u64 _size) {
+  if (aheadPos_ < ahead_.size()) {
+    u64 bytes = std::min(_size, ahead_.size() - aheadPos_);
+    std::memcpy(_buffer, ahead_.data() + aheadPos_, bytes);
+    aheadPos_ += bytes;
+    return bytes;
+  }
+  return readFd(_buffer, _size);
+}
+
+const std::string& InputStream::filename() const {
+  return filename_;
+}
+
+u64 InputStream::readFd(char* _buffer, u64 _size) {
+  while (true) {
+    ssize_t bytes = ::read(fd_, _buffer, _size);
+    if (bytes >= 0) {
+      return bytes;
+    }
+    if (errno != EINTR) {
+      throw ex::Exception("Error while reading input file: %s\n",
+                          filename_.c_str());
+    }
+  }
+}
+
+Codec::Codec() {}
+
+Codec::~Codec() {}
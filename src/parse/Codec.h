@@ -0,0 +1,86 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_CODEC_H_
+#define PARSE_CODEC_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+// the input formats detected by their magic bytes
+enum class Format { PLAIN, GZIP, ZSTD, LZ4 };
+
+// the number of bytes needed by detectFormat()
+const u64 FORMAT_MAGIC_SIZE = 4;
+
+Format detectFormat(const char* _data, u64 _size);
+
+// This class reads a file descriptor sequentially. Bytes can be looked at
+// ahead of time, which works for pipes as well as files.
+class InputStream {
+ public:
+  InputStream(const std::string& _filename, s32 _fd);
+  ~InputStream();
+
+  // copies up to _size upcoming bytes without consuming them, returns the
+  // number of bytes copied which is less than _size only at the end of the
+  // input
+  u64 peek(char* _buffer, u64 _size);
+
+  // reads up to _size bytes, returns 0 at the end of the input
+  u64 read(char* _buffer, u64 _size);
+
+  const std::string& filename() const;
+
+ private:
+  u64 readFd(char* _buffer, u64 _size);
+
+  const std::string filename_;
+  const s32 fd_;
+
+  // bytes read ahead by peek()
+  std::vector<char> ahead_;
+  u64 aheadPos_;
+};
+
+// This is the interface of the decompressors below the Reader.
+class Codec {
+ public:
+  Codec();
+  virtual ~Codec();
+
+  // appends the next piece of decompressed data to _buffer, returns false at
+  // the end of the stream
+  virtual bool read(std::vector<char>* _buffer) = 0;
+};
+
+#endif  // PARSE_CODEC_H_
@@ -31,13 +31,11 @@
 #include "parse/Engine.h"
 
 #include <ex/Exception.h>
-#include <mut/mut.h>
 
-#include <algorithm>
 #include <cassert>
-#include <sstream>
+#include <future>
 
-const f64 TOLERANCE = 1e-6;
+#include "parse/Aggregate.h"
 
 /*** State machine classes ***/
 
@@ -48,596 +46,501 @@ Engine::TransFsm::TransFsm() {
 Engine::TransFsm::~TransFsm() {}
 
 void Engine::TransFsm::reset() {
-  start = F64_POS_INF;
-  end = F64_NEG_INF;
+  start = U64_MAX;
+  end = 0;
   msgCount = 0;
   pktCount = 0;
   flitCount = 0;
 }
 
-Engine::MsgFsm::MsgFsm() {
-  reset();
-}
-
-Engine::MsgFsm::~MsgFsm() {}
-
-void Engine::MsgFsm::reset() {
-  enabled = false;
-  start = F64_POS_INF;
-  end = F64_NEG_INF;
-  transId = U64_MAX;
-  pktCount = 0;
-  flitCount = 0;
-  minHopCount = 0;
-}
-
-Engine::PktFsm::PktFsm() {
-  reset();
-}
-
-Engine::PktFsm::~PktFsm() {}
-
-void Engine::PktFsm::reset() {
-  enabled = false;
-  headStart = F64_POS_INF;
-  headEnd = F64_NEG_INF;
-  tailEnd = F64_NEG_INF;
-  flitCount = 0;
-  nonMinHopCount = 0;
-}
-
 /*** Engine class ***/
 
-Engine::Engine(const std::string& _transactionsFile,
-               const std::string& _messagesFile,
-               const std::string& _packetsFile, const std::string& _latencyfile,
-               const std::string& _hopcountfile, f64 _scalar,
-               bool _packetHeaderLatency,
-               const std::vector<std::string>& _filters)
-    : scalar_(_scalar), packetHeaderLatency_(_packetHeaderLatency) {
-  if (_transactionsFile.size() > 0) {
-    transFile_ = std::make_shared<fio::OutFile>(_transactionsFile);
-  } else {
-    transFile_ = nullptr;
-  }
-
-  if (_messagesFile.size() > 0) {
-    msgsFile_ = std::make_shared<fio::OutFile>(_messagesFile);
-  } else {
-    msgsFile_ = nullptr;
-  }
-
-  if (_packetsFile.size() > 0) {
-    pktsFile_ = std::make_shared<fio::OutFile>(_packetsFile);
+// opens an output file if it is named
+static std::shared_ptr<RecordWriter> openFile(const std::string& _filename) {
+  if (_filename.size() > 0) {
+    return std::make_shared<RecordWriter>(_filename);
   } else {
-    pktsFile_ = nullptr;
+    return nullptr;
   }
+}
 
-  if (_latencyfile.size() > 0) {
-    latFile_ = std::make_shared<fio::OutFile>(_latencyfile);
+// opens a record output as a record table or as text by its file name
+static void openRecords(const std::string& _filename, Filter::Level _level,
+                        std::shared_ptr<RecordWriter>* _text,
+                        std::shared_ptr<TableWriter>* _table) {
+  if (isTableFile(_filename)) {
+    *_table = std::make_shared<TableWriter>(_filename, _level);
   } else {
-    latFile_ = nullptr;
+    *_text = openFile(_filename);
   }
+}
 
-  if (_hopcountfile.size() > 0) {
-    hopsFile_ = std::make_shared<fio::OutFile>(_hopcountfile);
-  } else {
-    hopsFile_ = nullptr;
+// the filter chain of each query
+static FilterChains filterChains(const std::vector<Query>& _queries) {
+  std::vector<std::vector<std::string> > chains;
+  std::vector<std::vector<std::string> > expressions;
+  for (const Query& query : _queries) {
+    chains.push_back(query.filters);
+    expressions.push_back(query.expressions);
   }
+  return FilterChains(chains, expressions);
+}
 
-  for (const std::string& filter : _filters) {
-    filters_.push_back(std::make_shared<Filter>(filter));
+Engine::Engine(const std::vector<Query>& _queries, f64 _scalar,
+               bool _packetHeaderLatency)
+    : scalar_(_scalar),
+      packetHeaderLatency_(_packetHeaderLatency),
+      chains_(filterChains(_queries)),
+      lastTransId_(0),
+      lastTransFsm_(nullptr) {
+  for (const Query& query : _queries) {
+    outputs_.emplace_back();
+    Outputs& outputs = outputs_.back();
+    openRecords(query.transactionsFile, Filter::Level::TRANSACTION,
+                &outputs.transFile, &outputs.transTable);
+    openRecords(query.messagesFile, Filter::Level::MESSAGE, &outputs.msgsFile,
+                &outputs.msgsTable);
+    openRecords(query.packetsFile, Filter::Level::PACKET, &outputs.pktsFile,
+                &outputs.pktsTable);
+    outputs.latFile = openFile(query.latencyFile);
+    outputs.hopsFile = openFile(query.hopCountFile);
+    outputs.matrixFile = openFile(query.matrixFile);
+    outputs.throughputFile = openFile(query.throughputFile);
+    if (outputs.throughputFile) {
+      outputs.throughput =
+          Throughput(query.throughputBinWidth, query.throughputGrouping);
+    }
+    outputs.transient = query.transient;
+    outputs.fixedTimes = query.fixedTimes;
+    outputs.latencySketch = query.latencySketch;
+    if (query.latencySketch > 0.0) {
+      outputs.transSketch = QuantileSketch(query.latencySketch);
+    }
   }
 
-  // initialize hop count variables
-  hopCounts_.resize(100, 0);
-  minHopCounts_.resize(100, 0);
-  nonMinHopCounts_.resize(100, 0);
-  pktCount_ = 0;
-  totalHops_ = 0;
-  minHops_ = 0;
-  nonMinHops_ = 0;
-  minPktCount_ = 0;
-  nonMinPktCount_ = 0;
-
-  msgFsm_.reset();
-  pktFsm_.reset();
+  partial_ = newPartial();
 }
 
 Engine::~Engine() {}
 
 void Engine::transactionStart(u64 _transId, u64 _transStart) {
   // add a new transaction FSM
-  transFsms_.emplace(_transId, TransFsm());
-  f64 transStartScaled = _transStart * scalar_;
-  transFsms_.at(_transId).start = transStartScaled;
+  transFsms_.emplace(_transId)->start = _transStart;
 }
 
 void Engine::transactionEnd(u64 _transId, u64 _transEnd) {
-  Engine::TransFsm& transFsm = transFsms_.at(_transId);
+  Engine::TransFsm& transFsm = *transaction(_transId);
 
   // finish the end time
-  f64 transEndScaled = _transEnd * scalar_;
-  assert(transEndScaled >= transFsm.end);
-  transFsm.end = transEndScaled;
-
-  // determine if transaction will be logged
-  bool logTransaction = true;
-  for (const auto& f : filters_) {
-    if (!f->transaction(_transId, transFsm.start, transFsm.end,
-                        transFsm.msgCount, transFsm.pktCount,
-                        transFsm.flitCount)) {
-      logTransaction = false;
-      break;
-    }
-  }
+  assert(_transEnd >= transFsm.end);
+  transFsm.end = _transEnd;
+  f64 start = transFsm.start * scalar_;
+  f64 end = transFsm.end * scalar_;
+
+  // determine which queries log the transaction
+  Filter::Record record;
+  Filter::transactionRecord(_transId, start, end, transFsm.msgCount,
+                            transFsm.pktCount, transFsm.flitCount, &record);
+  u64 logTransaction = chains_.evaluate(Filter::Level::TRANSACTION, record);
 
   // save transaction latency
-  if (logTransaction) {
-    transLatencies_.push_back(transFsm.end - transFsm.start);
-    if (transFile_) {
-      transFile_->write(std::to_string(transFsm.start) + "," +
-                        std::to_string(transFsm.end) + "\n");
+  for (u64 mask = logTransaction; mask != 0; mask &= mask - 1) {
+    Outputs& outputs = outputs_[__builtin_ctzll(mask)];
+    if (outputs.latFile) {
+      if (outputs.latencySketch > 0.0) {
+        outputs.transSketch.add((transFsm.end - transFsm.start) * scalar_);
+      } else {
+        outputs.transLatencies.add(transFsm.end - transFsm.start);
+      }
+    }
+    if (outputs.transFile) {
+      line_.clear();
+      appendTime(start, outputs.fixedTimes, &line_);
+      line_ += ',';
+      appendTime(end, outputs.fixedTimes, &line_);
+      line_ += '\n';
+      outputs.transFile->write(line_);
+    }
+    if (outputs.transTable) {
+      outputs.transTable->add(record);
+    }
+    if (outputs.throughputFile && outputs.throughput.grouping() !=
+                                      Throughput::Grouping::DESTINATION) {
+      outputs.throughput.add(Throughput::TRANSACTIONS,
+                             record.ints[Filter::APPLICATION_ID], end);
     }
   }
 
   // remove the transaction FSM
   transFsms_.erase(_transId);
+  lastTransFsm_ = nullptr;
 }
 
 void Engine::messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
                           u32 _protocolClass, u32 _minHopCount, u32 _opCode) {
-  (void)_msgId;  // unused
-  if (msgFsm_.enabled == true) {
-    throw ex::Exception("Two '+M's without '-M'. File corrupted :(\n");
-  }
-  msgFsm_.enabled = true;
-  msgFsm_.src = _msgSrc;
-  msgFsm_.dst = _msgDst;
-  msgFsm_.transId = _transId;
-  msgFsm_.protocolClass = _protocolClass;
-  msgFsm_.minHopCount = _minHopCount;
-  msgFsm_.opCode = _opCode;
-
-  // count this message in the transaction
-  Engine::TransFsm& transFsm = transFsms_.at(_transId);
-  transFsm.msgCount++;
+  partial_->messageStart(_msgId, _msgSrc, _msgDst, _transId, _protocolClass,
+                         _minHopCount, _opCode);
 }
 
 void Engine::messageEnd() {
-  if (msgFsm_.enabled == false) {
-    throw ex::Exception("Missing '+M'. File corrupted :(\n");
-  }
-
-  // determine if message will be logged
-  bool logMessage = true;
-  for (const auto& f : filters_) {
-    if (!f->message(msgFsm_.src, msgFsm_.dst, msgFsm_.transId,
-                    msgFsm_.protocolClass, msgFsm_.opCode, msgFsm_.start,
-                    msgFsm_.end, msgFsm_.pktCount, msgFsm_.flitCount,
-                    msgFsm_.minHopCount)) {
-      logMessage = false;
-      break;
-    }
-  }
+  partial_->messageEnd();
+  apply(partial_.get());
+}
 
-  // save message latency
-  if (logMessage) {
-    msgLatencies_.push_back(msgFsm_.end - msgFsm_.start);
-    if (msgsFile_) {
-      msgsFile_->write(std::to_string(msgFsm_.start) + "," +
-                       std::to_string(msgFsm_.end) + "," +
-                       std::to_string(msgFsm_.minHopCount) + "\n");
-    }
-  }
+void Engine::packetStart(u32 _pktId, u32 _pktHopCount) {
+  partial_->packetStart(_pktId, _pktHopCount);
+}
 
-  // update the transaction times
-  Engine::TransFsm& transFsm = transFsms_.at(msgFsm_.transId);
-  assert(msgFsm_.start >= transFsm.start);
-  if (msgFsm_.end > transFsm.end) {
-    transFsm.end = msgFsm_.end;
-  }
+void Engine::packetEnd() {
+  partial_->packetEnd();
+}
 
-  // reset the state machine
-  msgFsm_.reset();
+void Engine::flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) {
+  partial_->flit(_flitId, _flitSendTime, _flitReceiveTime);
 }
 
-void Engine::packetStart(u32 _pktId, u32 _pktHopCount) {
-  (void)_pktId;  // unused
-  if (msgFsm_.enabled == false) {
-    throw ex::Exception("Missing '+M'. File corrupted :(\n");
-  }
-  if (pktFsm_.enabled == true) {
-    throw ex::Exception("Two '+P's without '-S'. File corrupted :(\n");
-  }
-  pktFsm_.enabled = true;
-  pktFsm_.hopCount = _pktHopCount;
-  if (_pktHopCount >= msgFsm_.minHopCount) {
-    pktFsm_.nonMinHopCount = _pktHopCount - msgFsm_.minHopCount;
-  } else {
-    pktFsm_.nonMinHopCount = 0;
+void Engine::complete() {
+  // check that all state machines completed
+  if ((!transFsms_.empty()) || (!partial_->idle())) {
+    throw ex::Exception(
+        "ERROR: State machines didn't complete. "
+        "Input file is likely corrupted.\n");
   }
 
-  // count this packet in the transaction and message
-  Engine::TransFsm& transFsm = transFsms_.at(msgFsm_.transId);
-  transFsm.pktCount++;
-  msgFsm_.pktCount++;
-}
+  // write the records of the last batches
+  partial_->flush();
+  apply(partial_.get());
 
-void Engine::packetEnd() {
-  if (msgFsm_.enabled == false) {
-    throw ex::Exception("Missing '+M'. File corrupted :(\n");
-  }
-  if (pktFsm_.enabled == false) {
-    throw ex::Exception("Missing '+P'. File corrupted :(\n");
-  }
+  for (u32 query = 0; query < outputs_.size(); query++) {
+    const Outputs& outputs = outputs_[query];
 
-  // determine the right packet end time
-  f64 pktEnd = packetHeaderLatency_ ? pktFsm_.headEnd : pktFsm_.tailEnd;
-
-  // determine if the packet will be logged
-  bool logPacket = true;
-  for (const auto& f : filters_) {
-    if (!f->packet(msgFsm_.src, msgFsm_.dst, msgFsm_.transId,
-                   msgFsm_.protocolClass, msgFsm_.opCode, pktFsm_.headStart,
-                   pktEnd, pktFsm_.flitCount, pktFsm_.hopCount,
-                   msgFsm_.minHopCount, pktFsm_.nonMinHopCount)) {
-      logPacket = false;
-      break;
+    // write the last row groups of the record tables
+    for (const std::shared_ptr<TableWriter>& table :
+         {outputs.transTable, outputs.msgsTable, outputs.pktsTable}) {
+      if (table) {
+        table->complete();
+      }
     }
-  }
 
-  // save the packet latency
-  if (logPacket) {
-    pktLatencies_.push_back(pktEnd - pktFsm_.headStart);
-    processHopCounts(pktFsm_.hopCount, msgFsm_.minHopCount,
-                     pktFsm_.nonMinHopCount);
-    if (pktsFile_) {
-      pktsFile_->write(std::to_string(pktFsm_.headStart) + "," +
-                       std::to_string(pktEnd) + "," +
-                       std::to_string(pktFsm_.hopCount) + "," +
-                       std::to_string(msgFsm_.minHopCount) + "," +
-                       std::to_string(pktFsm_.nonMinHopCount) + "\n");
+    // generate aggregate total hops
+    if (outputs.hopsFile) {
+      writeHopCountFile(query);
     }
-  }
 
-  // update the message times
-  if (pktFsm_.headStart < msgFsm_.start) {
-    msgFsm_.start = pktFsm_.headStart;
-  }
-  if (pktFsm_.tailEnd > msgFsm_.end) {
-    msgFsm_.end = pktFsm_.tailEnd;
-  }
+    // generate aggregate latency log
+    if (outputs.latFile) {
+      writeLatencyFile(query);
+    }
 
-  // reset the state machine
-  pktFsm_.reset();
-}
+    // generate the traffic matrix
+    if (outputs.matrixFile) {
+      writeMatrixFile(query);
+    }
 
-void Engine::flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) {
-  if (pktFsm_.enabled == false) {
-    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+    // generate the delivered counts of each time bin
+    if (outputs.throughputFile) {
+      writeThroughputFile(query);
+    }
+
+    // generate time-binned aggregates
+    if (outputs.transient) {
+      outputs.transient->write(partial_->transientBins(query));
+    }
+
+    // wait for the text outputs to be written
+    for (const std::shared_ptr<RecordWriter>& file :
+         {outputs.transFile, outputs.msgsFile, outputs.pktsFile,
+          outputs.latFile, outputs.hopsFile, outputs.matrixFile,
+          outputs.throughputFile}) {
+      if (file) {
+        file->complete();
+      }
+    }
   }
-  if (pktFsm_.enabled == false) {
-    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+}
+
+void Engine::reserve(u64 _textSize) {
+  // a packet record takes at least this much text in practice, so this is an
+  // upper bound of the number of samples
+  const u64 BYTES_PER_PACKET = 64;
+  u64 count = _textSize / BYTES_PER_PACKET;
+  partial_->reserve(count);
+  for (Outputs& outputs : outputs_) {
+    if (outputs.latFile && outputs.latencySketch <= 0.0) {
+      outputs.transLatencies.reserve(count);
+    }
   }
+}
 
-  // count this flit in the transaction, message, and packet
-  Engine::TransFsm& transFsm = transFsms_.at(msgFsm_.transId);
-  transFsm.flitCount++;
-  msgFsm_.flitCount++;
-  pktFsm_.flitCount++;
+std::unique_ptr<Partial> Engine::newPartial() const {
+  std::vector<Partial::Outputs> outputs;
+  for (const Outputs& query : outputs_) {
+    outputs.push_back({query.msgsFile != nullptr, query.pktsFile != nullptr,
+                       query.fixedTimes, query.msgsTable != nullptr,
+                       query.pktsTable != nullptr, query.latFile != nullptr,
+                       query.latencySketch, query.hopsFile != nullptr,
+                       query.transient,
+                       query.matrixFile != nullptr,
+                       query.throughputFile ? query.throughput.binWidth() : 0.0,
+                       query.throughput.grouping()});
+  }
+  // partials start with the filter order learned so far
+  const FilterChains& chains = partial_ ? partial_->filterChains() : chains_;
+  return std::make_unique<Partial>(scalar_, packetHeaderLatency_, chains,
+                                   outputs);
+}
 
-  // scale the flit time
-  if (_flitSendTime > _flitReceiveTime) {
+void Engine::merge(Partial* _partial) {
+  // partials hold whole message blocks
+  if (!_partial->idle()) {
     throw ex::Exception(
-        "Flit received before it was sent? "
-        "File corrupted :(\n");
+        "ERROR: State machines didn't complete. "
+        "Input file is likely corrupted.\n");
   }
-  f64 sendTime = _flitSendTime * scalar_;
-  f64 recvTime = _flitReceiveTime * scalar_;
+  _partial->flush();
+  apply(_partial);
+  partial_->merge(_partial);
+}
 
-  // update th packet times
-  if (_flitId == 0) {
-    pktFsm_.headStart = sendTime;
-    pktFsm_.headEnd = recvTime;
-  } else {
-    // flit 0 should always be earliest
-    assert(sendTime >= pktFsm_.headStart);
-  }
-  if (recvTime > pktFsm_.tailEnd) {
-    pktFsm_.tailEnd = recvTime;
+bool Engine::mayAccept(u64 _minTime, u64 _maxTime, u64 _minTransId,
+                       u64 _maxTransId) const {
+  if (scalar_ <= 0) {
+    return true;  // times don't keep their order
   }
+  return chains_.mayAccept(_minTime * scalar_, _maxTime * scalar_,
+                           _minTransId, _maxTransId);
 }
 
-void Engine::complete() {
-  // check that all state machines completed
-  if ((!transFsms_.empty()) || (msgFsm_.enabled == true) ||
-      (pktFsm_.enabled == true)) {
+std::string Engine::filterStats() const {
+  // transactions are filtered here, messages and packets in the partials
+  FilterChains chains = chains_;
+  chains.mergeStats(partial_->filterChains());
+  return chains.statsTable();
+}
+
+void Engine::restart(const std::vector<std::pair<u64, u64> >& _open) {
+  // the message blocks are never split
+  if (!partial_->idle()) {
     throw ex::Exception(
         "ERROR: State machines didn't complete. "
         "Input file is likely corrupted.\n");
   }
 
-  // generate aggregate total hops
-  if (hopsFile_) {
-    writeHopCountFile();
+  // transactions that ended in the skipped part are dropped and the ones that
+  // started there are added, neither passes the filters so their counts
+  // don't matter
+  FlatTable<TransFsm> transFsms(_open.size());
+  for (const std::pair<u64, u64>& open : _open) {
+    const TransFsm* transFsm = transFsms_.find(open.first);
+    if (transFsm != nullptr) {
+      *transFsms.emplace(open.first) = *transFsm;
+    } else {
+      transFsms.emplace(open.first)->start = open.second;
+    }
   }
+  transFsms_.swap(transFsms);
+  lastTransFsm_ = nullptr;
+}
 
-  // generate aggregate latency log
-  if (latFile_) {
-    writeLatencyFile();
+Engine::TransFsm* Engine::transaction(u64 _transId) {
+  if (lastTransFsm_ == nullptr || lastTransId_ != _transId) {
+    lastTransFsm_ = transFsms_.find(_transId);
+    if (lastTransFsm_ == nullptr) {
+      throw ex::Exception(
+          "Missing '+T' of transaction %lu. File corrupted :(\n", _transId);
+    }
+    lastTransId_ = _transId;
   }
+  return lastTransFsm_;
 }
 
-void Engine::processHopCounts(u32 _hopCount, u32 _minHopCount,
-                              u32 _nonMinHopCount) {
-  pktCount_++;
-  totalHops_ += _hopCount;
-  minHops_ += _minHopCount;
-  nonMinHops_ += _nonMinHopCount;
-
-  hopCounts_.at(_hopCount)++;
-  minHopCounts_.at(_minHopCount)++;
-  nonMinHopCounts_.at(_nonMinHopCount)++;
-
-  (_nonMinHopCount > 0) ? (nonMinPktCount_++) : (minPktCount_++);
-}
+void Engine::apply(Partial* _partial) {
+  // resolve the transaction events in order
+  for (const Partial::Event& event : _partial->events()) {
+    switch (event.type) {
+      case Partial::Event::Type::TRANSACTION_START:
+        transactionStart(event.transId, event.time);
+        break;
 
-void Engine::writeHopCountFile() {
-  // range of hops
-  u32 startTotal = U32_MAX;
-  u32 endTotal = U32_MAX;
-  u32 startMin = U32_MAX;
-  u32 endMin = U32_MAX;
-  u32 startNonMin = U32_MAX;
-  u32 endNonMin = U32_MAX;
-
-  // total
-  if (pktCount_ > 0) {
-    for (u32 s = 0; s < hopCounts_.size(); s++) {
-      if (hopCounts_[s] != 0) {
-        startTotal = s;
+      case Partial::Event::Type::TRANSACTION_END:
+        transactionEnd(event.transId, event.time);
         break;
-      }
-    }
-    for (s32 e = (s32)hopCounts_.size(); e >= 0; e--) {
-      if (hopCounts_[e] != 0) {
-        endTotal = e;
+
+      case Partial::Event::Type::MESSAGE: {
+        // count the message in the transaction and update its times
+        Engine::TransFsm& transFsm = *transaction(event.transId);
+        transFsm.msgCount++;
+        transFsm.pktCount += event.pktCount;
+        transFsm.flitCount += event.flitCount;
+        assert(event.start >= transFsm.start);
+        if (event.end > transFsm.end) {
+          transFsm.end = event.end;
+        }
         break;
       }
     }
   }
-  // minimal
-  if (minPktCount_ > 0) {
-    for (u32 s = 0; s < minHopCounts_.size(); s++) {
-      if (minHopCounts_[s] != 0) {
-        startMin = s;
-        break;
-      }
+
+  // write the records
+  for (u32 query = 0; query < outputs_.size(); query++) {
+    const Outputs& outputs = outputs_[query];
+    if (outputs.msgsFile && !_partial->messageRecords(query).empty()) {
+      outputs.msgsFile->write(_partial->messageRecords(query));
     }
-    for (s32 e = (s32)minHopCounts_.size(); e >= 0; e--) {
-      if (minHopCounts_[e] != 0) {
-        endMin = e;
-        break;
-      }
+    if (outputs.pktsFile && !_partial->packetRecords(query).empty()) {
+      outputs.pktsFile->write(_partial->packetRecords(query));
     }
-  }
-  // non minimal
-  if (nonMinPktCount_ > 0) {
-    for (u32 s = 0; s < nonMinHopCounts_.size(); s++) {
-      if (nonMinHopCounts_[s] != 0) {
-        startNonMin = s;
-        break;
-      }
+    if (outputs.msgsTable) {
+      outputs.msgsTable->append(_partial->messageTable(query));
     }
-    for (s32 e = (s32)nonMinHopCounts_.size(); e >= 0; e--) {
-      if (nonMinHopCounts_[e] != 0) {
-        endNonMin = e;
-        break;
-      }
+    if (outputs.pktsTable) {
+      outputs.pktsTable->append(_partial->packetTable(query));
     }
   }
-  // -- write header
-  std::stringstream ss;
-  // total
-  ss << "Type,AveHops,";
-  if (startTotal != U32_MAX && endTotal != U32_MAX) {
-    for (u32 i = startTotal; i <= endTotal; i++) {
-      ss << "PerHops" << std::to_string(i) << ",";
-    }
+  _partial->clearEvents();
+}
+
+void Engine::writeHopCountFile(u32 _query) {
+  std::shared_ptr<RecordWriter> hopsFile = outputs_[_query].hopsFile;
+  Columns columns;
+  hopCountColumns(partial_->hopCounts(_query), &columns);
+
+  // write header
+  std::string header = "Type";
+  for (const auto& column : columns) {
+    header += "," + column.first;
   }
-  // minimal
-  ss << "AveMinHops,PerMinimal,";
-  if (startMin != U32_MAX && endMin != U32_MAX) {
-    for (u32 i = startMin; i <= endMin; i++) {
-      ss << "PerMinHops" << std::to_string(i) << ",";
-    }
+  hopsFile->write(header + "\n");
+
+  // write data
+  std::string data = "Packet";
+  for (const auto& column : columns) {
+    data += "," + column.second;
   }
-  // non minimal
-  ss << "AveNonMinHops,PerNonMinimal,";
-  if (startNonMin != U32_MAX && endNonMin != U32_MAX) {
-    for (u32 i = startNonMin; i <= endNonMin; i++) {
-      ss << "PerNonMinHops" << std::to_string(i) << ",";
+  hopsFile->write(data + "\n");
+}
+
+// the text of a statistic, nan without samples
+static std::string statistic(f64 _value, u64 _count) {
+  return _count > 0 ? std::to_string(_value) : "nan";
+}
+
+void Engine::writeMatrixFile(u32 _query) {
+  std::shared_ptr<RecordWriter> matrixFile = outputs_[_query].matrixFile;
+  matrixFile->write(
+      "Source,Destination,Messages,MessageMean,MessageMaximum,Packets,Flits,"
+      "PacketMean,PacketMaximum,PacketMedian,Packet90th%,Packet99th%\n");
+
+  // one row per pair with traffic
+  std::string line;
+  for (const TrafficMatrix::Cell* cell :
+       partial_->trafficMatrix(_query).cells()) {
+    const QuantileSketch& pktLatencies = cell->pktLatencies;
+    line = std::to_string(cell->src) + "," + std::to_string(cell->dst) + "," +
+           std::to_string(cell->messages) + "," +
+           statistic(cell->msgLatencySum / cell->messages, cell->messages) +
+           "," + statistic(cell->msgLatencyMax, cell->messages) + "," +
+           std::to_string(cell->packets) + "," + std::to_string(cell->flits) +
+           "," +
+           statistic(cell->pktLatencySum / cell->packets, cell->packets) +
+           "," + statistic(cell->pktLatencyMax, cell->packets);
+    for (f64 quantile : {0.5, 0.9, 0.99}) {
+      line += "," + statistic(pktLatencies.quantile(quantile), cell->packets);
     }
+    line += "\n";
+    matrixFile->write(line);
   }
-  std::string header = ss.str();
-  header.at(header.size() - 1) = '\n';
-  hopsFile_->write(header);
-
-  // -- write data
-  std::string data;
-  ss.str(std::string());
-  // total
-  ss << "Packet,";
-  if (pktCount_ > 0) {
-    f64 aveHops = (f64)totalHops_ / (f64)pktCount_;
-    ss << std::to_string(aveHops) << ",";  // aveHops
-    if (startTotal != U32_MAX && endTotal != U32_MAX) {
-      for (u32 i = startTotal; i <= endTotal; i++) {
-        f64 perHops = (f64)hopCounts_[i] / (f64)pktCount_;
-        ss << std::to_string(perHops) << ",";  // perh
-      }
-    }
-    // minimal hops
-    f64 aveMinHops = (f64)minHops_ / (f64)pktCount_;
-    f64 perMin = (f64)minPktCount_ / (f64)pktCount_;
-    ss << std::to_string(aveMinHops) << "," << std::to_string(perMin) << ",";
-    if (startMin != U32_MAX && endMin != U32_MAX) {
-      f64 cumPerMinHops = 0.0;
-      for (u32 i = startMin; i <= endMin; i++) {
-        f64 perMinHops = (f64)minHopCounts_[i] / (f64)pktCount_;
-        cumPerMinHops += perMinHops;
-        ss << std::to_string(perMinHops) << ",";
+}
+
+void Engine::writeThroughputFile(u32 _query) {
+  Outputs& outputs = outputs_[_query];
+  Throughput& throughput = outputs.throughput;
+  throughput.merge(partial_->throughput(_query));
+
+  // transactions have no destination
+  std::string header = "Time";
+  u32 kinds = Throughput::NUM_KINDS;
+  switch (throughput.grouping()) {
+    case Throughput::Grouping::NONE:
+      break;
+    case Throughput::Grouping::DESTINATION:
+      header += ",Destination";
+      kinds = Throughput::TRANSACTIONS;
+      break;
+    case Throughput::Grouping::APPLICATION:
+      header += ",Application";
+      break;
+  }
+  const char* names[] = {"Flits", "Packets", "Messages", "Transactions"};
+  for (u32 kind = 0; kind < kinds; kind++) {
+    header += ',';
+    header += names[kind];
+  }
+  outputs.throughputFile->write(header + "\n");
+
+  // one row per bin and group, from the first to the last delivery
+  std::vector<u64> groups = throughput.groups();
+  std::string line;
+  for (u64 bin = throughput.firstBin(); bin < throughput.endBin(); bin++) {
+    std::string time = std::to_string(bin * throughput.binWidth());
+    for (u64 group : groups) {
+      line = time;
+      if (throughput.grouping() != Throughput::Grouping::NONE) {
+        line += ',';
+        appendU64(group, &line);
       }
-      assert(cumPerMinHops <= (1.00 + TOLERANCE) &&
-             cumPerMinHops >= (1.00 - TOLERANCE));
-    }
-    // nonminimal hops
-    f64 aveNonMinHops = (f64)nonMinHops_ / (f64)pktCount_;
-    f64 perNonMin = (f64)nonMinPktCount_ / (f64)pktCount_;
-    ss << std::to_string(aveNonMinHops) << ",";  // aveNMHops
-    ss << std::to_string(perNonMin) << ",";      // perNM
-    if (startNonMin != U32_MAX && endNonMin != U32_MAX) {
-      f64 cumPerNonMinHops = 0.0;
-      for (u32 i = startNonMin; i <= endNonMin; i++) {
-        f64 perNonMinHops = (f64)nonMinHopCounts_[i] / (f64)pktCount_;
-        cumPerNonMinHops += perNonMinHops;
-        ss << std::to_string(perNonMinHops) << ",";
+      Throughput::Counts counts = throughput.counts(group, bin);
+      for (u32 kind = 0; kind < kinds; kind++) {
+        line += ',';
+        appendU64(counts.count[kind], &line);
       }
-      assert(cumPerNonMinHops <= (1.00 + TOLERANCE) &&
-             cumPerNonMinHops >= (1.00 - TOLERANCE));
+      line += '\n';
+      outputs.throughputFile->write(line);
     }
-    data = ss.str();
-    data.at(data.size() - 1) = '\n';
-
-    // asserts
-    f64 sumPerPkt = ((f64)minPktCount_ / (f64)pktCount_) +
-                    ((f64)nonMinPktCount_ / (f64)pktCount_);
-    assert(minPktCount_ + nonMinPktCount_ == pktCount_);
-    assert(sumPerPkt <= (1.00 + TOLERANCE) && sumPerPkt >= (1.00 - TOLERANCE));
-  } else {
-    data = "Packet,nan,nan,nan,nan,nan\n";
   }
-  hopsFile_->write(data);
 }
 
-void Engine::writeLatencyFile() {
-  // sort data
-  std::sort(transLatencies_.begin(), transLatencies_.end());
-  std::sort(msgLatencies_.begin(), msgLatencies_.end());
-  std::sort(pktLatencies_.begin(), pktLatencies_.end());
-
-  // complete arithmetic mean, variance, and standard deviation
-  f64 transMean = mut::arithmeticMean<f64>(transLatencies_);
-  f64 msgMean = mut::arithmeticMean<f64>(msgLatencies_);
-  f64 pktMean = mut::arithmeticMean<f64>(pktLatencies_);
-
-  f64 transVariance = mut::variance<f64>(transLatencies_, transMean);
-  f64 msgVariance = mut::variance<f64>(msgLatencies_, msgMean);
-  f64 pktVariance = mut::variance<f64>(pktLatencies_, pktMean);
-
-  f64 transStdDev = mut::standardDeviation<f64>(transVariance);
-  f64 msgStdDev = mut::standardDeviation<f64>(msgVariance);
-  f64 pktStdDev = mut::standardDeviation<f64>(pktVariance);
-
-  // write header
-  latFile_->write("Type,");
-  latFile_->write("Count,");
-  latFile_->write("Minimum,");
-  latFile_->write("Maximum,");
-  latFile_->write("Median,");
-  latFile_->write("90th%,");
-  latFile_->write("99th%,");
-  latFile_->write("99.9th%,");
-  latFile_->write("99.99th%,");
-  latFile_->write("99.999th%,");
-  latFile_->write("Mean,");
-  latFile_->write("Variance,");
-  latFile_->write("StdDev\n");
-
-  f64 pmin, pmax, p50, p90, p99, p999, p9999, p99999;
-  u64 size;
-
-  // write packet statistics
-  size = pktLatencies_.size();
-  latFile_->write("Packet,");
-  latFile_->write(std::to_string(size) + ",");
-  if (size > 0) {
-    pmin = 0;
-    pmax = size - 1;
-    p50 = round(pmax * 0.50);
-    p90 = round(pmax * 0.90);
-    p99 = round(pmax * 0.99);
-    p999 = round(pmax * 0.999);
-    p9999 = round(pmax * 0.9999);
-    p99999 = round(pmax * 0.99999);
-    latFile_->write(std::to_string(pktLatencies_.at(pmin)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(pmax)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p50)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p90)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p99)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p999)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p9999)) + ",");
-    latFile_->write(std::to_string(pktLatencies_.at(p99999)) + ",");
-    latFile_->write(std::to_string(pktMean) + ",");
-    latFile_->write(std::to_string(pktVariance) + ",");
-    latFile_->write(std::to_string(pktStdDev) + "\n");
-  } else {
-    latFile_->write("nan,nan,nan,nan,nan,nan,nan,nan,nan,nan,nan\n");
+void Engine::writeLatencyFile(u32 _query) {
+  const Outputs& outputs = outputs_[_query];
+  const char* names[] = {"Packet", "Message", "Transaction"};
+  LatencySamples* latencies[] = {partial_->packetLatencies(_query),
+                                 partial_->messageLatencies(_query),
+                                 &outputs_[_query].transLatencies};
+  const QuantileSketch* sketches[] = {&partial_->packetSketch(_query),
+                                      &partial_->messageSketch(_query),
+                                      &outputs.transSketch};
+
+  // the rows are computed concurrently
+  std::future<Columns> futures[3];
+  for (u32 row = 0; row < 3; row++) {
+    futures[row] = std::async(std::launch::async, [&, row]() {
+      Columns columns;
+      if (outputs.latencySketch > 0.0) {
+        latencyColumns(*sketches[row], &columns);
+      } else {
+        latencyColumns(latencies[row], scalar_, &columns);
+      }
+      return columns;
+    });
   }
 
-  size = msgLatencies_.size();
-  latFile_->write("Message,");
-  latFile_->write(std::to_string(size) + ",");
-  if (size > 0) {
-    pmin = 0;
-    pmax = size - 1;
-    p50 = round(pmax * 0.50);
-    p90 = round(pmax * 0.90);
-    p99 = round(pmax * 0.99);
-    p999 = round(pmax * 0.999);
-    p9999 = round(pmax * 0.9999);
-    p99999 = round(pmax * 0.99999);
-    latFile_->write(std::to_string(msgLatencies_.at(pmin)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(pmax)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p50)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p90)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p99)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p999)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p9999)) + ",");
-    latFile_->write(std::to_string(msgLatencies_.at(p99999)) + ",");
-    latFile_->write(std::to_string(msgMean) + ",");
-    latFile_->write(std::to_string(msgVariance) + ",");
-    latFile_->write(std::to_string(msgStdDev) + "\n");
-  } else {
-    latFile_->write("nan,nan,nan,nan,nan,nan,nan,nan,nan,nan,nan\n");
-  }
+  for (u32 row = 0; row < 3; row++) {
+    Columns columns = futures[row].get();
 
-  size = transLatencies_.size();
-  latFile_->write("Transaction,");
-  latFile_->write(std::to_string(size) + ",");
-  if (size > 0) {
-    pmin = 0;
-    pmax = size - 1;
-    p50 = round(pmax * 0.50);
-    p90 = round(pmax * 0.90);
-    p99 = round(pmax * 0.99);
-    p999 = round(pmax * 0.999);
-    p9999 = round(pmax * 0.9999);
-    p99999 = round(pmax * 0.99999);
-
-    latFile_->write(std::to_string(transLatencies_.at(pmin)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(pmax)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p50)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p90)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p99)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p999)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p9999)) + ",");
-    latFile_->write(std::to_string(transLatencies_.at(p99999)) + ",");
-    latFile_->write(std::to_string(transMean) + ",");
-    latFile_->write(std::to_string(transVariance) + ",");
-    latFile_->write(std::to_string(transStdDev) + "\n");
-  } else {
-    latFile_->write("nan,nan,nan,nan,nan,nan,nan,nan,nan,nan,nan\n");
+    // write header
+    if (row == 0) {
+      std::string header = "Type";
+      for (const auto& column : columns) {
+        header += "," + column.first;
+      }
+      outputs.latFile->write(header + "\n");
+    }
+
+    // write statistics
+    std::string data = names[row];
+    for (const auto& column : columns) {
+      data += "," + column.second;
+    }
+    outputs.latFile->write(data + "\n");
   }
 }
@@ -31,69 +31,106 @@
 #ifndef PARSE_ENGINE_H_
 #define PARSE_ENGINE_H_
 
-#include <fio/OutFile.h>
 #include <prim/prim.h>
 
 #include <memory>
 #include <string>
 #include <tuple>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#include "parse/Filter.h"
-
-class Engine {
+#include "parse/FilterChains.h"
+#include "parse/FlatTable.h"
+#include "parse/Partial.h"
+#include "parse/QuantileSketch.h"
+#include "parse/Query.h"
+#include "parse/RecordHandler.h"
+#include "parse/RecordWriter.h"
+#include "parse/TableWriter.h"
+#include "parse/Throughput.h"
+#include "parse/Transient.h"
+
+// This class computes the outputs of a message log. Transactions are tracked
+// here while the message blocks are processed by a Partial. For multi-threaded
+// parsing, message blocks can be processed into separate partials which are
+// then merged in file order. Every query gets its own outputs from the same
+// pass over the log.
+class Engine : public RecordHandler {
  public:
-  Engine(const std::string& _transactionsFile, const std::string& _messagesFile,
-         const std::string& _packetsFile, const std::string& _latencyfile,
-         const std::string& _hopcountfile, f64 _scalar,
-         bool _packetHeaderLatency, const std::vector<std::string>& _filters);
-  ~Engine();
-
-  void transactionStart(u64 _transId, u64 _transStart);
-  void transactionEnd(u64 _transId, u64 _transEnd);
+  Engine(const std::vector<Query>& _queries, f64 _scalar,
+         bool _packetHeaderLatency);
+  ~Engine() override;
+
+  void transactionStart(u64 _transId, u64 _transStart) override;
+  void transactionEnd(u64 _transId, u64 _transEnd) override;
   void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
-                    u32 _protocolClass, u32 _minHopCount, u32 _opCode);
-  void messageEnd();
-  void packetStart(u32 _pktId, u32 _pktHopCount);
-  void packetEnd();
-  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime);
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override;
+  void messageEnd() override;
+  void packetStart(u32 _pktId, u32 _pktHopCount) override;
+  void packetEnd() override;
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override;
   void complete();
 
- private:
-  void writeLatencyFile();
-  void writeHopCountFile();
-  void processHopCounts(u32 _hopCount, u32 _minHopCount, u32 _nonMinHopCount);
+  // sizes the latency storage up front for a log of about _textSize bytes
+  void reserve(u64 _textSize);
+
+  // creates an empty partial with this engine's settings
+  std::unique_ptr<Partial> newPartial() const;
+
+  // merges the next partial in file order
+  void merge(Partial* _partial);
 
-  std::shared_ptr<fio::OutFile> transFile_;
-  std::shared_ptr<fio::OutFile> msgsFile_;
-  std::shared_ptr<fio::OutFile> pktsFile_;
-  std::shared_ptr<fio::OutFile> latFile_;
-  std::shared_ptr<fio::OutFile> hopsFile_;
+  // returns false if no record with times in [_minTime, _maxTime] and
+  // transaction ids in [_minTransId, _maxTransId] passes any query's filters
+  bool mayAccept(u64 _minTime, u64 _maxTime, u64 _minTransId,
+                 u64 _maxTransId) const;
+
+  // the evaluation and rejection counts of the filters as a table
+  std::string filterStats() const;
+
+  // continues after a skipped part of the log, _open holds the id and start
+  // time of each transaction that is open where parsing continues
+  void restart(const std::vector<std::pair<u64, u64> >& _open);
+
+ private:
+  void apply(Partial* _partial);
+  void writeLatencyFile(u32 _query);
+  void writeHopCountFile(u32 _query);
+  void writeMatrixFile(u32 _query);
+  void writeThroughputFile(u32 _query);
+
+  // the outputs of a query
+  struct Outputs {
+    std::shared_ptr<RecordWriter> transFile;
+    std::shared_ptr<RecordWriter> msgsFile;
+    std::shared_ptr<RecordWriter> pktsFile;
+    std::shared_ptr<RecordWriter> latFile;
+    std::shared_ptr<RecordWriter> hopsFile;
+    std::shared_ptr<RecordWriter> matrixFile;
+    std::shared_ptr<RecordWriter> throughputFile;
+    std::shared_ptr<TableWriter> transTable;
+    std::shared_ptr<TableWriter> msgsTable;
+    std::shared_ptr<TableWriter> pktsTable;
+    std::shared_ptr<Transient> transient;
+    bool fixedTimes;
+
+    // transaction latencies for aggregate computations
+    f64 latencySketch;
+    LatencySamples transLatencies;
+    QuantileSketch transSketch;
+
+    // transaction counts, the partial counts the rest
+    Throughput throughput;
+  };
+  std::vector<Outputs> outputs_;
 
   const f64 scalar_;
   const bool packetHeaderLatency_;
-  std::vector<std::shared_ptr<Filter> > filters_;
-
-  // latency vectors for aggregate computations
-  //  holds each latency sample
-  std::vector<f64> transLatencies_;
-  std::vector<f64> msgLatencies_;
-  std::vector<f64> pktLatencies_;
-
-  // packet hop counts for aggregate computations
-  // hop counts
-  u64 pktCount_;
-  u64 totalHops_;
-  u64 minHops_;
-  u64 nonMinHops_;
-  std::vector<u64> hopCounts_;        // [hopcount]
-  std::vector<u64> minHopCounts_;     // [minhopcount]
-  std::vector<u64> nonMinHopCounts_;  // [nonminhopcount]
-
-  // packet counts
-  u64 minPktCount_;
-  u64 nonMinPktCount_;
+  FilterChains chains_;
+
+  // message, packet, and hop count state
+  std::unique_ptr<Partial> partial_;
 
   // transaction state machines
   struct TransFsm {
@@ -101,49 +138,24 @@ class Engine {
     ~TransFsm();
     void reset();
 
-    f64 start;
-    f64 end;
+    u64 start;  // unscaled
+    u64 end;
     u32 msgCount;
     u32 pktCount;
     u32 flitCount;
   };
-  std::unordered_map<u64, TransFsm> transFsms_;
+  FlatTable<TransFsm> transFsms_;
 
-  // message state machine
-  struct MsgFsm {
-    MsgFsm();
-    ~MsgFsm();
-    void reset();
+  // returns the state machine of an open transaction
+  TransFsm* transaction(u64 _transId);
 
-    bool enabled;
-    f64 start;
-    f64 end;
-    u32 src;
-    u32 dst;
-    u64 transId;
-    u32 protocolClass;
-    u32 pktCount;
-    u32 flitCount;
-    u32 minHopCount;
-    u32 opCode;
-  };
-  MsgFsm msgFsm_;
+  // the last transaction looked up, consecutive events mostly belong to the
+  // same one
+  u64 lastTransId_;
+  TransFsm* lastTransFsm_;  // nullptr if not cached
 
-  // packet state machine
-  struct PktFsm {
-    PktFsm();
-    ~PktFsm();
-    void reset();
-
-    bool enabled;
-    f64 headStart;
-    f64 headEnd;
-    f64 tailEnd;
-    u32 hopCount;
-    u32 flitCount;
-    u32 nonMinHopCount;
-  };
-  PktFsm pktFsm_;
+  // reused for formatting transaction records
+  std::string line_;
 };
 
 #endif  // PARSE_ENGINE_H_
@@ -0,0 +1,288 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Expression.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cassert>
+
+Expression::Expression(const std::string& _text) : text_(_text), pos_(0) {
+  root_ = parseOr(false);
+  if (peek() != '\0') {
+    throw ex::Exception("unexpected '%c' at %lu in expression: %s", peek(),
+                        pos_, text_.c_str());
+  }
+  for (u32 level = 0; level < 3; level++) {
+    roots_[level] = compile(level, root_);
+  }
+}
+
+Expression::~Expression() {}
+
+bool Expression::applies(Filter::Level _level) const {
+  return roots_[(u32)_level] != U32_MAX;
+}
+
+bool Expression::accept(const Filter::Record& _record) const {
+  u32 level = (u32)_record.level;
+  return roots_[level] == U32_MAX ||
+         accept(programs_[level], roots_[level], _record);
+}
+
+void Expression::accept(const Filter::Columns& _columns, u8* _accepted) const {
+  u32 level = (u32)_columns.level;
+  if (roots_[level] == U32_MAX) {
+    std::fill(_accepted, _accepted + _columns.size, 1);
+  } else {
+    accept(programs_[level], roots_[level], _columns, _accepted);
+  }
+}
+
+f64 Expression::cost() const {
+  f64 cost = 0.0;
+  for (const Filter& term : terms_) {
+    cost += term.cost();
+  }
+  return cost;
+}
+
+bool Expression::mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                           u64 _maxTransId) const {
+  return mayAccept(root_, _minTime, _maxTime, _minTransId, _maxTransId);
+}
+
+u32 Expression::parseOr(bool _negate) {
+  std::vector<u32> children = {parseAnd(_negate)};
+  while (peek() == '|') {
+    pos_++;
+    children.push_back(parseAnd(_negate));
+  }
+  if (children.size() == 1) {
+    return children.front();
+  }
+  tree_.push_back({_negate ? Node::Op::AND : Node::Op::OR, 0, children});
+  return tree_.size() - 1;
+}
+
+u32 Expression::parseAnd(bool _negate) {
+  std::vector<u32> children = {parseUnary(_negate)};
+  while (peek() == '&') {
+    pos_++;
+    children.push_back(parseUnary(_negate));
+  }
+  if (children.size() == 1) {
+    return children.front();
+  }
+  tree_.push_back({_negate ? Node::Op::OR : Node::Op::AND, 0, children});
+  return tree_.size() - 1;
+}
+
+u32 Expression::parseUnary(bool _negate) {
+  char c = peek();
+  if (c == '!') {
+    pos_++;
+    return parseUnary(!_negate);
+  }
+  if (c == '(') {
+    pos_++;
+    u32 node = parseOr(_negate);
+    if (peek() != ')') {
+      throw ex::Exception("missing ')' at %lu in expression: %s", pos_,
+                          text_.c_str());
+    }
+    pos_++;
+    return node;
+  }
+  return parseTerm(_negate);
+}
+
+u32 Expression::parseTerm(bool _negate) {
+  peek();
+  u64 start = pos_;
+  while (pos_ < text_.size() && text_[pos_] != ' ' && text_[pos_] != '\t' &&
+         text_[pos_] != '(' && text_[pos_] != ')' && text_[pos_] != '|' &&
+         text_[pos_] != '&' && text_[pos_] != '!') {
+    pos_++;
+  }
+  if (pos_ == start) {
+    throw ex::Exception("missing filter at %lu in expression: %s", pos_,
+                        text_.c_str());
+  }
+
+  // a negated term is a rejecting filter
+  std::string term = text_.substr(start, pos_ - start);
+  bool accept = true;
+  if (term[0] == '+' || term[0] == '-') {
+    accept = (term[0] == '+');
+    term = term.substr(1);
+  }
+  std::string description = ((accept != _negate) ? "+" : "-") + term;
+
+  u32 index = 0;
+  while (index < terms_.size() && terms_[index].description() != description) {
+    index++;
+  }
+  if (index == terms_.size()) {
+    terms_.emplace_back(description);
+  }
+  tree_.push_back({Node::Op::TERM, index, {}});
+  return tree_.size() - 1;
+}
+
+char Expression::peek() {
+  while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) {
+    pos_++;
+  }
+  return pos_ < text_.size() ? text_[pos_] : '\0';
+}
+
+u32 Expression::compile(u32 _level, u32 _node) {
+  const Node& node = tree_[_node];
+  std::vector<Node>& program = programs_[_level];
+  if (node.op == Node::Op::TERM) {
+    if (!terms_[node.term].applies((Filter::Level)_level)) {
+      return U32_MAX;  // always true
+    }
+    program.push_back(node);
+    return program.size() - 1;
+  }
+
+  // true children are dropped from ands and make ors true
+  std::vector<u32> children;
+  for (u32 child : node.children) {
+    u32 compiled = compile(_level, child);
+    if (compiled != U32_MAX) {
+      children.push_back(compiled);
+    } else if (node.op == Node::Op::OR) {
+      return U32_MAX;
+    }
+  }
+  if (children.empty()) {
+    return U32_MAX;
+  }
+  if (children.size() == 1) {
+    return children.front();
+  }
+  program.push_back({node.op, 0, children});
+  return program.size() - 1;
+}
+
+bool Expression::accept(const std::vector<Node>& _program, u32 _node,
+                        const Filter::Record& _record) const {
+  const Node& node = _program[_node];
+  switch (node.op) {
+    case Node::Op::TERM:
+      return terms_[node.term].accept(_record);
+
+    case Node::Op::AND:
+      for (u32 child : node.children) {
+        if (!accept(_program, child, _record)) {
+          return false;
+        }
+      }
+      return true;
+
+    case Node::Op::OR:
+      for (u32 child : node.children) {
+        if (accept(_program, child, _record)) {
+          return true;
+        }
+      }
+      return false;
+  }
+  assert(false);
+  return true;
+}
+
+void Expression::accept(const std::vector<Node>& _program, u32 _node,
+                        const Filter::Columns& _columns,
+                        u8* _accepted) const {
+  const Node& node = _program[_node];
+  u32 rows = _columns.size;
+  if (node.op == Node::Op::TERM) {
+    terms_[node.term].accept(_columns, _accepted);
+    return;
+  }
+  assert(node.op == Node::Op::AND || node.op == Node::Op::OR);
+
+  // later children are skipped once every row is decided
+  bool isAnd = (node.op == Node::Op::AND);
+  accept(_program, node.children[0], _columns, _accepted);
+  std::vector<u8> child(rows);
+  for (u32 idx = 1; idx < node.children.size(); idx++) {
+    u32 count = 0;
+    for (u32 row = 0; row < rows; row++) {
+      count += _accepted[row];
+    }
+    if (count == (isAnd ? 0 : rows)) {
+      break;
+    }
+    accept(_program, node.children[idx], _columns, child.data());
+    if (isAnd) {
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] &= child[row];
+      }
+    } else {
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] |= child[row];
+      }
+    }
+  }
+}
+
+bool Expression::mayAccept(u32 _node, f64 _minTime, f64 _maxTime,
+                           u64 _minTransId, u64 _maxTransId) const {
+  const Node& node = tree_[_node];
+  switch (node.op) {
+    case Node::Op::TERM:
+      return terms_[node.term].mayAccept(_minTime, _maxTime, _minTransId,
+                                         _maxTransId);
+
+    case Node::Op::AND:
+      for (u32 child : node.children) {
+        if (!mayAccept(child, _minTime, _maxTime, _minTransId, _maxTransId)) {
+          return false;
+        }
+      }
+      return true;
+
+    case Node::Op::OR:
+      for (u32 child : node.children) {
+        if (mayAccept(child, _minTime, _maxTime, _minTransId, _maxTransId)) {
+          return true;
+        }
+      }
+      return false;
+  }
+  assert(false);
+  return true;
+}
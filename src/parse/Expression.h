@@ -0,0 +1,103 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_EXPRESSION_H_
+#define PARSE_EXPRESSION_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/Filter.h"
+
+// This class evaluates a boolean expression of filter terms, for example:
+//   (app=0 | (pc=2 & src=0-15)) & !op=7
+// Terms use the filter syntax with an optional '+' or '-' flag. '!' binds
+// tighter than '&', which binds tighter than '|'. Negations are pushed down
+// to the terms when parsing so every term is a plain filter. The expression
+// is compiled once per level, terms that don't apply to a level accept all of
+// its records just like separate filters do. Evaluation short-circuits.
+class Expression {
+ public:
+  explicit Expression(const std::string& _text);
+  ~Expression();
+
+  // returns false if the expression accepts all records of the level
+  bool applies(Filter::Level _level) const;
+
+  // evaluates a record or a batch of records
+  bool accept(const Filter::Record& _record) const;
+  void accept(const Filter::Columns& _columns, u8* _accepted) const;
+
+  // the sum of the term costs
+  f64 cost() const;
+
+  // see Filter::mayAccept()
+  bool mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                 u64 _maxTransId) const;
+
+ private:
+  struct Node {
+    enum class Op { TERM, AND, OR };
+    Op op;
+    u32 term;                   // index into terms_
+    std::vector<u32> children;  // indices into the same node list
+  };
+
+  // recursive descent parsing, _negate applies De Morgan's laws
+  u32 parseOr(bool _negate);
+  u32 parseAnd(bool _negate);
+  u32 parseUnary(bool _negate);
+  u32 parseTerm(bool _negate);
+  char peek();
+
+  // copies the subtree of the parse tree into the program of a level without
+  // the terms that don't apply to it
+  u32 compile(u32 _level, u32 _node);
+
+  bool accept(const std::vector<Node>& _program, u32 _node,
+              const Filter::Record& _record) const;
+  void accept(const std::vector<Node>& _program, u32 _node,
+              const Filter::Columns& _columns, u8* _accepted) const;
+  bool mayAccept(u32 _node, f64 _minTime, f64 _maxTime, u64 _minTransId,
+                 u64 _maxTransId) const;
+
+  std::string text_;
+  u64 pos_;  // parse position
+
+  std::vector<Filter> terms_;      // distinct terms
+  std::vector<Node> tree_;         // parse tree
+  u32 root_;
+  std::vector<Node> programs_[3];  // [level]
+  u32 roots_[3];                   // [level], U32_MAX if always true
+};
+
+#endif  // PARSE_EXPRESSION_H_
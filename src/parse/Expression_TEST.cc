@@ -0,0 +1,155 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Expression.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+static Filter::Record message(u32 _app, u32 _pc, u32 _src, u32 _opcode) {
+  Filter::Record record;
+  Filter::messageRecord(_src, 0, (u64)_app << 56, _pc, _opcode, 0, 0, 0, 0, 0,
+                        &record);
+  return record;
+}
+
+TEST(Expression, evaluate) {
+  Expression expr("(app=0 | (pc=2 & src=0-15)) & !op=7");
+  ASSERT_TRUE(expr.applies(Filter::Level::MESSAGE));
+  for (u32 app = 0; app < 2; app++) {
+    for (u32 pc = 1; pc < 4; pc++) {
+      for (u32 src = 10; src < 20; src += 5) {
+        for (u32 op = 6; op < 9; op++) {
+          bool in = (app == 0 || (pc == 2 && src <= 15)) && op != 7;
+          ASSERT_EQ(expr.accept(message(app, pc, src, op)), in)
+              << app << " " << pc << " " << src << " " << op;
+        }
+      }
+    }
+  }
+
+  // precedence and flags
+  Expression prec("+app=0|-pc=2&pc=0-1");
+  ASSERT_TRUE(prec.accept(message(0, 2, 0, 0)));
+  ASSERT_TRUE(prec.accept(message(1, 1, 0, 0)));
+  ASSERT_FALSE(prec.accept(message(1, 2, 0, 0)));
+  ASSERT_FALSE(prec.accept(message(1, 3, 0, 0)));
+  Expression twice("!!(app=1)");
+  ASSERT_TRUE(twice.accept(message(1, 0, 0, 0)));
+  ASSERT_FALSE(twice.accept(message(0, 0, 0, 0)));
+  ASSERT_TRUE(Expression("!(app=1 | pc=0)").accept(message(0, 1, 0, 0)));
+  ASSERT_FALSE(Expression("!(app=1 | pc=0)").accept(message(0, 0, 0, 0)));
+}
+
+TEST(Expression, flaggedFirstTerm) {
+  Expression either("+app=0 | +pc=2");
+  ASSERT_TRUE(either.accept(message(0, 1, 0, 0)));
+  ASSERT_TRUE(either.accept(message(1, 2, 0, 0)));
+  ASSERT_FALSE(either.accept(message(1, 1, 0, 0)));
+  Expression both("-op=7 & app=0");
+  ASSERT_TRUE(both.accept(message(0, 0, 0, 6)));
+  ASSERT_FALSE(both.accept(message(0, 0, 0, 7)));
+  ASSERT_FALSE(both.accept(message(1, 0, 0, 6)));
+}
+
+TEST(Expression, levels) {
+  // terms that don't apply to a level accept all of its records
+  Expression expr("(app=0 | pc=2) & !op=7");
+  ASSERT_FALSE(expr.applies(Filter::Level::TRANSACTION));
+  Filter::Record record;
+  Filter::transactionRecord(1lu << 56, 0, 0, 0, 0, 0, &record);
+  ASSERT_TRUE(expr.accept(record));
+  Expression app("app=0 & !op=7");
+  ASSERT_TRUE(app.applies(Filter::Level::TRANSACTION));
+  ASSERT_FALSE(app.accept(record));
+
+  Expression hops("hc=2 & !pc=1");
+  ASSERT_FALSE(hops.applies(Filter::Level::TRANSACTION));
+  ASSERT_TRUE(hops.applies(Filter::Level::MESSAGE));
+  ASSERT_FALSE(hops.accept(message(0, 1, 0, 0)));
+  Filter::packetRecord(0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0, &record);
+  ASSERT_FALSE(hops.accept(record));
+  Filter::packetRecord(0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, &record);
+  ASSERT_TRUE(hops.accept(record));
+
+  // filters hold expressions
+  Filter filter("hc=2 | msgcnt=1");
+  ASSERT_TRUE(filter.transaction(0, 0, 0, 5, 0, 0));
+  ASSERT_TRUE(filter.packet(0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0));
+  ASSERT_EQ(filter.description(), "hc=2 | msgcnt=1");
+}
+
+TEST(Expression, columns) {
+  Expression expr("(app=0 | (pc=2 & src=0-15)) & !op=7");
+  Filter::Columns columns(64);
+  std::vector<Filter::Record> records;
+  for (u32 row = 0; row < 64; row++) {
+    records.push_back(message(row % 2, row % 3 + 1, row % 20, row % 9));
+    columns.add(records.back());
+  }
+  std::vector<u8> accepted(columns.size);
+  expr.accept(columns, accepted.data());
+  for (u32 row = 0; row < columns.size; row++) {
+    ASSERT_EQ(accepted[row], expr.accept(records[row])) << row;
+  }
+
+  // whole batches decided early
+  columns.size = 4;
+  for (u32 row = 0; row < 4; row++) {
+    columns.ints[Filter::OPCODE_ID][row] = 7;
+  }
+  accepted.resize(columns.size);
+  expr.accept(columns, accepted.data());
+  ASSERT_EQ(accepted, std::vector<u8>({0, 0, 0, 0}));
+}
+
+TEST(Expression, mayAccept) {
+  Expression expr("app=1 | send=100-200");
+  ASSERT_TRUE(expr.mayAccept(150, 300, 0, 10));
+  ASSERT_TRUE(expr.mayAccept(0, 50, 1lu << 56, 1lu << 56));
+  ASSERT_FALSE(expr.mayAccept(0, 50, 0, 10));
+  ASSERT_FALSE(Expression("app=1 & send=100-200").mayAccept(0, 50, 1lu << 56,
+                                                              1lu << 56));
+  ASSERT_TRUE(Expression("!app=1").mayAccept(0, 50, 0, 10));
+}
+
+TEST(Expression, errors) {
+  ASSERT_THROW(Expression(""), ex::Exception);
+  ASSERT_THROW(Expression("(app=0"), ex::Exception);
+  ASSERT_THROW(Expression("app=0)"), ex::Exception);
+  ASSERT_THROW(Expression("app=0 |"), ex::Exception);
+  ASSERT_THROW(Expression("app=0 pc=1"), ex::Exception);
+  ASSERT_THROW(Expression("app=0 & foo=1"), ex::Exception);
+  ASSERT_THROW(Filter("(app=0"), ex::Exception);
+}
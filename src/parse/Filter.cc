@@ -33,20 +33,32 @@
 #include <ex/Exception.h>
 #include <strop/strop.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <vector>
 
+#include "parse/Expression.h"
 #include "parse/util.h"
 
-Filter::Filter(const std::string& _description) : description_(_description) {
-  // parse the accept/reject flag
-  char accept = _description.at(0);
-  if (accept == '+') {
+Filter::Filter(const std::string& _description, Syntax _syntax)
+    : description_(_description), syntax_(_syntax) {
+  // parse the accept/reject flag, anything else starts an expression
+  char accept = _description.empty() ? '\0' : _description.at(0);
+  if (syntax_ == Syntax::AUTO && accept == '+') {
     accept_ = true;
-  } else if (accept == '-') {
+  } else if (syntax_ == Syntax::AUTO && accept == '-') {
     accept_ = false;
   } else {
-    throw ex::Exception("invalid accept/reject flag: %c", accept);
+    type_ = Filter::Type::EXPRESSION;
+    accept_ = true;
+    useFloats_ = false;
+    field_ = 0;
+    expression_ = std::make_shared<const Expression>(_description);
+    for (u32 level = 0; level < 3; level++) {
+      applies_[level] = expression_->applies((Level)level);
+    }
+    return;
   }
 
   // parse the type
@@ -56,57 +68,126 @@ Filter::Filter(const std::string& _description) : description_(_description) {
                         _description.c_str());
   }
   std::string type = strop::toLower(split.at(0).substr(1));
-  bool useFloats;
   if (type == "application" || type == "app") {
     type_ = Filter::Type::APPLICATION;
-    useFloats = false;
+    useFloats_ = false;
+  } else if (type == "transaction" || type == "trans") {
+    type_ = Filter::Type::TRANSACTION;
+    useFloats_ = false;
   } else if (type == "start" || type == "send") {
     type_ = Filter::Type::START;
-    useFloats = true;
+    useFloats_ = true;
   } else if (type == "end" || type == "recv") {
     type_ = Filter::Type::END;
-    useFloats = true;
+    useFloats_ = true;
   } else if (type == "protocolclass" || type == "pc") {
     type_ = Filter::Type::PROTOCOLCLASS;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "opcode" || type == "op") {
     type_ = Filter::Type::OPCODE;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "source" || type == "src") {
     type_ = Filter::Type::SOURCE;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "destination" || type == "dst") {
     type_ = Filter::Type::DESTINATION;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "hopcount" || type == "hc") {
     type_ = Filter::Type::HOPCOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "minhopcount" || type == "mhc") {
     type_ = Filter::Type::MINHOPCOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "nonminhopcount" || type == "nmhc") {
     type_ = Filter::Type::NONMINHOPCOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "messagecount" || type == "msgcnt") {
     type_ = Filter::Type::MESSAGECOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "packetcount" || type == "pktcnt") {
     type_ = Filter::Type::PACKETCOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else if (type == "flitcount" || type == "flitcnt") {
     type_ = Filter::Type::FLITCOUNT;
-    useFloats = false;
+    useFloats_ = false;
   } else {
     throw ex::Exception("invalid type field: %s", type.c_str());
   }
 
+  // the record field and the levels the filter applies to
+  bool transaction = true;
+  bool message = true;
+  bool packet = true;
+  switch (type_) {
+    case Filter::Type::APPLICATION:
+      field_ = APPLICATION_ID;
+      break;
+    case Filter::Type::TRANSACTION:
+      field_ = TRANSACTION_ID;
+      break;
+    case Filter::Type::START:
+      field_ = 0;
+      break;
+    case Filter::Type::END:
+      field_ = 1;
+      break;
+    case Filter::Type::PROTOCOLCLASS:
+      field_ = PROTOCOL_CLASS;
+      transaction = false;
+      break;
+    case Filter::Type::OPCODE:
+      field_ = OPCODE_ID;
+      transaction = false;
+      break;
+    case Filter::Type::SOURCE:
+      field_ = SOURCE_ID;
+      transaction = false;
+      break;
+    case Filter::Type::DESTINATION:
+      field_ = DESTINATION_ID;
+      transaction = false;
+      break;
+    case Filter::Type::HOPCOUNT:
+      field_ = HOP_COUNT;
+      transaction = false;
+      message = false;
+      break;
+    case Filter::Type::MINHOPCOUNT:
+      field_ = MIN_HOP_COUNT;
+      transaction = false;
+      break;
+    case Filter::Type::NONMINHOPCOUNT:
+      field_ = NON_MIN_HOP_COUNT;
+      transaction = false;
+      message = false;
+      break;
+    case Filter::Type::MESSAGECOUNT:
+      field_ = MESSAGE_COUNT;
+      message = false;
+      packet = false;
+      break;
+    case Filter::Type::PACKETCOUNT:
+      field_ = PACKET_COUNT;
+      packet = false;
+      break;
+    case Filter::Type::FLITCOUNT:
+      field_ = FLIT_COUNT;
+      break;
+    case Filter::Type::EXPRESSION:
+      assert(false);  // handled above
+      break;
+  }
+  applies_[(u32)Level::TRANSACTION] = transaction;
+  applies_[(u32)Level::MESSAGE] = message;
+  applies_[(u32)Level::PACKET] = packet;
+
   // parse the number specifier
   std::string allNumbers = split.at(1);
   std::vector<std::string> rangeStrs = strop::split(allNumbers, ',');
   for (const auto& rangeStr : rangeStrs) {
     std::vector<std::string> firstLast = strop::split(rangeStr, '-');
 
-    if (useFloats) {
+    if (useFloats_) {
       if (firstLast.size() != 2) {
         throw ex::Exception(
             "time based specifications must define a range. "
@@ -130,9 +211,6 @@ Filter::Filter(const std::string& _description) : description_(_description) {
       if (start > end) {
         throw ex::Exception("invalid range bounds: %f > %f", start, end);
       }
-      if (inFloatRange(start) || inFloatRange(end)) {
-        throw ex::Exception("overlapping range detected");
-      }
       floats_.push_back(std::make_pair(start, end));
     } else {
       if (firstLast.size() == 1) {
@@ -143,9 +221,7 @@ Filter::Filter(const std::string& _description) : description_(_description) {
           throw ex::Exception("invalid u64 number: %s",
                               firstLast.at(0).c_str());
         }
-        if (!ints_.insert(val).second) {
-          throw ex::Exception("duplicate numbers detected: %lu", val);
-        }
+        ints_.push_back(std::make_pair(val, val));
       } else if (firstLast.size() == 2) {
         u64 start, end;
         try {
@@ -163,159 +239,288 @@ Filter::Filter(const std::string& _description) : description_(_description) {
         if (start > end) {
           throw ex::Exception("invalid range bounds: %lu > %lu", start, end);
         }
-        for (u64 val = start; val <= end; val++) {
-          if (!ints_.insert(val).second) {
-            throw ex::Exception("duplicate numbers detected: %lu", val);
-          }
-        }
+        ints_.push_back(std::make_pair(start, end));
       } else {
         throw ex::Exception("invalid range spec: %s", rangeStr.c_str());
       }
     }
   }
+
+  // sort the ranges for binary searches
+  std::sort(floats_.begin(), floats_.end());
+  for (u64 idx = 1; idx < floats_.size(); idx++) {
+    if (floats_[idx].first < floats_[idx - 1].second) {
+      throw ex::Exception("overlapping range detected");
+    }
+  }
+  std::sort(ints_.begin(), ints_.end());
+  u64 last = 0;
+  for (u64 idx = 0; idx < ints_.size(); idx++) {
+    if (last > 0 && ints_[idx].first <= ints_[last - 1].second) {
+      throw ex::Exception("duplicate numbers detected: %lu", ints_[idx].first);
+    }
+    if (last > 0 && ints_[idx].first == ints_[last - 1].second + 1) {
+      ints_[last - 1].second = ints_[idx].second;  // adjacent
+    } else {
+      ints_[last++] = ints_[idx];
+    }
+  }
+  ints_.resize(last);
+
+  // small domains are looked up in a bitmap
+  if (!ints_.empty() && ints_.back().second < BITMAP_SIZE) {
+    bitmap_.resize(BITMAP_SIZE / 64, 0);
+    for (const std::pair<u64, u64>& range : ints_) {
+      for (u64 val = range.first; val <= range.second; val++) {
+        bitmap_[val / 64] |= (u64)1 << (val % 64);
+      }
+    }
+  }
 }
 
 Filter::~Filter() {}
 
-const std::string& Filter::description() const {
-  return description_;
+Filter::Columns::Columns(u32 _capacity)
+    : level(Level::TRANSACTION), capacity(_capacity), size(0) {
+  for (std::vector<f64>& times : this->times) {
+    times.resize(capacity);
+  }
+  for (std::vector<u64>& ints : this->ints) {
+    ints.resize(capacity);
+  }
 }
 
-bool Filter::transaction(u64 _transId, f64 _start, f64 _end, u32 _numMsgs,
-                         u32 _numPkts, u32 _numFlits) {
-  u32 appId = (u32)(_transId >> 56);
-
-  switch (type_) {
-    case Filter::Type::APPLICATION:
-      return accept_ == (ints_.count(appId) == 1);
-
-    case Filter::Type::START:
-      return accept_ == inFloatRange(_start);
-
-    case Filter::Type::END:
-      return accept_ == inFloatRange(_end);
-
-    case Filter::Type::MESSAGECOUNT:
-      return accept_ == (ints_.count(_numMsgs) == 1);
-
-    case Filter::Type::PACKETCOUNT:
-      return accept_ == (ints_.count(_numPkts) == 1);
-
-    case Filter::Type::FLITCOUNT:
-      return accept_ == (ints_.count(_numFlits) == 1);
+Filter::Columns::~Columns() {}
 
-    case Filter::Type::PROTOCOLCLASS:
-    case Filter::Type::OPCODE:
-    case Filter::Type::SOURCE:
-    case Filter::Type::DESTINATION:
-    case Filter::Type::HOPCOUNT:
-    case Filter::Type::MINHOPCOUNT:
-    case Filter::Type::NONMINHOPCOUNT:
-      return true;  // not applicable for transactions
-    default:
-      assert(false);
+bool Filter::Columns::add(const Record& _record) {
+  assert(size < capacity);
+  level = _record.level;
+  for (u32 field = 0; field < 2; field++) {
+    times[field][size] = _record.times[field];
+  }
+  for (u32 field = 0; field < NUM_FIELDS; field++) {
+    ints[field][size] = _record.ints[field];
   }
+  return ++size == capacity;
 }
 
-bool Filter::message(u32 _src, u32 _dst, u64 _transId, u32 _protocolClass,
-                     u32 _opcode, f64 _start, f64 _end, u32 _numPkts,
-                     u32 _numFlits, u32 _minHopCount) {
-  u32 appId = (u32)(_transId >> 56);
-
-  switch (type_) {
-    case Filter::Type::APPLICATION:
-      return accept_ == (ints_.count(appId) == 1);
+const std::string& Filter::description() const {
+  return description_;
+}
 
-    case Filter::Type::START:
-      return accept_ == inFloatRange(_start);
+Filter::Syntax Filter::syntax() const {
+  return syntax_;
+}
 
-    case Filter::Type::END:
-      return accept_ == inFloatRange(_end);
+void Filter::transactionRecord(u64 _transId, f64 _start, f64 _end,
+                               u32 _numMsgs, u32 _numPkts, u32 _numFlits,
+                               Record* _record) {
+  _record->level = Level::TRANSACTION;
+  _record->times[0] = _start;
+  _record->times[1] = _end;
+  _record->ints[APPLICATION_ID] = _transId >> 56;
+  _record->ints[TRANSACTION_ID] = _transId;
+  _record->ints[MESSAGE_COUNT] = _numMsgs;
+  _record->ints[PACKET_COUNT] = _numPkts;
+  _record->ints[FLIT_COUNT] = _numFlits;
+}
 
-    case Filter::Type::PROTOCOLCLASS:
-      return accept_ == (ints_.count(_protocolClass) == 1);
+void Filter::messageRecord(u32 _src, u32 _dst, u64 _transId,
+                           u32 _protocolClass, u32 _opcode, f64 _start,
+                           f64 _end, u32 _numPkts, u32 _numFlits,
+                           u32 _minHopCount, Record* _record) {
+  _record->level = Level::MESSAGE;
+  _record->times[0] = _start;
+  _record->times[1] = _end;
+  _record->ints[APPLICATION_ID] = _transId >> 56;
+  _record->ints[TRANSACTION_ID] = _transId;
+  _record->ints[PROTOCOL_CLASS] = _protocolClass;
+  _record->ints[OPCODE_ID] = _opcode;
+  _record->ints[SOURCE_ID] = _src;
+  _record->ints[DESTINATION_ID] = _dst;
+  _record->ints[PACKET_COUNT] = _numPkts;
+  _record->ints[FLIT_COUNT] = _numFlits;
+  _record->ints[MIN_HOP_COUNT] = _minHopCount;
+}
 
-    case Filter::Type::OPCODE:
-      return accept_ == (ints_.count(_opcode) == 1);
+void Filter::packetRecord(u32 _src, u32 _dst, u64 _transId,
+                          u32 _protocolClass, u32 _opcode, f64 _start,
+                          f64 _end, u32 _numFlits, u32 _hopCount,
+                          u32 _minHopCount, u32 _nonMinHopCount,
+                          Record* _record) {
+  _record->level = Level::PACKET;
+  _record->times[0] = _start;
+  _record->times[1] = _end;
+  _record->ints[APPLICATION_ID] = _transId >> 56;
+  _record->ints[TRANSACTION_ID] = _transId;
+  _record->ints[PROTOCOL_CLASS] = _protocolClass;
+  _record->ints[OPCODE_ID] = _opcode;
+  _record->ints[SOURCE_ID] = _src;
+  _record->ints[DESTINATION_ID] = _dst;
+  _record->ints[FLIT_COUNT] = _numFlits;
+  _record->ints[HOP_COUNT] = _hopCount;
+  _record->ints[MIN_HOP_COUNT] = _minHopCount;
+  _record->ints[NON_MIN_HOP_COUNT] = _nonMinHopCount;
+}
 
-    case Filter::Type::SOURCE:
-      return accept_ == (ints_.count(_src) == 1);
+bool Filter::applies(Level _level) const {
+  return applies_[(u32)_level];
+}
 
-    case Filter::Type::DESTINATION:
-      return accept_ == (ints_.count(_dst) == 1);
+bool Filter::accept(const Record& _record) const {
+  if (expression_) {
+    return expression_->accept(_record);
+  }
+  if (useFloats_) {
+    return accept_ == inFloatRange(_record.times[field_]);
+  }
+  return accept_ == inIntRange(_record.ints[field_]);
+}
 
-    case Filter::Type::PACKETCOUNT:
-      return accept_ == (ints_.count(_numPkts) == 1);
+void Filter::accept(const Columns& _columns, u8* _accepted) const {
+  if (expression_) {
+    expression_->accept(_columns, _accepted);
+    return;
+  }
 
-    case Filter::Type::FLITCOUNT:
-      return accept_ == (ints_.count(_numFlits) == 1);
+  // single ranges and bitmaps are evaluated without branches
+  u32 rows = _columns.size;
+  u8 reject = accept_ ? 0 : 1;
+  if (useFloats_) {
+    const f64* values = _columns.times[field_].data();
+    if (floats_.size() == 1) {
+      f64 first = floats_[0].first;
+      f64 last = floats_[0].second;
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] =
+            (u8)((values[row] >= first) & (values[row] < last)) ^ reject;
+      }
+    } else {
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] = (u8)inFloatRange(values[row]) ^ reject;
+      }
+    }
+  } else {
+    const u64* values = _columns.ints[field_].data();
+    if (!bitmap_.empty()) {
+      const u64* bitmap = bitmap_.data();
+      for (u32 row = 0; row < rows; row++) {
+        u64 small = values[row] < BITMAP_SIZE;
+        u64 value = small ? values[row] : 0;
+        _accepted[row] =
+            (u8)(small & (bitmap[value / 64] >> (value % 64))) ^ reject;
+      }
+    } else if (ints_.size() == 1) {
+      u64 first = ints_[0].first;
+      u64 span = ints_[0].second - ints_[0].first;
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] = (u8)(values[row] - first <= span) ^ reject;
+      }
+    } else {
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] = (u8)inIntRange(values[row]) ^ reject;
+      }
+    }
+  }
+}
 
-    case Filter::Type::MINHOPCOUNT:
-      return accept_ == (ints_.count(_minHopCount) == 1);
+f64 Filter::cost() const {
+  if (expression_) {
+    return expression_->cost();
+  }
+  // a bitmap probe or a binary search
+  u64 ranges = useFloats_ ? floats_.size() : ints_.size();
+  if (!bitmap_.empty() || ranges <= 1) {
+    return 1.0;
+  }
+  return 1.0 + std::log2((f64)ranges);
+}
 
-    case Filter::Type::HOPCOUNT:
-    case Filter::Type::NONMINHOPCOUNT:
-    case Filter::Type::MESSAGECOUNT:
-      return true;  // not applicable for messages
+bool Filter::transaction(u64 _transId, f64 _start, f64 _end, u32 _numMsgs,
+                         u32 _numPkts, u32 _numFlits) {
+  Record record;
+  transactionRecord(_transId, _start, _end, _numMsgs, _numPkts, _numFlits,
+                    &record);
+  return !applies(Level::TRANSACTION) || accept(record);
+}
 
-    default:
-      assert(false);
-  }
+bool Filter::message(u32 _src, u32 _dst, u64 _transId, u32 _protocolClass,
+                     u32 _opcode, f64 _start, f64 _end, u32 _numPkts,
+                     u32 _numFlits, u32 _minHopCount) {
+  Record record;
+  messageRecord(_src, _dst, _transId, _protocolClass, _opcode, _start, _end,
+                _numPkts, _numFlits, _minHopCount, &record);
+  return !applies(Level::MESSAGE) || accept(record);
 }
 
 bool Filter::packet(u32 _src, u32 _dst, u64 _transId, u32 _protocolClass,
                     u32 _opcode, f64 _start, f64 _end, u32 _numFlits,
                     u32 _hopCount, u32 _minHopCount, u32 _nonMinHopCount) {
-  u32 appId = (u32)(_transId >> 56);
+  Record record;
+  packetRecord(_src, _dst, _transId, _protocolClass, _opcode, _start, _end,
+               _numFlits, _hopCount, _minHopCount, _nonMinHopCount, &record);
+  return !applies(Level::PACKET) || accept(record);
+}
 
+bool Filter::mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                       u64 _maxTransId) const {
   switch (type_) {
-    case Filter::Type::APPLICATION:
-      return accept_ == (ints_.count(appId) == 1);
+    case Filter::Type::EXPRESSION:
+      return expression_->mayAccept(_minTime, _maxTime, _minTransId,
+                                    _maxTransId);
 
     case Filter::Type::START:
-      return accept_ == inFloatRange(_start);
-
     case Filter::Type::END:
-      return accept_ == inFloatRange(_end);
-
-    case Filter::Type::PROTOCOLCLASS:
-      return accept_ == (ints_.count(_protocolClass) == 1);
-
-    case Filter::Type::OPCODE:
-      return accept_ == (ints_.count(_opcode) == 1);
-
-    case Filter::Type::SOURCE:
-      return accept_ == (ints_.count(_src) == 1);
-
-    case Filter::Type::DESTINATION:
-      return accept_ == (ints_.count(_dst) == 1);
-
-    case Filter::Type::FLITCOUNT:
-      return accept_ == (ints_.count(_numFlits) == 1);
-
-    case Filter::Type::HOPCOUNT:
-      return accept_ == (ints_.count(_hopCount) == 1);
+      for (const std::pair<f64, f64>& range : floats_) {
+        if (accept_ && range.first <= _maxTime && range.second > _minTime) {
+          return true;  // the range overlaps
+        }
+        if (!accept_ && range.first <= _minTime && range.second > _maxTime) {
+          return false;  // the range covers everything
+        }
+      }
+      return !accept_;
 
-    case Filter::Type::MINHOPCOUNT:
-      return accept_ == (ints_.count(_minHopCount) == 1);
+    case Filter::Type::APPLICATION:
+      return !accept_ || overlapsIntRange(_minTransId >> 56, _maxTransId >> 56);
 
-    case Filter::Type::NONMINHOPCOUNT:
-      return accept_ == (ints_.count(_nonMinHopCount) == 1);
-
-    case Filter::Type::MESSAGECOUNT:
-    case Filter::Type::PACKETCOUNT:
-      return true;  // not applicable for messages
+    case Filter::Type::TRANSACTION:
+      return !accept_ || overlapsIntRange(_minTransId, _maxTransId);
 
     default:
-      assert(false);
+      return true;  // not known ahead of time
   }
 }
 
-bool Filter::inFloatRange(f64 _val) const {
-  for (const std::pair<f64, f64>& range : floats_) {
-    if (_val >= range.first && _val < range.second) {
-      return true;
-    }
+bool Filter::inIntRange(u64 _val) const {
+  if (!bitmap_.empty()) {
+    return _val < BITMAP_SIZE && ((bitmap_[_val / 64] >> (_val % 64)) & 1);
   }
-  return false;
+  // the last range starting at or before the value
+  auto it = std::upper_bound(
+      ints_.begin(), ints_.end(), _val,
+      [](u64 _v, const std::pair<u64, u64>& _range) {
+        return _v < _range.first;
+      });
+  return it != ints_.begin() && _val <= (it - 1)->second;
+}
+
+bool Filter::overlapsIntRange(u64 _first, u64 _last) const {
+  // the first range ending at or after the first value
+  auto it = std::lower_bound(
+      ints_.begin(), ints_.end(), _first,
+      [](const std::pair<u64, u64>& _range, u64 _v) {
+        return _range.second < _v;
+      });
+  return it != ints_.end() && it->first <= _last;
+}
+
+bool Filter::inFloatRange(f64 _val) const {
+  // the last range starting at or before the value
+  auto it = std::upper_bound(
+      floats_.begin(), floats_.end(), _val,
+      [](f64 _v, const std::pair<f64, f64>& _range) {
+        return _v < _range.first;
+      });
+  return it != floats_.begin() && _val < (it - 1)->second;
 }
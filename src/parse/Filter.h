@@ -33,17 +33,96 @@
 
 #include <prim/prim.h>
 
+#include <memory>
 #include <string>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
+class Expression;
+
+// A filter is either a single '+type=spec' or '-type=spec' term or a boolean
+// expression of terms, see Expression.
 class Filter {
  public:
-  explicit Filter(const std::string& _description);
+  // the kinds of records filters are evaluated against
+  enum class Level { TRANSACTION, MESSAGE, PACKET };
+
+  // the integer fields of a record
+  enum Field : u32 {
+    APPLICATION_ID,
+    TRANSACTION_ID,
+    PROTOCOL_CLASS,
+    OPCODE_ID,
+    SOURCE_ID,
+    DESTINATION_ID,
+    MESSAGE_COUNT,
+    PACKET_COUNT,
+    FLIT_COUNT,
+    HOP_COUNT,
+    MIN_HOP_COUNT,
+    NON_MIN_HOP_COUNT,
+    NUM_FIELDS
+  };
+
+  // the values of a record, only the fields of its level are set
+  struct Record {
+    Level level;
+    f64 times[2];  // start, end
+    u64 ints[NUM_FIELDS];
+  };
+
+  // a batch of records stored field by field
+  struct Columns {
+    explicit Columns(u32 _capacity);
+    ~Columns();
+
+    // appends a record, returns true if the batch is full
+    bool add(const Record& _record);
+
+    Level level;
+    u32 capacity;
+    u32 size;
+    std::vector<f64> times[2];          // [field][row]
+    std::vector<u64> ints[NUM_FIELDS];  // [field][row]
+  };
+
+  // how a description is parsed, AUTO takes descriptions starting with '+' or
+  // '-' as single terms and anything else as an expression
+  enum class Syntax { AUTO, EXPRESSION };
+
+  explicit Filter(const std::string& _description,
+                  Syntax _syntax = Syntax::AUTO);
   ~Filter();
 
   const std::string& description() const;
+  Syntax syntax() const;
+
+  // fills in the fields of a record of each level
+  static void transactionRecord(u64 _transId, f64 _start, f64 _end,
+                                u32 _numMsgs, u32 _numPkts, u32 _numFlits,
+                                Record* _record);
+  static void messageRecord(u32 _src, u32 _dst, u64 _transId,
+                            u32 _protocolClass, u32 _opcode, f64 _start,
+                            f64 _end, u32 _numPkts, u32 _numFlits,
+                            u32 _minHopCount, Record* _record);
+  static void packetRecord(u32 _src, u32 _dst, u64 _transId,
+                           u32 _protocolClass, u32 _opcode, f64 _start,
+                           f64 _end, u32 _numFlits, u32 _hopCount,
+                           u32 _minHopCount, u32 _nonMinHopCount,
+                           Record* _record);
+
+  // returns false if the filter accepts all records of the level
+  bool applies(Level _level) const;
+
+  // evaluates a record of a level the filter applies to
+  bool accept(const Record& _record) const;
+
+  // evaluates each row of a batch of a level the filter applies to, sets
+  // _accepted[row] to 1 or 0
+  void accept(const Columns& _columns, u8* _accepted) const;
+
+  // the relative cost of accept()
+  f64 cost() const;
 
   bool transaction(u64 _transId, f64 _start, f64 _end, u32 _numMsgs,
                    u32 _numPkts, u32 _numFlits);
@@ -56,9 +135,15 @@ class Filter {
               f64 _start, f64 _end, u32 _numFlits, u32 _hopCount,
               u32 _minHopCount, u32 _nonMinHopCount);
 
+  // returns false if no record with times in [_minTime, _maxTime] and
+  // transaction ids in [_minTransId, _maxTransId] can be accepted
+  bool mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                 u64 _maxTransId) const;
+
  private:
   enum class Type {
     APPLICATION,
+    TRANSACTION,
     START,
     END,
     PROTOCOLCLASS,
@@ -70,16 +155,28 @@ class Filter {
     NONMINHOPCOUNT,
     MESSAGECOUNT,
     PACKETCOUNT,
-    FLITCOUNT
+    FLITCOUNT,
+    EXPRESSION
   };
 
+  // filters with all values below this are looked up in a bitmap
+  static const u64 BITMAP_SIZE = 1 << 16;
+
+  bool inIntRange(u64 _val) const;
+  bool overlapsIntRange(u64 _first, u64 _last) const;
   bool inFloatRange(f64 _val) const;
 
   std::string description_;
+  Syntax syntax_;
   Type type_;
   bool accept_;
-  std::unordered_set<u64> ints_;
-  std::vector<std::pair<f64, f64> > floats_;
+  bool useFloats_;
+  u32 field_;        // index into the times or ints of a record
+  bool applies_[3];  // [level]
+  std::vector<std::pair<u64, u64> > ints_;    // sorted disjoint [first,last]
+  std::vector<u64> bitmap_;                   // empty unless small
+  std::vector<std::pair<f64, f64> > floats_;  // sorted disjoint [first,last)
+  std::shared_ptr<const Expression> expression_;
 };
 
 #endif  // PARSE_FILTER_H_
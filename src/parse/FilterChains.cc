@@ -0,0 +1,248 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/FilterChains.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+
+static const char* LEVEL_NAMES[] = {"transaction", "message", "packet"};
+
+FilterChains::FilterChains(
+    const std::vector<std::vector<std::string> >& _chains,
+    const std::vector<std::vector<std::string> >& _expressions) {
+  if (_chains.empty() || _chains.size() > MAX_CHAINS) {
+    throw ex::Exception("The number of queries must be 1-%u\n", MAX_CHAINS);
+  }
+  all_ = (_chains.size() == 64) ? U64_MAX : (((u64)1 << _chains.size()) - 1);
+
+  // chains refer to the distinct filters by index
+  std::vector<Filter> filters;
+  for (u32 chain = 0; chain < _chains.size(); chain++) {
+    std::vector<std::pair<std::string, Filter::Syntax> > descriptions;
+    for (const std::string& description : _chains[chain]) {
+      descriptions.emplace_back(description, Filter::Syntax::AUTO);
+    }
+    if (chain < _expressions.size()) {
+      for (const std::string& expression : _expressions[chain]) {
+        descriptions.emplace_back(expression, Filter::Syntax::EXPRESSION);
+      }
+    }
+    definitions_.emplace_back();
+    for (const auto& description : descriptions) {
+      u32 index = 0;
+      while (index < filters.size() &&
+             (filters[index].description() != description.first ||
+              filters[index].syntax() != description.second)) {
+        index++;
+      }
+      if (index == filters.size()) {
+        if (filters.size() == MAX_FILTERS) {
+          throw ex::Exception("Too many distinct filters, the limit is %u\n",
+                              MAX_FILTERS);
+        }
+        filters.emplace_back(description.first, description.second);
+      }
+      definitions_.back().push_back(index);
+    }
+  }
+
+  // each level only holds the filters that apply to it
+  for (u32 level = 0; level < 3; level++) {
+    for (const std::vector<u32>& definition : definitions_) {
+      chains_[level].emplace_back();
+      for (u32 filter : definition) {
+        if (filters[filter].applies((Filter::Level)level)) {
+          chains_[level].back().push_back(filter);
+        }
+      }
+    }
+    stats_[level].resize(filters.size());
+  }
+  filters_ = std::make_shared<const std::vector<Filter> >(std::move(filters));
+  clearStats();
+}
+
+FilterChains::~FilterChains() {}
+
+u32 FilterChains::size() const {
+  return definitions_.size();
+}
+
+u64 FilterChains::evaluate(Filter::Level _level,
+                           const Filter::Record& _record) {
+  u32 level = (u32)_level;
+  const std::vector<std::vector<u32> >& chains = chains_[level];
+  const Filter* filters = filters_->data();
+  Stats* stats = stats_[level].data();
+
+  u64 evaluated = 0;
+  u64 passed = 0;
+  u64 accepted = all_;
+  for (u32 chain = 0; chain < chains.size(); chain++) {
+    for (u32 filter : chains[chain]) {
+      u64 bit = (u64)1 << filter;
+      if ((evaluated & bit) == 0) {
+        evaluated |= bit;
+        stats[filter].evaluations++;
+        if (filters[filter].accept(_record)) {
+          passed |= bit;
+        } else {
+          stats[filter].rejections++;
+        }
+      }
+      if ((passed & bit) == 0) {
+        accepted &= ~((u64)1 << chain);
+        break;
+      }
+    }
+  }
+
+  if (++sinceReorder_[level] == REORDER_PERIOD) {
+    reorder(level);
+  }
+  return accepted;
+}
+
+void FilterChains::evaluate(Filter::Level _level,
+                            const Filter::Columns& _columns, u64* _accepted) {
+  u32 level = (u32)_level;
+  const std::vector<std::vector<u32> >& chains = chains_[level];
+  const Filter* filters = filters_->data();
+  Stats* stats = stats_[level].data();
+  u32 rows = _columns.size;
+  std::fill(_accepted, _accepted + rows, all_);
+  if (rows == 0) {
+    return;
+  }
+  passed_.resize((u64)filters_->size() * rows);
+
+  u64 evaluated = 0;
+  for (u32 chain = 0; chain < chains.size(); chain++) {
+    for (u32 filter : chains[chain]) {
+      u8* passed = passed_.data() + (u64)filter * rows;
+      u64 bit = (u64)1 << filter;
+      if ((evaluated & bit) == 0) {
+        evaluated |= bit;
+        filters[filter].accept(_columns, passed);
+        u64 count = 0;
+        for (u32 row = 0; row < rows; row++) {
+          count += passed[row];
+        }
+        stats[filter].evaluations += rows;
+        stats[filter].rejections += rows - count;
+      }
+      u64 remaining = 0;
+      for (u32 row = 0; row < rows; row++) {
+        _accepted[row] &= ~((u64)(passed[row] ^ 1) << chain);
+        remaining += (_accepted[row] >> chain) & 1;
+      }
+      if (remaining == 0) {
+        break;
+      }
+    }
+  }
+
+  sinceReorder_[level] += rows;
+  if (sinceReorder_[level] >= REORDER_PERIOD) {
+    reorder(level);
+  }
+}
+
+bool FilterChains::mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                             u64 _maxTransId) const {
+  for (const std::vector<u32>& definition : definitions_) {
+    bool accept = true;
+    for (u32 filter : definition) {
+      if (!(*filters_)[filter].mayAccept(_minTime, _maxTime, _minTransId,
+                                         _maxTransId)) {
+        accept = false;
+        break;
+      }
+    }
+    if (accept) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FilterChains::clearStats() {
+  for (u32 level = 0; level < 3; level++) {
+    std::fill(stats_[level].begin(), stats_[level].end(), Stats{0, 0});
+    sinceReorder_[level] = 0;
+  }
+}
+
+void FilterChains::mergeStats(const FilterChains& _other) {
+  for (u32 level = 0; level < 3; level++) {
+    for (u32 filter = 0; filter < stats_[level].size(); filter++) {
+      stats_[level][filter].evaluations +=
+          _other.stats_[level][filter].evaluations;
+      stats_[level][filter].rejections +=
+          _other.stats_[level][filter].rejections;
+    }
+    reorder(level);
+  }
+}
+
+std::string FilterChains::statsTable() const {
+  std::string table = "Level,Filter,Evaluations,Rejections\n";
+  for (u32 level = 0; level < 3; level++) {
+    for (u32 filter = 0; filter < filters_->size(); filter++) {
+      if ((*filters_)[filter].applies((Filter::Level)level)) {
+        const Stats& stats = stats_[level][filter];
+        table += std::string(LEVEL_NAMES[level]) + ",\"" +
+                 (*filters_)[filter].description() + "\"," +
+                 std::to_string(stats.evaluations) + "," +
+                 std::to_string(stats.rejections) + "\n";
+      }
+    }
+  }
+  return table;
+}
+
+void FilterChains::reorder(u32 _level) {
+  // filters that reject the most per unit of cost go first, the counts are
+  // smoothed so unused filters keep their place
+  std::vector<f64> rank(filters_->size());
+  for (u32 filter = 0; filter < rank.size(); filter++) {
+    const Stats& stats = stats_[_level][filter];
+    rank[filter] = (stats.rejections + 1.0) / (stats.evaluations + 2.0) /
+                   (*filters_)[filter].cost();
+  }
+  for (std::vector<u32>& chain : chains_[_level]) {
+    std::stable_sort(chain.begin(), chain.end(), [&](u32 _a, u32 _b) {
+      return rank[_a] > rank[_b];
+    });
+  }
+  sinceReorder_[_level] = 0;
+}
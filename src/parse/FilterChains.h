@@ -0,0 +1,101 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_FILTERCHAINS_H_
+#define PARSE_FILTERCHAINS_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parse/Filter.h"
+
+// This class evaluates several filter chains against each record. A chain
+// accepts a record if all of its filters do. The chains are compiled into one
+// list per level holding only the filters that apply to that level. Filters
+// shared by several chains are evaluated once per record and each chain stops
+// at its first rejecting filter, or for batches at the first filter rejecting
+// the whole batch. The filters of each chain are periodically
+// reordered so the most selective and cheapest ones run first.
+class FilterChains {
+ public:
+  static const u32 MAX_CHAINS = 64;
+  static const u32 MAX_FILTERS = 64;
+
+  // evaluations of a level between reorderings of its chains
+  static const u64 REORDER_PERIOD = 1 << 12;
+
+  // the expressions of a chain are always parsed as expressions and follow
+  // its filters
+  explicit FilterChains(
+      const std::vector<std::vector<std::string> >& _chains,
+      const std::vector<std::vector<std::string> >& _expressions = {});
+  ~FilterChains();
+
+  u32 size() const;
+
+  // returns a bitmask of the chains accepting the record
+  u64 evaluate(Filter::Level _level, const Filter::Record& _record);
+
+  // sets _accepted[row] to the bitmask of the chains accepting each row of
+  // the batch, each filter is evaluated over the whole batch at once
+  void evaluate(Filter::Level _level, const Filter::Columns& _columns,
+                u64* _accepted);
+
+  // returns false if no chain accepts a record with times in
+  // [_minTime, _maxTime] and transaction ids in [_minTransId, _maxTransId]
+  bool mayAccept(f64 _minTime, f64 _maxTime, u64 _minTransId,
+                 u64 _maxTransId) const;
+
+  // the evaluation and rejection counts of each filter
+  void clearStats();
+  void mergeStats(const FilterChains& _other);
+  std::string statsTable() const;
+
+ private:
+  struct Stats {
+    u64 evaluations;
+    u64 rejections;
+  };
+
+  void reorder(u32 _level);
+
+  std::shared_ptr<const std::vector<Filter> > filters_;  // distinct filters
+  std::vector<std::vector<u32> > definitions_;  // [chain] -> filters_ index
+  std::vector<std::vector<u32> > chains_[3];    // [level][chain] -> index
+  std::vector<Stats> stats_[3];                 // [level][filter]
+  u64 sinceReorder_[3];
+  u64 all_;  // mask of all chains
+  std::vector<u8> passed_;  // [filter][row] of the last batch
+};
+
+#endif  // PARSE_FILTERCHAINS_H_
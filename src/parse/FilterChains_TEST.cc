@@ -0,0 +1,178 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/FilterChains.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static Filter::Record message(u32 _pc, u64 _transId) {
+  Filter::Record record;
+  Filter::messageRecord(0, 0, _transId, _pc, 0, 0, 0, 0, 0, 0, &record);
+  return record;
+}
+
+// the counts of the stats table by level and filter
+static std::map<std::string, std::string> stats(const FilterChains& _chains) {
+  std::map<std::string, std::string> counts;
+  std::istringstream table(_chains.statsTable());
+  std::string line;
+  std::getline(table, line);
+  EXPECT_EQ(line, "Level,Filter,Evaluations,Rejections");
+  while (std::getline(table, line)) {
+    size_t split = line.rfind(',', line.rfind(',') - 1);
+    counts[line.substr(0, split)] = line.substr(split + 1);
+  }
+  return counts;
+}
+
+TEST(FilterChains, evaluate) {
+  FilterChains chains({{"+pc=0", "+app=1"}, {}, {"+app=1"}, {"-pc=0"}});
+  ASSERT_EQ(chains.size(), 4u);
+  const Filter::Level MESSAGE = Filter::Level::MESSAGE;
+
+  // each distinct filter is evaluated once
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(0, 1lu << 56)), 0x7u);
+  std::map<std::string, std::string> counts = stats(chains);
+  ASSERT_EQ(counts.at("message,\"+pc=0\""), "1,0");
+  ASSERT_EQ(counts.at("message,\"+app=1\""), "1,0");
+  ASSERT_EQ(counts.at("message,\"-pc=0\""), "1,1");
+  ASSERT_EQ(counts.at("transaction,\"+app=1\""), "0,0");
+  ASSERT_EQ(counts.count("transaction,\"+pc=0\""), 0u);
+
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(0, 2lu << 56)), 0x2u);
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(1, 1lu << 56)), 0xeu);
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(1, 2lu << 56)), 0xau);
+
+  // protocol classes don't apply to transactions
+  Filter::Record record;
+  Filter::transactionRecord(1lu << 56, 0, 0, 0, 0, 0, &record);
+  ASSERT_EQ(chains.evaluate(Filter::Level::TRANSACTION, record), 0xfu);
+
+  chains.clearStats();
+  ASSERT_EQ(stats(chains).at("message,\"+pc=0\""), "0,0");
+}
+
+TEST(FilterChains, expressions) {
+  // expressions are never taken for single terms, even when they look alike
+  FilterChains chains({{"+pc=0"}, {}}, {{}, {"+pc=0", "+pc=1 | +app=1"}});
+  const Filter::Level MESSAGE = Filter::Level::MESSAGE;
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(0, 1lu << 56)), 0x3u);
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(0, 2lu << 56)), 0x1u);
+  ASSERT_EQ(chains.evaluate(MESSAGE, message(1, 2lu << 56)), 0x0u);
+}
+
+TEST(FilterChains, reorder) {
+  std::vector<std::vector<std::string> > definitions = {{"+pc=0-9", "+app=1"}};
+  FilterChains chains(definitions);
+  const Filter::Level MESSAGE = Filter::Level::MESSAGE;
+  for (u64 idx = 0; idx < FilterChains::REORDER_PERIOD * 2; idx++) {
+    ASSERT_EQ(chains.evaluate(MESSAGE, message(idx % 10, 0)), 0u);
+  }
+
+  // the rejecting filter runs first after the first period
+  std::map<std::string, std::string> counts = stats(chains);
+  std::string period = std::to_string(FilterChains::REORDER_PERIOD);
+  std::string twice = std::to_string(FilterChains::REORDER_PERIOD * 2);
+  ASSERT_EQ(counts.at("message,\"+pc=0-9\""), period + ",0");
+  ASSERT_EQ(counts.at("message,\"+app=1\""), twice + "," + twice);
+
+  // copies keep the order, merges add the counts
+  FilterChains copy = chains;
+  copy.clearStats();
+  copy.evaluate(MESSAGE, message(0, 1lu << 56));
+  ASSERT_EQ(stats(copy).at("message,\"+pc=0-9\""), "1,0");
+  ASSERT_EQ(stats(copy).at("message,\"+app=1\""), "1,0");
+  copy.evaluate(MESSAGE, message(0, 0));
+  ASSERT_EQ(stats(copy).at("message,\"+pc=0-9\""), "1,0");
+  chains.mergeStats(copy);
+  ASSERT_EQ(stats(chains).at("message,\"+app=1\""),
+            std::to_string(FilterChains::REORDER_PERIOD * 2 + 2) + "," +
+                std::to_string(FilterChains::REORDER_PERIOD * 2 + 1));
+}
+
+TEST(FilterChains, columns) {
+  std::vector<std::vector<std::string> > definitions = {
+      {"+pc=0", "+app=1"}, {}, {"+app=1"}, {"-pc=0"}, {"+pc=2", "+app=3"}};
+  FilterChains rows(definitions);
+  FilterChains batch(definitions);
+  const Filter::Level MESSAGE = Filter::Level::MESSAGE;
+
+  // a batch matches the records one at a time
+  Filter::Columns columns(16);
+  std::vector<u64> expected;
+  for (u32 row = 0; row < 16; row++) {
+    Filter::Record record = message(row % 2, (u64)(row % 4) << 56);
+    expected.push_back(rows.evaluate(MESSAGE, record));
+    columns.add(record);
+  }
+  std::vector<u64> accepted(columns.size);
+  batch.evaluate(MESSAGE, columns, accepted.data());
+  ASSERT_EQ(accepted, expected);
+
+  // every row is evaluated, chains stop when the whole batch is rejected
+  std::map<std::string, std::string> counts = stats(batch);
+  ASSERT_EQ(counts.at("message,\"+pc=0\""), "16,8");
+  ASSERT_EQ(counts.at("message,\"+app=1\""), "16,12");
+  ASSERT_EQ(counts.at("message,\"+pc=2\""), "16,16");
+  ASSERT_EQ(counts.at("message,\"+app=3\""), "0,0");
+
+  // empty batches
+  columns.size = 0;
+  batch.evaluate(MESSAGE, columns, accepted.data());
+  ASSERT_EQ(stats(batch).at("message,\"+pc=0\""), "16,8");
+}
+
+TEST(FilterChains, mayAccept) {
+  FilterChains one({{"+send=100-200"}});
+  ASSERT_TRUE(one.mayAccept(150, 300, 0, 10));
+  ASSERT_FALSE(one.mayAccept(200, 300, 0, 10));
+
+  FilterChains two({{"+send=100-200"}, {"+trans=5"}});
+  ASSERT_TRUE(two.mayAccept(200, 300, 0, 10));
+  ASSERT_FALSE(two.mayAccept(200, 300, 6, 10));
+}
+
+TEST(FilterChains, limits) {
+  ASSERT_THROW(FilterChains({}), ex::Exception);
+  std::vector<std::vector<std::string> > chains(64);
+  FilterChains full(chains);
+  Filter::Record record;
+  Filter::packetRecord(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, &record);
+  ASSERT_EQ(full.evaluate(Filter::Level::PACKET, record), U64_MAX);
+  chains.emplace_back();
+  ASSERT_THROW(FilterChains{chains}, ex::Exception);
+}
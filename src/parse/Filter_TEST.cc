@@ -30,9 +30,13 @@
  */
 #include "parse/Filter.h"
 
+#include <ex/Exception.h>
 #include <gtest/gtest.h>
 #include <prim/prim.h>
 
+#include <string>
+#include <vector>
+
 TEST(Filter, plusApplication) {
   std::string desc = "+application=0-9,10-18,100-250";
   Filter filter(desc);
@@ -851,3 +855,131 @@ TEST(Filter, minusFlitCount) {
   ASSERT_FALSE(filter.packet(0, 0, 0, 0, 0, 0, 0, 100lu, 0, 0, 0));
   ASSERT_TRUE(filter.packet(0, 0, 0, 0, 0, 0, 0, 99lu, 0, 0, 0));
 }
+
+TEST(Filter, plusTransaction) {
+  std::string desc = "+trans=5,100-102";
+  Filter filter(desc);
+  ASSERT_EQ(desc, filter.description());
+
+  ASSERT_TRUE(filter.transaction(5, 0, 0, 0, 0, 0));
+  ASSERT_FALSE(filter.transaction(6, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(filter.message(0, 0, 101, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_FALSE(filter.message(0, 0, 103, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(filter.packet(0, 0, 102, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_FALSE(filter.packet(0, 0, 99, 0, 0, 0, 0, 0, 0, 0, 0));
+
+  ASSERT_TRUE(filter.mayAccept(0, 0, 0, 5));
+  ASSERT_TRUE(filter.mayAccept(0, 0, 102, 200));
+  ASSERT_FALSE(filter.mayAccept(0, 0, 6, 99));
+  ASSERT_FALSE(filter.mayAccept(0, 0, 103, 200));
+}
+
+TEST(Filter, mayAccept) {
+  Filter plusSend("+send=10-20,30-40");
+  ASSERT_TRUE(plusSend.mayAccept(0, 10, 0, U64_MAX));
+  ASSERT_TRUE(plusSend.mayAccept(25, 35, 0, U64_MAX));
+  ASSERT_FALSE(plusSend.mayAccept(20, 29.9, 0, U64_MAX));
+  ASSERT_FALSE(plusSend.mayAccept(41, 50, 0, U64_MAX));
+
+  Filter minusRecv("-recv=10-20");
+  ASSERT_FALSE(minusRecv.mayAccept(10, 19.9, 0, U64_MAX));
+  ASSERT_TRUE(minusRecv.mayAccept(10, 20, 0, U64_MAX));
+  ASSERT_TRUE(minusRecv.mayAccept(0, 5, 0, U64_MAX));
+
+  Filter plusApp("+app=2");
+  ASSERT_TRUE(plusApp.mayAccept(0, 0, 1lu << 56, 3lu << 56));
+  ASSERT_FALSE(plusApp.mayAccept(0, 0, 0, (2lu << 56) - 1));
+  ASSERT_TRUE(Filter("-app=2").mayAccept(0, 0, 2lu << 56, 2lu << 56));
+
+  ASSERT_TRUE(Filter("+pc=1").mayAccept(0, 0, 0, 0));
+}
+
+TEST(Filter, ranges) {
+  // large ranges aren't expanded
+  Filter src("+src=0-1048575,2000000");
+  ASSERT_TRUE(src.packet(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(src.packet(1048575, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_FALSE(src.packet(1048576, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(src.packet(2000000, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_FALSE(src.packet(2000001, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+  ASSERT_TRUE(Filter("+trans=0-18446744073709551615")
+                  .transaction(U64_MAX, 0, 0, 0, 0, 0));
+
+  // out of order and adjacent ranges
+  Filter pc("-pc=7,3-4,5");
+  for (u32 val = 0; val < 10; val++) {
+    bool in = (val >= 3 && val <= 5) || val == 7;
+    ASSERT_EQ(pc.message(0, 0, 0, val, 0, 0, 0, 0, 0, 0), !in) << val;
+  }
+  ASSERT_TRUE(pc.message(0, 0, 0, 1 << 20, 0, 0, 0, 0, 0, 0));
+
+  // many time windows
+  std::string desc = "+send=";
+  for (u32 idx = 100; idx > 0; idx--) {
+    desc += std::to_string(idx * 10) + "-" + std::to_string(idx * 10 + 5) +
+            (idx > 1 ? "," : "");
+  }
+  Filter send(desc);
+  for (u32 idx = 0; idx < 1020; idx++) {
+    bool in = idx >= 10 && idx < 1005 && idx % 10 < 5;
+    ASSERT_EQ(send.packet(0, 0, 0, 0, 0, idx, 0, 0, 0, 0, 0), in) << idx;
+  }
+  ASSERT_TRUE(send.mayAccept(14, 14, 0, 0));
+  ASSERT_FALSE(send.mayAccept(15, 19.5, 0, 0));
+
+  // overlaps are errors
+  ASSERT_THROW(Filter("+dst=1-5,5"), ex::Exception);
+  ASSERT_THROW(Filter("+dst=3,1-10"), ex::Exception);
+  ASSERT_THROW(Filter("+send=10-20,15-30"), ex::Exception);
+  ASSERT_THROW(Filter("+send=10-20,0-30"), ex::Exception);
+  ASSERT_NO_THROW(Filter("+send=10-20,20-30"));
+}
+
+TEST(Filter, columns) {
+  // each kind of evaluation matches the record path
+  std::vector<std::string> descs = {"+src=3-9",
+                                    "-src=3-9",
+                                    "+src=0-4,100,70000",
+                                    "-dst=65535-65536",
+                                    "+dst=1,3,5-7,2000000",
+                                    "-trans=5-18446744073709551615",
+                                    "+send=10-20",
+                                    "-send=10-20",
+                                    "+recv=0-3,5-7,11-12"};
+  Filter::Columns columns(64);
+  std::vector<Filter::Record> records;
+  for (u32 row = 0; row < 64; row++) {
+    Filter::Record record;
+    u32 value = (row < 32) ? row : (65500 + row * 2);
+    Filter::packetRecord(value, value * 31, row * 3, 0, 0, row * 0.5,
+                         row * 0.75, 0, 0, 0, 0, &record);
+    records.push_back(record);
+    ASSERT_EQ(columns.add(record), row == 63);
+  }
+  for (const std::string& desc : descs) {
+    Filter filter(desc);
+    std::vector<u8> accepted(columns.size);
+    filter.accept(columns, accepted.data());
+    for (u32 row = 0; row < columns.size; row++) {
+      ASSERT_EQ(accepted[row], filter.accept(records[row])) << desc << row;
+    }
+  }
+}
+
+TEST(Filter, expressionSyntax) {
+  // expressions may start with a flagged term
+  Filter::Record record;
+  Filter::messageRecord(0, 0, 0, 2, 7, 0, 0, 0, 0, 0, &record);
+  ASSERT_THROW(Filter("+app=0 | +pc=2"), ex::Exception);
+  Filter either("+app=0 | +pc=2", Filter::Syntax::EXPRESSION);
+  ASSERT_EQ(either.syntax(), Filter::Syntax::EXPRESSION);
+  ASSERT_TRUE(either.accept(record));
+  Filter both("-op=7 & app=0", Filter::Syntax::EXPRESSION);
+  ASSERT_FALSE(both.accept(record));
+  Filter::messageRecord(0, 0, 0, 2, 6, 0, 0, 0, 0, 0, &record);
+  ASSERT_TRUE(both.accept(record));
+
+  // a single flagged term is the same filter either way
+  Filter term("-op=7", Filter::Syntax::EXPRESSION);
+  ASSERT_EQ(term.accept(record), Filter("-op=7").accept(record));
+}
@@ -0,0 +1,244 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_FLATTABLE_H_
+#define PARSE_FLATTABLE_H_
+
+#include <prim/prim.h>
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// This is a hash table from u64 keys to values, built for many short-lived
+// entries. The slots are a flat open-addressing array with linear probing and
+// backward-shift deletion, so lookups touch one or two cache lines and
+// deletions leave no tombstones. The values live in a slab of fixed-size
+// blocks whose freed entries are reused, so a value's address never changes
+// while it is in the table and callers can hold on to it.
+template <typename T>
+class FlatTable {
+ public:
+  explicit FlatTable(u64 _capacity = 1024);
+  ~FlatTable();
+
+  u64 size() const;
+  bool empty() const;
+
+  // returns nullptr if the key isn't in the table
+  T* find(u64 _key);
+  const T* find(u64 _key) const;
+
+  // returns the value of the key, adding a default value if it is missing
+  T* emplace(u64 _key);
+
+  // returns false if the key isn't in the table
+  bool erase(u64 _key);
+
+  void clear();
+  void swap(FlatTable& _other);
+
+ private:
+  static const u32 EMPTY = U32_MAX;
+  static const u32 BLOCK_BITS = 12;
+
+  struct Slot {
+    u64 key;
+    u32 entry;  // slab index, EMPTY for a free slot
+  };
+
+  u64 home(u64 _key) const;
+
+  // returns the slot of the key or the free slot that ends its probe sequence
+  u64 probe(u64 _key) const;
+
+  T& entry(u32 _index);
+  void grow();
+
+  std::vector<Slot> slots_;
+  u64 mask_;
+  u32 shift_;
+  u64 size_;
+
+  std::vector<std::unique_ptr<T[]> > blocks_;
+  u32 allocated_;          // entries handed out from the blocks
+  std::vector<u32> free_;  // entries to reuse
+};
+
+template <typename T>
+FlatTable<T>::FlatTable(u64 _capacity)
+    : size_(0), allocated_(0) {
+  // a power of two of at least twice the capacity keeps the load under 1/2
+  u64 slots = 16;
+  shift_ = 60;
+  while (slots < 2 * _capacity) {
+    slots *= 2;
+    shift_--;
+  }
+  slots_.assign(slots, {0, EMPTY});
+  mask_ = slots - 1;
+}
+
+template <typename T>
+FlatTable<T>::~FlatTable() {}
+
+template <typename T>
+u64 FlatTable<T>::size() const {
+  return size_;
+}
+
+template <typename T>
+bool FlatTable<T>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T>
+T* FlatTable<T>::find(u64 _key) {
+  const Slot& slot = slots_[probe(_key)];
+  return slot.entry == EMPTY ? nullptr : &entry(slot.entry);
+}
+
+template <typename T>
+const T* FlatTable<T>::find(u64 _key) const {
+  return const_cast<FlatTable<T>*>(this)->find(_key);
+}
+
+template <typename T>
+T* FlatTable<T>::emplace(u64 _key) {
+  u64 index = probe(_key);
+  if (slots_[index].entry != EMPTY) {
+    return &entry(slots_[index].entry);
+  }
+  if (2 * (size_ + 1) > slots_.size()) {
+    grow();
+    index = probe(_key);
+  }
+
+  // take a freed entry or a new one
+  u32 value;
+  if (!free_.empty()) {
+    value = free_.back();
+    free_.pop_back();
+  } else {
+    if ((allocated_ >> BLOCK_BITS) == blocks_.size()) {
+      blocks_.emplace_back(new T[1u << BLOCK_BITS]);
+    }
+    value = allocated_++;
+  }
+  entry(value) = T();
+  slots_[index] = {_key, value};
+  size_++;
+  return &entry(value);
+}
+
+template <typename T>
+bool FlatTable<T>::erase(u64 _key) {
+  u64 hole = probe(_key);
+  if (slots_[hole].entry == EMPTY) {
+    return false;
+  }
+  free_.push_back(slots_[hole].entry);
+  size_--;
+
+  // shift back the following entries that the hole would cut off from their
+  // home slot
+  u64 next = hole;
+  while (true) {
+    next = (next + 1) & mask_;
+    if (slots_[next].entry == EMPTY) {
+      break;
+    }
+    u64 home = this->home(slots_[next].key);
+    if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+  }
+  slots_[hole].entry = EMPTY;
+  return true;
+}
+
+template <typename T>
+void FlatTable<T>::clear() {
+  for (Slot& slot : slots_) {
+    slot.entry = EMPTY;
+  }
+  size_ = 0;
+  allocated_ = 0;
+  free_.clear();
+}
+
+template <typename T>
+void FlatTable<T>::swap(FlatTable& _other) {
+  std::swap(slots_, _other.slots_);
+  std::swap(mask_, _other.mask_);
+  std::swap(shift_, _other.shift_);
+  std::swap(size_, _other.size_);
+  std::swap(blocks_, _other.blocks_);
+  std::swap(allocated_, _other.allocated_);
+  std::swap(free_, _other.free_);
+}
+
+template <typename T>
+u64 FlatTable<T>::home(u64 _key) const {
+  // fibonacci hashing spreads sequential ids over the whole table
+  return (_key * 0x9E3779B97F4A7C15lu) >> shift_;
+}
+
+template <typename T>
+u64 FlatTable<T>::probe(u64 _key) const {
+  u64 index = home(_key);
+  while (slots_[index].entry != EMPTY && slots_[index].key != _key) {
+    index = (index + 1) & mask_;
+  }
+  return index;
+}
+
+template <typename T>
+T& FlatTable<T>::entry(u32 _index) {
+  return blocks_[_index >> BLOCK_BITS][_index & ((1u << BLOCK_BITS) - 1)];
+}
+
+template <typename T>
+void FlatTable<T>::grow() {
+  // the values stay in place, only the slots are rebuilt
+  std::vector<Slot> slots(slots_.size() * 2, {0, EMPTY});
+  slots_.swap(slots);
+  mask_ = slots_.size() - 1;
+  shift_--;
+  for (const Slot& slot : slots) {
+    if (slot.entry != EMPTY) {
+      slots_[probe(slot.key)] = slot;
+    }
+  }
+}
+
+#endif  // PARSE_FLATTABLE_H_
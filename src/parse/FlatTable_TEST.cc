@@ -0,0 +1,137 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/FlatTable.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+TEST(FlatTable, basic) {
+  FlatTable<u64> table;
+  ASSERT_TRUE(table.empty());
+  ASSERT_EQ(table.find(5), nullptr);
+  *table.emplace(5) = 50;
+  *table.emplace(6) = 60;
+  ASSERT_EQ(table.size(), 2u);
+  ASSERT_EQ(*table.find(5), 50u);
+
+  // an existing value is returned as is
+  ASSERT_EQ(*table.emplace(5), 50u);
+  ASSERT_EQ(table.size(), 2u);
+
+  // new values are default values even when an entry is reused
+  ASSERT_TRUE(table.erase(5));
+  ASSERT_FALSE(table.erase(5));
+  ASSERT_EQ(table.find(5), nullptr);
+  ASSERT_EQ(*table.emplace(7), 0u);
+  ASSERT_EQ(table.size(), 2u);
+
+  table.clear();
+  ASSERT_TRUE(table.empty());
+  ASSERT_EQ(table.find(6), nullptr);
+}
+
+TEST(FlatTable, stable) {
+  // values keep their address while the table grows
+  FlatTable<u64> table(4);
+  std::vector<u64*> values;
+  for (u64 key = 0; key < 10000; key++) {
+    u64* value = table.emplace(key << 32);
+    *value = key;
+    values.push_back(value);
+  }
+  for (u64 key = 0; key < 10000; key++) {
+    ASSERT_EQ(table.find(key << 32), values.at(key));
+    ASSERT_EQ(*values.at(key), key);
+  }
+}
+
+TEST(FlatTable, random) {
+  // a sliding window of open keys like the transactions of a log, with ids
+  // made of a terminal and a counter
+  std::mt19937_64 rnd(12345);
+  FlatTable<u64> table(16);
+  std::unordered_map<u64, u64> expected;
+  std::vector<u64> open;
+  for (u32 step = 0; step < 200000; step++) {
+    u64 op = rnd() % 8;
+    if (op < 4 || open.empty()) {
+      u64 key = ((rnd() % 64) << 32) | (rnd() % 4096);
+      u64 value = rnd();
+      bool found = expected.count(key) > 0;
+      u64* stored = table.emplace(key);
+      if (found) {
+        ASSERT_EQ(*stored, expected.at(key));
+      } else {
+        ASSERT_EQ(*stored, 0u);
+        *stored = value;
+        expected[key] = value;
+        open.push_back(key);
+      }
+    } else if (op < 6) {
+      u64 index = rnd() % open.size();
+      u64 key = open.at(index);
+      ASSERT_TRUE(table.erase(key));
+      expected.erase(key);
+      open.at(index) = open.back();
+      open.pop_back();
+    } else {
+      u64 key = ((rnd() % 64) << 32) | (rnd() % 4096);
+      const u64* value = table.find(key);
+      if (expected.count(key) > 0) {
+        ASSERT_NE(value, nullptr);
+        ASSERT_EQ(*value, expected.at(key));
+      } else {
+        ASSERT_EQ(value, nullptr);
+      }
+    }
+    ASSERT_EQ(table.size(), expected.size());
+  }
+  for (const auto& entry : expected) {
+    ASSERT_EQ(*table.find(entry.first), entry.second);
+  }
+}
+
+TEST(FlatTable, swap) {
+  FlatTable<u64> a;
+  FlatTable<u64> b;
+  *a.emplace(1) = 10;
+  *b.emplace(2) = 20;
+  *b.emplace(3) = 30;
+  a.swap(b);
+  ASSERT_EQ(a.size(), 2u);
+  ASSERT_EQ(*a.find(3), 30u);
+  ASSERT_EQ(a.find(1), nullptr);
+  ASSERT_EQ(*b.find(1), 10u);
+}
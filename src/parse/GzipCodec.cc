@@ -0,0 +1,87 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/GzipCodec.h"
+
+#include <ex/Exception.h>
+
+#include <cstring>
+#include <utility>
+
+GzipCodec::GzipCodec(std::unique_ptr<InputStream> _input, u64 _pieceSize)
+    : input_(std::move(_input)),
+      pieceSize_(_pieceSize),
+      inBuffer_(1 << 20),
+      inputEnd_(false) {
+  std::memset(&stream_, 0, sizeof(stream_));
+  if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+    throw ex::Exception("Unable to initialize zlib\n");
+  }
+}
+
+GzipCodec::~GzipCodec() {
+  inflateEnd(&stream_);
+}
+
+bool GzipCodec::read(std::vector<char>* _buffer) {
+  // inflate until the piece is full or the input is exhausted
+  u64 size = _buffer->size();
+  _buffer->resize(size + pieceSize_);
+  stream_.next_out = reinterpret_cast<Bytef*>(_buffer->data() + size);
+  stream_.avail_out = pieceSize_;
+  while (stream_.avail_out > 0) {
+    if (stream_.avail_in == 0 && !inputEnd_) {
+      u64 bytes = input_->read(inBuffer_.data(), inBuffer_.size());
+      inputEnd_ = (bytes == 0);
+      stream_.next_in = reinterpret_cast<Bytef*>(inBuffer_.data());
+      stream_.avail_in = bytes;
+    }
+    uInt availOut = stream_.avail_out;
+    s32 ret = inflate(&stream_, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      // continue with the next member of a multi-member gzip file
+      inflateReset(&stream_);
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      throw ex::Exception("Error while decompressing input file: %s\n",
+                          input_->filename().c_str());
+    }
+    if (inputEnd_ && stream_.avail_out == availOut) {
+      // everything has been flushed
+      if (stream_.total_in > 0) {
+        throw ex::Exception("Input file is truncated: %s\n",
+                            input_->filename().c_str());
+      }
+      break;
+    }
+  }
+  u64 produced = pieceSize_ - stream_.avail_out;
+  _buffer->resize(size + produced);
+  return produced > 0 || !inputEnd_;
+}
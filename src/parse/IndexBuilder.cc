@@ -0,0 +1,232 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/IndexBuilder.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+IndexBuilder::IndexBuilder(u64 _blockSize, u64 _pieceSize)
+    : blockSize_(_blockSize),
+      pieceSize_(_pieceSize),
+      minSendTime_(U64_MAX),
+      maxRecvTime_(0),
+      candidate_(false),
+      textBase_(0),
+      inMessage_(false),
+      msgTransId_(0),
+      msgEnd_(0) {}
+
+IndexBuilder::~IndexBuilder() {}
+
+BlockIndex IndexBuilder::build(const std::string& _inputFile) {
+  RestartDecoder decoder(_inputFile, pieceSize_);
+  Parser parser(this);
+  blocks_.clear();
+  blocks_.emplace_back();
+  blocks_.back().bit = decoder.bit();
+  minSendTime_ = U64_MAX;
+  maxRecvTime_ = 0;
+  candidate_ = false;
+  text_.clear();
+  textBase_ = 0;
+  trans_.clear();
+  inMessage_ = false;
+
+  bool more = true;
+  while (more) {
+    more = decoder.read(&text_);
+
+    // every piece ends at a restart point
+    if (more && !candidate_ &&
+        decoder.textOffset() >= blocks_.back().recordOffset + blockSize_) {
+      candidate_ = true;
+      next_ = BlockIndex::Block();
+      next_.bit = decoder.bit();
+      next_.textOffset = decoder.textOffset();
+      std::vector<u8> window;
+      decoder.window(&window);
+      next_.setWindow(window);
+    }
+    advance(&parser, !more);
+  }
+  if (inMessage_) {
+    throw ex::Exception(
+        "ERROR: State machines didn't complete. "
+        "Input file is likely corrupted.\n");
+  }
+
+  // transactions that never end still cover their blocks
+  for (const auto& trans : trans_) {
+    close(trans.first, trans.second);
+  }
+  trans_.clear();
+
+  return BlockIndex(_inputFile, decoder.format(), textBase_, minSendTime_,
+                    maxRecvTime_, std::move(blocks_));
+}
+
+void IndexBuilder::transactionStart(u64 _transId, u64 _transStart) {
+  Trans& trans = trans_[_transId];
+  trans.start = _transStart;
+  trans.end = _transStart;
+  trans.blocks.clear();
+  touch(_transId, &trans);
+}
+
+void IndexBuilder::transactionEnd(u64 _transId, u64 _transEnd) {
+  auto it = trans_.find(_transId);
+  if (it == trans_.end()) {
+    blocks_.back().addTime(_transEnd);
+    blocks_.back().addTransId(_transId);
+    return;
+  }
+  it->second.end = std::max(it->second.end, _transEnd);
+  touch(_transId, &it->second);
+  close(_transId, it->second);
+  trans_.erase(it);
+}
+
+void IndexBuilder::messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst,
+                                u64 _transId, u32 _protocolClass,
+                                u32 _minHopCount, u32 _opCode) {
+  (void)_msgId;          // unused
+  (void)_msgSrc;         // unused
+  (void)_msgDst;         // unused
+  (void)_protocolClass;  // unused
+  (void)_minHopCount;    // unused
+  (void)_opCode;         // unused
+  inMessage_ = true;
+  msgTransId_ = _transId;
+  msgEnd_ = 0;
+  blocks_.back().addTransId(_transId);
+}
+
+void IndexBuilder::messageEnd() {
+  inMessage_ = false;
+  auto it = trans_.find(msgTransId_);
+  if (it != trans_.end()) {
+    it->second.end = std::max(it->second.end, msgEnd_);
+    touch(msgTransId_, &it->second);
+  }
+}
+
+void IndexBuilder::packetStart(u32 _pktId, u32 _pktHopCount) {
+  (void)_pktId;        // unused
+  (void)_pktHopCount;  // unused
+}
+
+void IndexBuilder::packetEnd() {}
+
+void IndexBuilder::flit(u32 _flitId, u64 _flitSendTime,
+                        u64 _flitReceiveTime) {
+  (void)_flitId;  // unused
+  blocks_.back().addTime(_flitSendTime);
+  blocks_.back().addTime(_flitReceiveTime);
+  msgEnd_ = std::max(msgEnd_, _flitReceiveTime);
+  minSendTime_ = std::min(minSendTime_, _flitSendTime);
+  maxRecvTime_ = std::max(maxRecvTime_, _flitReceiveTime);
+}
+
+void IndexBuilder::advance(Parser* _parser, bool _final) {
+  // only whole lines are parsed until the end
+  u64 end = textBase_ + text_.size();
+  u64 linesEnd = end;
+  if (!_final) {
+    const char* last =
+        static_cast<const char*>(memrchr(text_.data(), '\n', text_.size()));
+    linesEnd = (last == nullptr) ? textBase_
+                                 : textBase_ + (last - text_.data()) + 1;
+  }
+
+  u64 cursor = textBase_;
+  while (cursor < linesEnd) {
+    u64 stop = linesEnd;
+    if (candidate_) {
+      if (cursor < next_.textOffset) {
+        // parse up to the first line starting at or after the restart point
+        stop = lineAfter(next_.textOffset - 1, linesEnd);
+      } else if (!inMessage_) {
+        next_.recordOffset = cursor;
+        newBlock();
+        continue;
+      } else {
+        // wait for the open message to end
+        stop = lineAfter(cursor, linesEnd);
+      }
+    }
+    _parser->parseBlock(std::string_view(text_.data() + (cursor - textBase_),
+                                         stop - cursor));
+    cursor = stop;
+  }
+
+  text_.erase(text_.begin(), text_.begin() + (cursor - textBase_));
+  textBase_ = cursor;
+}
+
+u64 IndexBuilder::lineAfter(u64 _offset, u64 _linesEnd) const {
+  if (_offset >= _linesEnd) {
+    return _linesEnd;
+  }
+  const char* begin = text_.data() + (_offset - textBase_);
+  const char* newline =
+      static_cast<const char*>(std::memchr(begin, '\n', _linesEnd - _offset));
+  return (newline == nullptr) ? _linesEnd
+                              : textBase_ + (newline - text_.data()) + 1;
+}
+
+void IndexBuilder::newBlock() {
+  for (const auto& trans : trans_) {
+    next_.open.push_back(std::make_pair(trans.first, trans.second.start));
+  }
+  std::sort(next_.open.begin(), next_.open.end());
+  blocks_.push_back(std::move(next_));
+  candidate_ = false;
+}
+
+void IndexBuilder::touch(u64 _transId, Trans* _trans) {
+  u32 block = blocks_.size() - 1;
+  blocks_.back().addTransId(_transId);
+  if (_trans->blocks.empty() || _trans->blocks.back() != block) {
+    _trans->blocks.push_back(block);
+  }
+}
+
+void IndexBuilder::close(u64 _transId, const Trans& _trans) {
+  // the times of a transaction reach every block holding its records
+  for (u32 block : _trans.blocks) {
+    blocks_[block].addTime(_trans.start);
+    blocks_[block].addTime(_trans.end);
+    blocks_[block].addTransId(_transId);
+  }
+}
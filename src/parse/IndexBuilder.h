@@ -0,0 +1,101 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_INDEXBUILDER_H_
+#define PARSE_INDEXBUILDER_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "parse/BlockIndex.h"
+#include "parse/Parser.h"
+#include "parse/RecordHandler.h"
+#include "parse/RestartDecoder.h"
+
+// This class builds the sidecar index of a plain or gzip message log. A new
+// block starts at the first line after a restart point at least _blockSize
+// bytes of text past the start of the previous block where no message is
+// open. Restart points are _pieceSize bytes of input apart.
+class IndexBuilder : public RecordHandler {
+ public:
+  explicit IndexBuilder(u64 _blockSize = 1 << 22, u64 _pieceSize = 1 << 16);
+  ~IndexBuilder() override;
+
+  BlockIndex build(const std::string& _inputFile);
+
+  void transactionStart(u64 _transId, u64 _transStart) override;
+  void transactionEnd(u64 _transId, u64 _transEnd) override;
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override;
+  void messageEnd() override;
+  void packetStart(u32 _pktId, u32 _pktHopCount) override;
+  void packetEnd() override;
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override;
+
+ private:
+  struct Trans {
+    u64 start;
+    u64 end;
+    std::vector<u32> blocks;  // the blocks holding its records
+  };
+
+  void advance(Parser* _parser, bool _final);
+  u64 lineAfter(u64 _offset, u64 _linesEnd) const;
+  void newBlock();
+  void touch(u64 _transId, Trans* _trans);
+  void close(u64 _transId, const Trans& _trans);
+
+  const u64 blockSize_;
+  const u64 pieceSize_;
+  std::vector<BlockIndex::Block> blocks_;
+  u64 minSendTime_;
+  u64 maxRecvTime_;
+
+  // the restart point the next block starts after
+  bool candidate_;
+  BlockIndex::Block next_;
+
+  // decoded text not parsed yet, starting at text offset textBase_
+  std::vector<char> text_;
+  u64 textBase_;
+
+  // open transactions and the current message
+  std::unordered_map<u64, Trans> trans_;
+  bool inMessage_;
+  u64 msgTransId_;
+  u64 msgEnd_;
+};
+
+#endif  // PARSE_INDEXBUILDER_H_
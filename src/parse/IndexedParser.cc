@@ -0,0 +1,124 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/IndexedParser.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "parse/Parser.h"
+#include "parse/RestartDecoder.h"
+
+IndexedParser::IndexedParser(Engine* _engine, const BlockIndex* _index)
+    : engine_(_engine), index_(_index) {
+  for (const BlockIndex::Block& block : index_->blocks()) {
+    relevant_.push_back(!block.empty() &&
+                        engine_->mayAccept(block.minTime, block.maxTime,
+                                           block.minTransId, block.maxTransId));
+  }
+}
+
+IndexedParser::~IndexedParser() {}
+
+bool IndexedParser::skips() const {
+  return std::find(relevant_.begin(), relevant_.end(), false) !=
+         relevant_.end();
+}
+
+void IndexedParser::parse(const std::string& _inputFile) {
+  RestartDecoder decoder(_inputFile);
+  if (decoder.format() != index_->format()) {
+    throw ex::Exception("Index doesn't match the input file: %s\n",
+                        _inputFile.c_str());
+  }
+  Parser parser(engine_);
+  const std::vector<BlockIndex::Block>& blocks = index_->blocks();
+  std::vector<char> text;
+  std::vector<u8> window;
+
+  u64 next = 0;
+  while (next < blocks.size()) {
+    if (!relevant_[next]) {
+      next++;
+      continue;
+    }
+
+    // find the run of relevant blocks
+    u64 first = next;
+    while (next < blocks.size() && relevant_[next]) {
+      next++;
+    }
+    u64 begin = blocks[first].recordOffset;
+    u64 end = (next < blocks.size()) ? blocks[next].recordOffset
+                                     : index_->textSize();
+
+    // decode from the restart point, parsing whole lines of the run
+    engine_->restart(blocks[first].open);
+    blocks[first].getWindow(&window);
+    decoder.seek(blocks[first].bit, blocks[first].textOffset, window);
+    text.clear();
+    u64 textBase = blocks[first].textOffset;
+    while (begin < end) {
+      bool more = decoder.read(&text);
+      u64 stop = std::min(end, textBase + text.size());
+      if (more && stop < end) {
+        const char* last = static_cast<const char*>(
+            memrchr(text.data(), '\n', stop - textBase));
+        stop = (last == nullptr) ? textBase
+                                 : textBase + (last - text.data()) + 1;
+      }
+      if (stop > begin) {
+        parser.parseBlock(
+            std::string_view(text.data() + (begin - textBase), stop - begin));
+        begin = stop;
+      }
+      if (!more) {
+        break;
+      }
+
+      // drop the text that isn't needed anymore
+      u64 drop = std::min<u64>(begin - textBase, text.size());
+      text.erase(text.begin(), text.begin() + drop);
+      textBase += drop;
+    }
+    if (begin < end) {
+      throw ex::Exception("Index doesn't match the input file: %s\n",
+                          _inputFile.c_str());
+    }
+  }
+
+  // nothing is open at the end of the log
+  if (!relevant_.empty() && !relevant_.back()) {
+    engine_->restart({});
+  }
+}
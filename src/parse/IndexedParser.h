@@ -0,0 +1,64 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_INDEXEDPARSER_H_
+#define PARSE_INDEXEDPARSER_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/BlockIndex.h"
+#include "parse/Engine.h"
+
+// This class parses only the blocks of a message log whose zone maps can hold
+// records that pass the filters of the engine. Each run of consecutive
+// relevant blocks is decoded from its restart point and the engine is given
+// the transactions that are open where the run starts. The outputs are
+// identical to parsing the whole log.
+class IndexedParser {
+ public:
+  IndexedParser(Engine* _engine, const BlockIndex* _index);
+  ~IndexedParser();
+
+  // returns true if any block can be skipped
+  bool skips() const;
+
+  // feeds the relevant blocks of the input file into the engine
+  void parse(const std::string& _inputFile);
+
+ private:
+  Engine* engine_;
+  const BlockIndex* index_;
+  std::vector<bool> relevant_;
+};
+
+#endif  // PARSE_INDEXEDPARSER_H_
@@ -0,0 +1,178 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Indexer.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// the delimiters and the newlines in 64 bytes of text, one bit per byte
+struct Masks {
+  u64 delimiters;
+  u64 newlines;
+};
+
+typedef Masks (*ScanFunction)(const char* _text);
+
+#if defined(__x86_64__)
+
+// SSE2 is part of x86-64
+Masks scanSse2(const char* _text) {
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i comma = _mm_set1_epi8(',');
+  Masks masks = {0, 0};
+  for (u32 idx = 0; idx < 4; idx++) {
+    __m128i chunk = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(_text + idx * 16));
+    u64 newlines = static_cast<u32>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+    u64 commas = static_cast<u32>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, comma)));
+    masks.newlines |= newlines << (idx * 16);
+    masks.delimiters |= (newlines | commas) << (idx * 16);
+  }
+  return masks;
+}
+
+__attribute__((target("avx2"))) Masks scanAvx2(const char* _text) {
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const __m256i comma = _mm256_set1_epi8(',');
+  Masks masks = {0, 0};
+  for (u32 idx = 0; idx < 2; idx++) {
+    __m256i chunk = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(_text + idx * 32));
+    u64 newlines = static_cast<u32>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+    u64 commas = static_cast<u32>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, comma)));
+    masks.newlines |= newlines << (idx * 32);
+    masks.delimiters |= (newlines | commas) << (idx * 32);
+  }
+  return masks;
+}
+
+ScanFunction selectScan() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return scanAvx2;
+  }
+  return scanSse2;
+}
+
+#else
+
+Masks scanScalar(const char* _text) {
+  Masks masks = {0, 0};
+  for (u32 idx = 0; idx < 64; idx++) {
+    u64 newline = _text[idx] == '\n';
+    u64 comma = _text[idx] == ',';
+    masks.newlines |= newline << idx;
+    masks.delimiters |= (newline | comma) << idx;
+  }
+  return masks;
+}
+
+ScanFunction selectScan() {
+  return scanScalar;
+}
+
+#endif
+
+bool isSpace(char _c) {
+  return _c == ' ' || _c == '\t' || _c == '\r' || _c == '\v' || _c == '\f';
+}
+
+}  // namespace
+
+Indexer::Indexer() {}
+
+Indexer::~Indexer() {}
+
+void Indexer::index(std::string_view _text) {
+  // the instruction set is picked once at runtime
+  static const ScanFunction scan = selectScan();
+
+  lines_.clear();
+  delimiters_.clear();
+  const char* text = _text.data();
+  u64 size = _text.size();
+  u64 lineStart = 0;
+  u32 lineFirst = 0;
+
+  for (u64 base = 0; base < size; base += 64) {
+    Masks masks;
+    if (size - base >= 64) {
+      masks = scan(text + base);
+    } else {
+      // the tail is padded with bytes that are never delimiters
+      char tail[64] = {};
+      std::memcpy(tail, text + base, size - base);
+      masks = scan(tail);
+    }
+
+    u64 bits = masks.delimiters;
+    while (bits != 0) {
+      u32 bit = __builtin_ctzll(bits);
+      bits &= bits - 1;
+      u64 pos = base + bit;
+      delimiters_.push_back(static_cast<u32>(pos));
+      if (((masks.newlines >> bit) & 1) == 0) {
+        continue;
+      }
+
+      // finish the line, skipping the indentation
+      Line line;
+      u64 start = lineStart;
+      while (start < pos && isSpace(text[start])) {
+        start++;
+      }
+      line.start = static_cast<u32>(start);
+      line.first = lineFirst;
+      line.last = static_cast<u32>(delimiters_.size() - 1);
+      line.tag = (start < pos) ? recordTag(text[start], text[start + 1]) : 0;
+      lines_.push_back(line);
+      lineStart = pos + 1;
+      lineFirst = static_cast<u32>(delimiters_.size());
+    }
+  }
+}
+
+const std::vector<Indexer::Line>& Indexer::lines() const {
+  return lines_;
+}
+
+const std::vector<u32>& Indexer::delimiters() const {
+  return delimiters_;
+}
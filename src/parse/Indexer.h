@@ -0,0 +1,76 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_INDEXER_H_
+#define PARSE_INDEXER_H_
+
+#include <prim/prim.h>
+
+#include <string_view>
+#include <vector>
+
+// the record type of a line is determined by its first two bytes
+constexpr u16 recordTag(char _first, char _second) {
+  return static_cast<u16>((static_cast<u8>(_first) << 8) |
+                          static_cast<u8>(_second));
+}
+
+// This class finds the structure of a block of message log text in a single
+// pass. Every '\n' and ',' is located 64 bytes at a time with SIMD compares
+// (AVX2 or SSE2 when available, scalar otherwise) and each line gets its
+// record tag and the range of its delimiters. Fields can then be decoded
+// directly from the offsets without splitting.
+class Indexer {
+ public:
+  struct Line {
+    u32 start;  // first byte after the indentation
+    u32 first;  // index of the first delimiter of the line
+    u32 last;   // index of the '\n' ending the line
+    u16 tag;    // recordTag() of the first two bytes, 0 for blank lines
+  };
+
+  Indexer();
+  ~Indexer();
+
+  // indexes _text which must be smaller than 4GiB, only lines ending with a
+  // '\n' are indexed
+  void index(std::string_view _text);
+
+  const std::vector<Line>& lines() const;
+
+  // offsets of every ',' and '\n' in the text
+  const std::vector<u32>& delimiters() const;
+
+ private:
+  std::vector<Line> lines_;
+  std::vector<u32> delimiters_;
+};
+
+#endif  // PARSE_INDEXER_H_
@@ -0,0 +1,117 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <prim/prim.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "parse/Indexer.h"
+#include "parse/Reader.h"
+#include "parse/util.h"
+
+const u64 BLOCK_SIZE = 1 << 16;
+
+// compares finding the line and field boundaries line by line with trimming
+// and split() against the structural indexer on a whole input file
+s32 main(s32 _argc, char** _argv) {
+  if (_argc != 2) {
+    std::fprintf(stderr, "usage: %s <inputfile>\n", _argv[0]);
+    return -1;
+  }
+
+  // gather the whole file into one contiguous buffer
+  std::string text;
+  Reader reader(_argv[1]);
+  std::string_view block;
+  while (reader.nextBlock(&block)) {
+    text.append(block);
+  }
+
+  const u32 ITERATIONS = 20;
+  f64 splitBest = F64_POS_INF;
+  f64 indexBest = F64_POS_INF;
+  u64 splitFields = 0;
+  u64 indexFields = 0;
+  Indexer indexer;
+  for (u32 iter = 0; iter < ITERATIONS; iter++) {
+    splitFields = 0;
+    indexFields = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string_view words[8];
+    u64 pos = 0;
+    while (pos < text.size()) {
+      u64 nl = text.find('\n', pos);
+      std::string_view line = std::string_view(text).substr(pos, nl - pos);
+      pos = nl + 1;
+      u64 first = line.find_first_not_of(" \t\r");
+      if (first == std::string_view::npos) {
+        continue;
+      }
+      line.remove_prefix(first);
+      splitFields += split(line, words, 8);
+    }
+
+    auto middle = std::chrono::steady_clock::now();
+    for (u64 base = 0; base < text.size();) {
+      u64 size = std::min(BLOCK_SIZE, text.size() - base);
+      u64 end = text.find('\n', base + size - 1);
+      size = (end == std::string::npos ? text.size() : end + 1) - base;
+      indexer.index(std::string_view(text).substr(base, size));
+      for (const Indexer::Line& line : indexer.lines()) {
+        indexFields += (line.tag != 0) ? line.last - line.first + 1 : 0;
+      }
+      base += size;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    splitBest =
+        std::min(splitBest, std::chrono::duration<f64>(middle - start).count());
+    indexBest =
+        std::min(indexBest, std::chrono::duration<f64>(end - middle).count());
+  }
+  if (splitFields != indexFields) {
+    std::fprintf(stderr, "tokenizers disagree! %lu vs %lu\n", splitFields,
+                 indexFields);
+    return -1;
+  }
+
+  f64 megabytes = static_cast<f64>(text.size()) / 1e6;
+  std::printf("bytes:   %lu\n", text.size());
+  std::printf("fields:  %lu\n", splitFields);
+  std::printf("split:   %.1f MB/s\n", megabytes / splitBest);
+  std::printf("indexer: %.1f MB/s\n", megabytes / indexBest);
+  std::printf("speedup: %.2fx\n", splitBest / indexBest);
+  return 0;
+}
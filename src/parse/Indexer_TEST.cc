@@ -0,0 +1,100 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Indexer.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(Indexer, delimiters) {
+  std::mt19937_64 rnd(12345);
+  const char alphabet[] = {'a', '1', ',', '\n', ' ', '+', 'M'};
+  for (u64 size : {0lu, 1lu, 63lu, 64lu, 65lu, 127lu, 128lu, 1000lu, 4099lu}) {
+    std::string text;
+    for (u64 idx = 0; idx < size; idx++) {
+      text.push_back(alphabet[rnd() % sizeof(alphabet)]);
+    }
+
+    std::vector<u32> expected;
+    for (u64 idx = 0; idx < text.size(); idx++) {
+      if (text[idx] == ',' || text[idx] == '\n') {
+        expected.push_back(idx);
+      }
+    }
+    Indexer indexer;
+    indexer.index(text);
+    ASSERT_EQ(indexer.delimiters(), expected);
+
+    // every line covers the delimiters up to its newline
+    u32 next = 0;
+    for (const Indexer::Line& line : indexer.lines()) {
+      ASSERT_EQ(line.first, next);
+      ASSERT_EQ(text[indexer.delimiters()[line.last]], '\n');
+      next = line.last + 1;
+    }
+  }
+}
+
+TEST(Indexer, lines) {
+  std::string text =
+      "+T,1,2\n"
+      " +M,0,1,2,3,4,5,6\n"
+      "  +P,0,1\n"
+      "   F,0,10,20\n"
+      "\t\r\n"
+      "\n"
+      "  -P\n"
+      " -M\n"
+      "-T,1,30\r\n"
+      "F,1,2,3";  // not newline terminated
+
+  Indexer indexer;
+  indexer.index(text);
+  const std::vector<Indexer::Line>& lines = indexer.lines();
+  ASSERT_EQ(lines.size(), 9u);
+  ASSERT_EQ(lines[0].tag, recordTag('+', 'T'));
+  ASSERT_EQ(lines[0].start, 0u);
+  ASSERT_EQ(lines[1].tag, recordTag('+', 'M'));
+  ASSERT_EQ(lines[1].start, 8u);
+  ASSERT_EQ(lines[1].last - lines[1].first, 7u);
+  ASSERT_EQ(lines[2].tag, recordTag('+', 'P'));
+  ASSERT_EQ(lines[3].tag, recordTag('F', ','));
+  ASSERT_EQ(text.substr(lines[3].start, 4), "F,0,");
+  ASSERT_EQ(lines[4].tag, 0u);
+  ASSERT_EQ(lines[5].tag, 0u);
+  ASSERT_EQ(lines[6].tag, recordTag('-', 'P'));
+  ASSERT_EQ(lines[7].tag, recordTag('-', 'M'));
+  ASSERT_EQ(lines[8].tag, recordTag('-', 'T'));
+  ASSERT_EQ(indexer.delimiters().size(), 28u);
+}
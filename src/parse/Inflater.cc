@@ -0,0 +1,659 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Inflater.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+const u32 MAX_MATCH = 258;
+const u32 MAX_BITS = 15;
+const u32 FAST_BITS = 10;
+
+const u16 LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                             15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                             67, 83, 99, 115, 131, 163, 195, 227, 258};
+const u8 LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                             2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const u16 DISTANCE_BASE[30] = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const u8 DISTANCE_EXTRA[30] = {0, 0, 0,  0,  1,  1,  2,  2,  3,  3,
+                               4, 4, 5,  5,  6,  6,  7,  7,  8,  8,
+                               9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const u8 CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                  11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+// an LSB first bit reader over the whole input, reads past the end yield zeros
+class BitStream {
+ public:
+  BitStream(const u8* _data, u64 _size)
+      : data_(_data), size_(_size), pos_(0), buf_(0), count_(0) {}
+
+  const u8* data() const {
+    return data_;
+  }
+
+  u64 size() const {
+    return size_;
+  }
+
+  u64 tell() const {
+    return (pos_ << 3) - count_;
+  }
+
+  // true if more bits were consumed than exist
+  bool overrun() const {
+    return tell() > (size_ << 3);
+  }
+
+  void seek(u64 _bit) {
+    pos_ = _bit >> 3;
+    buf_ = 0;
+    count_ = 0;
+    refill();
+    consume(_bit & 7);
+  }
+
+  // ensures at least 56 bits are buffered
+  void refill() {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (pos_ + 8 <= size_) {
+      u64 word;
+      std::memcpy(&word, data_ + pos_, 8);
+      buf_ |= word << count_;
+      pos_ += (63 - count_) >> 3;
+      count_ |= 56;
+      return;
+    }
+#endif
+    while (count_ <= 56) {
+      u64 byte = (pos_ < size_) ? data_[pos_] : 0;
+      buf_ |= byte << count_;
+      pos_++;
+      count_ += 8;
+    }
+  }
+
+  u32 peek(u32 _count) const {
+    return static_cast<u32>(buf_ & ((1lu << _count) - 1));
+  }
+
+  void consume(u32 _count) {
+    buf_ >>= _count;
+    count_ -= _count;
+  }
+
+  // takes bits without checking the buffer level
+  u32 take(u32 _count) {
+    u32 val = peek(_count);
+    consume(_count);
+    return val;
+  }
+
+  u32 bits(u32 _count) {
+    if (count_ < _count) {
+      refill();
+    }
+    return take(_count);
+  }
+
+  void alignToByte() {
+    consume(count_ & 7);
+  }
+
+ private:
+  const u8* data_;
+  u64 size_;
+  u64 pos_;
+  u64 buf_;
+  u32 count_;
+};
+
+// a canonical Huffman code with a lookup table for short codes
+class HuffmanCode {
+ public:
+  // _strict requires a complete code, otherwise a single one bit code and an
+  // empty code are allowed as well
+  bool build(const u8* _lengths, u32 _num, bool _strict) {
+    std::memset(count_, 0, sizeof(count_));
+    for (u32 sym = 0; sym < _num; sym++) {
+      count_[_lengths[sym]]++;
+    }
+    count_[0] = 0;
+
+    // check for an over-subscribed or incomplete code
+    s32 left = 1;
+    u32 codes = 0;
+    for (u32 len = 1; len <= MAX_BITS; len++) {
+      left <<= 1;
+      left -= count_[len];
+      codes += count_[len];
+      if (left < 0) {
+        return false;
+      }
+    }
+    if (left > 0 &&
+        (_strict || (codes > 1) || (codes == 1 && count_[1] != 1))) {
+      return false;
+    }
+
+    // sort the symbols by code length
+    u16 offsets[MAX_BITS + 2];
+    offsets[1] = 0;
+    for (u32 len = 1; len <= MAX_BITS; len++) {
+      offsets[len + 1] = offsets[len] + count_[len];
+    }
+    for (u32 sym = 0; sym < _num; sym++) {
+      if (_lengths[sym] != 0) {
+        symbol_[offsets[_lengths[sym]]++] = sym;
+      }
+    }
+
+    // fill the lookup table with the short codes, the codes are stored
+    // bit-reversed because the stream is read LSB first
+    std::memset(fast_, 0, sizeof(fast_));
+    u32 code = 0;
+    u32 index = 0;
+    for (u32 len = 1; len <= FAST_BITS; len++) {
+      for (u32 k = 0; k < count_[len]; k++) {
+        u32 reversed = 0;
+        for (u32 b = 0; b < len; b++) {
+          reversed |= ((code >> b) & 1) << (len - 1 - b);
+        }
+        u16 entry = static_cast<u16>(symbol_[index] | (len << 9));
+        for (u32 slot = reversed; slot < (1u << FAST_BITS); slot += 1u << len) {
+          fast_[slot] = entry;
+        }
+        code++;
+        index++;
+      }
+      code <<= 1;
+    }
+    return true;
+  }
+
+  // returns the next symbol or -1 for an invalid code, the caller ensures
+  // enough bits are buffered
+  s32 decode(BitStream* _bits) const {
+    u16 entry = fast_[_bits->peek(FAST_BITS)];
+    if (entry != 0) {
+      _bits->consume(entry >> 9);
+      return entry & 0x1FF;
+    }
+    return decodeSlow(_bits);
+  }
+
+ private:
+  s32 decodeSlow(BitStream* _bits) const {
+    u32 bits = _bits->peek(MAX_BITS);
+    s32 code = 0;
+    s32 first = 0;
+    s32 index = 0;
+    for (u32 len = 1; len <= MAX_BITS; len++) {
+      code |= (bits >> (len - 1)) & 1;
+      s32 count = count_[len];
+      if (code - count < first) {
+        _bits->consume(len);
+        return symbol_[index + (code - first)];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+    return -1;
+  }
+
+  u16 fast_[1 << FAST_BITS];
+  u16 count_[MAX_BITS + 1];
+  u16 symbol_[288];
+};
+
+struct FixedCodes {
+  FixedCodes() {
+    u8 lengths[288];
+    for (u32 sym = 0; sym < 288; sym++) {
+      lengths[sym] = (sym < 144) ? 8 : (sym < 256) ? 9 : (sym < 280) ? 7 : 8;
+    }
+    bool ok = literal.build(lengths, 288, true);
+    std::memset(lengths, 5, 32);
+    ok &= distance.build(lengths, 32, true);
+    assert(ok);
+    (void)ok;
+  }
+
+  HuffmanCode literal;
+  HuffmanCode distance;
+};
+
+const FixedCodes& fixedCodes() {
+  static const FixedCodes codes;
+  return codes;
+}
+
+// reads the code tables of a dynamic block
+bool readDynamicHeader(BitStream* _bits, HuffmanCode* _literal,
+                       HuffmanCode* _distance) {
+  _bits->refill();
+  u32 numLiteral = _bits->take(5) + 257;
+  u32 numDistance = _bits->take(5) + 1;
+  u32 numCodeLength = _bits->take(4) + 4;
+  if (numLiteral > 286 || numDistance > 30) {
+    return false;
+  }
+
+  u8 lengths[286 + 30];
+  std::memset(lengths, 0, 19);
+  for (u32 idx = 0; idx < numCodeLength; idx++) {
+    lengths[CODE_LENGTH_ORDER[idx]] = _bits->bits(3);
+  }
+  HuffmanCode lengthCode;
+  if (!lengthCode.build(lengths, 19, true)) {
+    return false;
+  }
+
+  u32 total = numLiteral + numDistance;
+  u32 idx = 0;
+  while (idx < total) {
+    _bits->refill();
+    s32 sym = lengthCode.decode(_bits);
+    if (sym < 0) {
+      return false;
+    } else if (sym < 16) {
+      lengths[idx++] = sym;
+    } else {
+      u8 len = 0;
+      u32 repeat;
+      if (sym == 16) {
+        if (idx == 0) {
+          return false;
+        }
+        len = lengths[idx - 1];
+        repeat = 3 + _bits->take(2);
+      } else if (sym == 17) {
+        repeat = 3 + _bits->take(3);
+      } else {
+        repeat = 11 + _bits->take(7);
+      }
+      if (idx + repeat > total) {
+        return false;
+      }
+      std::memset(lengths + idx, len, repeat);
+      idx += repeat;
+    }
+  }
+
+  // the end of block code must exist
+  if (lengths[256] == 0) {
+    return false;
+  }
+  return _literal->build(lengths, numLiteral, false) &&
+         _distance->build(lengths + numLiteral, numDistance, false);
+}
+
+// decodes the symbols of a Huffman coded block into _out starting at _pos
+template <typename Sym>
+bool decodeCodes(BitStream* _bits, const HuffmanCode& _literal,
+                 const HuffmanCode& _distance, std::vector<Sym>* _out,
+                 u64* _pos) {
+  u64 pos = *_pos;
+  Sym* out = _out->data();
+  while (true) {
+    if (pos + MAX_MATCH > _out->size()) {
+      _out->resize(_out->size() * 2);
+      out = _out->data();
+    }
+    // one refill covers the longest literal/length/distance sequence
+    _bits->refill();
+    if (_bits->overrun()) {
+      return false;
+    }
+    s32 sym = _literal.decode(_bits);
+    if (sym < 256) {
+      if (sym < 0) {
+        return false;
+      }
+      out[pos++] = static_cast<Sym>(sym);
+      continue;
+    }
+    if (sym == 256) {
+      break;
+    }
+    sym -= 257;
+    if (sym >= 29) {
+      return false;
+    }
+    u32 length = LENGTH_BASE[sym] + _bits->take(LENGTH_EXTRA[sym]);
+    s32 dsym = _distance.decode(_bits);
+    if (dsym < 0 || dsym >= 30) {
+      return false;
+    }
+    u64 distance = DISTANCE_BASE[dsym] + _bits->take(DISTANCE_EXTRA[dsym]);
+    if (distance > pos) {
+      return false;
+    }
+    const Sym* src = out + pos - distance;
+    Sym* dst = out + pos;
+    if (distance >= length) {
+      std::memcpy(dst, src, length * sizeof(Sym));
+    } else {
+      for (u32 idx = 0; idx < length; idx++) {
+        dst[idx] = src[idx];
+      }
+    }
+    pos += length;
+  }
+  *_pos = pos;
+  return !_bits->overrun();
+}
+
+template <typename Sym>
+bool decodeStored(BitStream* _bits, std::vector<Sym>* _out, u64* _pos) {
+  _bits->alignToByte();
+  u32 length = _bits->bits(16);
+  u32 complement = _bits->bits(16);
+  if (length != (~complement & 0xFFFF)) {
+    return false;
+  }
+  u64 byte = _bits->tell() >> 3;
+  if (byte + length > _bits->size()) {
+    return false;
+  }
+  if (*_pos + length > _out->size()) {
+    _out->resize(std::max<u64>(_out->size() * 2, *_pos + length));
+  }
+  const u8* src = _bits->data() + byte;
+  Sym* dst = _out->data() + *_pos;
+  for (u32 idx = 0; idx < length; idx++) {
+    dst[idx] = src[idx];
+  }
+  *_pos += length;
+  _bits->seek((byte + length) << 3);
+  return true;
+}
+
+enum class Status { STOP, END, SWITCH, ERROR };
+
+// tracks where the last marker of a speculative output was seen
+struct MarkerScan {
+  u64 scanned;
+  u64 lastMarker;
+};
+
+// returns true if the last WINDOW_SIZE symbols contain no markers
+inline bool markerFree(const std::vector<u16>& _out, u64 _pos,
+                       MarkerScan* _scan) {
+  u64 from = std::max(_scan->scanned, _pos - std::min<u64>(_pos, 32768));
+  for (u64 idx = from; idx < _pos; idx++) {
+    if (_out[idx] >= 256) {
+      _scan->lastMarker = idx;
+    }
+  }
+  _scan->scanned = _pos;
+  return _pos - _scan->lastMarker > Inflater::WINDOW_SIZE;
+}
+
+}  // namespace
+
+/*** Output ***/
+
+Inflater::Output::Output()
+    : found(false),
+      startBit(0),
+      endBit(0),
+      streamEnd(false),
+      markedStart(0),
+      markedSize(0),
+      plainStart(0),
+      plainSize(0) {}
+
+Inflater::Output::~Output() {}
+
+u64 Inflater::Output::size() const {
+  return (markedSize - markedStart) + (plainSize - plainStart);
+}
+
+void Inflater::Output::resolve(const u8* _window, u8* _dst) const {
+  for (u64 idx = markedStart; idx < markedSize; idx++) {
+    u16 sym = marked[idx];
+    *_dst++ = (sym < 256) ? static_cast<u8>(sym) : _window[sym - WINDOW_SIZE];
+  }
+  std::memcpy(_dst, plain.data() + plainStart, plainSize - plainStart);
+}
+
+/*** Inflater ***/
+
+// decodes blocks until a stop condition, _base is the amount of output
+// produced before _out
+template <typename Sym>
+static Status decodeBlocks(const Inflater& _inflater, BitStream* _bits,
+                           u64 _stopBit, u64 _base, u64 _start,
+                           std::vector<Sym>* _out, u64* _pos,
+                           Inflater::Output* _output, MarkerScan* _scan) {
+  HuffmanCode literal;
+  HuffmanCode distance;
+  while (true) {
+    // stop at the first block boundary at or after the stop bit
+    if (_bits->tell() >= _stopBit) {
+      return Status::STOP;
+    }
+
+    _bits->refill();
+    u32 final = _bits->take(1);
+    u32 type = _bits->take(2);
+    bool ok;
+    if (type == 0) {
+      ok = decodeStored(_bits, _out, _pos);
+    } else if (type == 1) {
+      ok = decodeCodes(_bits, fixedCodes().literal, fixedCodes().distance,
+                       _out, _pos);
+    } else if (type == 2) {
+      ok = readDynamicHeader(_bits, &literal, &distance) &&
+           decodeCodes(_bits, literal, distance, _out, _pos);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      return Status::ERROR;
+    }
+
+    if (final) {
+      // read the gzip trailer
+      _bits->alignToByte();
+      u64 byte = _bits->tell() >> 3;
+      if (byte + 8 > _bits->size()) {
+        return Status::ERROR;
+      }
+      const u8* trailer = _bits->data() + byte;
+      Inflater::Member member;
+      member.offset = _base + (*_pos - _start);
+      member.crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) |
+                   (static_cast<u32>(trailer[3]) << 24);
+      member.size = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) |
+                    (static_cast<u32>(trailer[7]) << 24);
+      _output->members.push_back(member);
+      byte += 8;
+
+      // trailing zeros are ignored like gzip does
+      u64 rest = byte;
+      while (rest < _bits->size() && _bits->data()[rest] == 0) {
+        rest++;
+      }
+      if (rest == _bits->size()) {
+        _bits->seek(_bits->size() << 3);
+        _output->streamEnd = true;
+        return Status::END;
+      }
+
+      // continue with the next member
+      u64 bit;
+      if (!_inflater.gzipHeader(byte, &bit)) {
+        return Status::ERROR;
+      }
+      _bits->seek(bit);
+    }
+
+    if constexpr (std::is_same<Sym, u16>::value) {
+      if (_scan != nullptr && markerFree(*_out, *_pos, _scan)) {
+        return Status::SWITCH;
+      }
+    }
+  }
+}
+
+Inflater::Inflater(const u8* _data, u64 _size) : data_(_data), size_(_size) {}
+
+Inflater::~Inflater() {}
+
+bool Inflater::gzipHeader(u64 _offset, u64* _bit) const {
+  const u8 FTEXT = 1;
+  const u8 FHCRC = 2;
+  const u8 FEXTRA = 4;
+  const u8 FNAME = 8;
+  const u8 FCOMMENT = 16;
+  (void)FTEXT;
+
+  u64 pos = _offset;
+  if (pos + 10 > size_ || data_[pos] != 0x1f || data_[pos + 1] != 0x8b ||
+      data_[pos + 2] != 8 || (data_[pos + 3] & 0xE0) != 0) {
+    return false;
+  }
+  u8 flags = data_[pos + 3];
+  pos += 10;
+  if (flags & FEXTRA) {
+    if (pos + 2 > size_) {
+      return false;
+    }
+    pos += 2 + (data_[pos] | (data_[pos + 1] << 8));
+  }
+  if (flags & FNAME) {
+    while (pos < size_ && data_[pos] != 0) {
+      pos++;
+    }
+    pos++;
+  }
+  if (flags & FCOMMENT) {
+    while (pos < size_ && data_[pos] != 0) {
+      pos++;
+    }
+    pos++;
+  }
+  if (flags & FHCRC) {
+    pos += 2;
+  }
+  if (pos > size_) {
+    return false;
+  }
+  *_bit = pos << 3;
+  return true;
+}
+
+bool Inflater::findBlock(u64 _beginBit, u64 _endBit, u64* _bit) const {
+  BitStream bits(data_, size_);
+  HuffmanCode literal;
+  HuffmanCode distance;
+  _endBit = std::min(_endBit, size_ << 3);
+  for (u64 bit = _beginBit; bit < _endBit; bit++) {
+    // a non-final dynamic block starts with the bits 0,0,1
+    if (((data_[bit >> 3] >> (bit & 7)) & 1) != 0) {
+      continue;
+    }
+    bits.seek(bit);
+    if (bits.take(3) != 4) {
+      continue;
+    }
+    if (readDynamicHeader(&bits, &literal, &distance)) {
+      *_bit = bit;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Inflater::decode(u64 _startBit, u64 _stopBit, const u8* _window,
+                      u64 _windowSize, Output* _output) const {
+  BitStream bits(data_, size_);
+  bits.seek(_startBit);
+  _output->found = true;
+  _output->startBit = _startBit;
+  _output->plain.resize(std::max<u64>(_windowSize * 2, 1 << 20));
+  if (_windowSize > 0) {
+    std::memcpy(_output->plain.data(), _window, _windowSize);
+  }
+  _output->plainStart = _windowSize;
+  _output->plainSize = _windowSize;
+  Status status =
+      decodeBlocks(*this, &bits, _stopBit, 0, _output->plainStart,
+                   &_output->plain, &_output->plainSize, _output, nullptr);
+  _output->endBit = bits.tell();
+  return status == Status::STOP || status == Status::END;
+}
+
+bool Inflater::decodeSpeculative(u64 _startBit, u64 _stopBit,
+                                 Output* _output) const {
+  BitStream bits(data_, size_);
+  bits.seek(_startBit);
+  _output->found = true;
+  _output->startBit = _startBit;
+
+  // the unknown window is filled with markers
+  _output->marked.resize(WINDOW_SIZE * 8);
+  for (u32 idx = 0; idx < WINDOW_SIZE; idx++) {
+    _output->marked[idx] = static_cast<u16>(WINDOW_SIZE + idx);
+  }
+  _output->markedStart = WINDOW_SIZE;
+  _output->markedSize = WINDOW_SIZE;
+  MarkerScan scan = {WINDOW_SIZE, WINDOW_SIZE - 1};
+  Status status = decodeBlocks(*this, &bits, _stopBit, 0, WINDOW_SIZE,
+                               &_output->marked, &_output->markedSize,
+                               _output, &scan);
+  if (status == Status::SWITCH) {
+    // once a whole window is free of markers the rest is decoded as bytes
+    _output->plain.resize(1 << 20);
+    for (u32 idx = 0; idx < WINDOW_SIZE; idx++) {
+      _output->plain[idx] = static_cast<u8>(
+          _output->marked[_output->markedSize - WINDOW_SIZE + idx]);
+    }
+    _output->plainStart = WINDOW_SIZE;
+    _output->plainSize = WINDOW_SIZE;
+    status = decodeBlocks(*this, &bits, _stopBit,
+                          _output->markedSize - _output->markedStart,
+                          WINDOW_SIZE, &_output->plain, &_output->plainSize,
+                          _output, nullptr);
+  }
+  _output->endBit = bits.tell();
+  return status == Status::STOP || status == Status::END;
+}
@@ -0,0 +1,109 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_INFLATER_H_
+#define PARSE_INFLATER_H_
+
+#include <prim/prim.h>
+
+#include <vector>
+
+// This class decodes the deflate streams of gzip data held in memory. Besides
+// regular decoding from a known block boundary with a known window, it can
+// search for block boundaries and decode from them without knowing the
+// preceding 32 KiB window. References into the unknown window are emitted as
+// marker symbols which are resolved once the window becomes known.
+class Inflater {
+ public:
+  static const u32 WINDOW_SIZE = 32768;
+
+  // the trailer of a gzip member
+  struct Member {
+    u64 offset;  // output offset of the member end
+    u32 crc;
+    u32 size;
+  };
+
+  // the result of a decoding run
+  struct Output {
+    Output();
+    ~Output();
+
+    // number of decoded bytes
+    u64 size() const;
+
+    // writes the decoded bytes to _dst, _window holds the WINDOW_SIZE bytes
+    // preceding the output (only used for speculative output)
+    void resolve(const u8* _window, u8* _dst) const;
+
+    bool found;
+    u64 startBit;
+    u64 endBit;
+    bool streamEnd;
+
+    // symbols decoded without a window, values >= 256 are markers
+    //  the first WINDOW_SIZE entries are the unknown window
+    std::vector<u16> marked;
+    u64 markedStart;
+    u64 markedSize;
+
+    // bytes decoded with a window
+    //  the first plainStart entries are the window
+    std::vector<u8> plain;
+    u64 plainStart;
+    u64 plainSize;
+
+    std::vector<Member> members;
+  };
+
+  Inflater(const u8* _data, u64 _size);
+  ~Inflater();
+
+  // parses the gzip header at _offset, yields the bit of the first block
+  bool gzipHeader(u64 _offset, u64* _bit) const;
+
+  // yields the first position in [_beginBit, _endBit) which holds a plausible
+  // dynamic block header
+  bool findBlock(u64 _beginBit, u64 _endBit, u64* _bit) const;
+
+  // decodes from a block boundary with the _windowSize bytes before it, stops
+  // at the first block boundary at or after _stopBit or at the stream end
+  bool decode(u64 _startBit, u64 _stopBit, const u8* _window, u64 _windowSize,
+              Output* _output) const;
+
+  // same as decode() but the window is unknown
+  bool decodeSpeculative(u64 _startBit, u64 _stopBit, Output* _output) const;
+
+ private:
+  const u8* data_;
+  u64 size_;
+};
+
+#endif  // PARSE_INFLATER_H_
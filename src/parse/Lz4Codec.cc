@@ -0,0 +1,93 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Lz4Codec.h"
+
+#include <ex/Exception.h>
+
+#include <utility>
+
+Lz4Codec::Lz4Codec(std::unique_ptr<InputStream> _input, u64 _pieceSize)
+    : input_(std::move(_input)),
+      pieceSize_(_pieceSize),
+      context_(nullptr),
+      inBuffer_(1 << 20),
+      inPos_(0),
+      inSize_(0),
+      inputEnd_(false),
+      frameOpen_(false) {
+  if (LZ4F_isError(LZ4F_createDecompressionContext(&context_, LZ4F_VERSION))) {
+    throw ex::Exception("Unable to initialize lz4\n");
+  }
+}
+
+Lz4Codec::~Lz4Codec() {
+  LZ4F_freeDecompressionContext(context_);
+}
+
+bool Lz4Codec::read(std::vector<char>* _buffer) {
+  // decompress until the piece is full or the input is exhausted
+  u64 size = _buffer->size();
+  _buffer->resize(size + pieceSize_);
+  u64 produced = 0;
+  while (produced < pieceSize_) {
+    if (inPos_ == inSize_ && !inputEnd_) {
+      inSize_ = input_->read(inBuffer_.data(), inBuffer_.size());
+      inPos_ = 0;
+      inputEnd_ = (inSize_ == 0);
+    }
+    size_t dstSize = pieceSize_ - produced;
+    size_t srcSize = inSize_ - inPos_;
+    size_t ret = LZ4F_decompress(context_, _buffer->data() + size + produced,
+                                 &dstSize, inBuffer_.data() + inPos_,
+                                 &srcSize, nullptr);
+    if (LZ4F_isError(ret)) {
+      throw ex::Exception("Error while decompressing input file: %s (%s)\n",
+                          input_->filename().c_str(),
+                          LZ4F_getErrorName(ret));
+    }
+    inPos_ += srcSize;
+    produced += dstSize;
+    if (srcSize != 0 || dstSize != 0) {
+      // an idle call reports the next frame's header size, not an open frame
+      frameOpen_ = (ret != 0);
+    }
+    if (inputEnd_ && dstSize == 0) {
+      // everything has been flushed
+      if (frameOpen_) {
+        throw ex::Exception("Input file is truncated: %s\n",
+                            input_->filename().c_str());
+      }
+      break;
+    }
+  }
+  _buffer->resize(size + produced);
+  return produced > 0 || !inputEnd_;
+}
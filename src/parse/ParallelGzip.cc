@@ -0,0 +1,186 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelGzip.h"
+
+#include <ex/Exception.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+const u64 MIN_CHUNK_SIZE = 1 << 18;
+const u64 MAX_CHUNK_SIZE = 1 << 22;
+
+ParallelGzip::ParallelGzip(const u8* _data, u64 _size, u32 _threads,
+                           u64 _chunkSize)
+    : inflater_(_data, _size),
+      threads_(std::max(_threads, 1u)),
+      bit_(0),
+      done_(false),
+      nextChunk_(0),
+      window_(Inflater::WINDOW_SIZE, 0),
+      windowSize_(0),
+      crc_(crc32(0, nullptr, 0)),
+      memberSize_(0) {
+  if (!inflater_.gzipHeader(0, &firstBit_)) {
+    throw ex::Exception("Invalid gzip header\n");
+  }
+  u64 headerSize = firstBit_ >> 3;
+
+  // each thread should get a few chunks
+  if (_chunkSize == 0) {
+    _chunkSize = std::clamp<u64>(_size / (threads_ * 4), MIN_CHUNK_SIZE,
+                                 MAX_CHUNK_SIZE);
+  }
+  chunkSize_ = _chunkSize;
+  numChunks_ = std::max<u64>((_size - headerSize + chunkSize_ - 1) / chunkSize_,
+                             1);
+  bit_ = firstBit_;
+}
+
+ParallelGzip::~ParallelGzip() {}
+
+bool ParallelGzip::read(std::vector<char>* _buffer) {
+  while (!done_) {
+    if (nextChunk_ == numChunks_) {
+      throw ex::Exception("Input file is truncated\n");
+    }
+
+    // keep all threads busy with upcoming chunks
+    while (pending_.size() < threads_ * 2 &&
+           nextChunk_ + pending_.size() < numChunks_) {
+      u64 chunk = nextChunk_ + pending_.size();
+      pending_.push_back(std::async(
+          std::launch::async, [this, chunk] { return decodeChunk(chunk); }));
+    }
+
+    std::unique_ptr<Inflater::Output> output = pending_.front().get();
+    pending_.pop_front();
+    u64 chunk = nextChunk_++;
+    u64 stop = stopBit(chunk);
+
+    // the previous chunk may have decoded past this whole chunk
+    if (bit_ >= stop) {
+      continue;
+    }
+
+    // when the guessed start doesn't match the real one the chunk is decoded
+    // sequentially from the real position
+    if (!output->found || output->startBit != bit_) {
+      output = std::make_unique<Inflater::Output>();
+      const u8* window = window_.data() + (Inflater::WINDOW_SIZE - windowSize_);
+      if (!inflater_.decode(bit_, stop, window, windowSize_, output.get())) {
+        throw ex::Exception("Error while decompressing input file\n");
+      }
+    }
+
+    append(*output, _buffer);
+    bit_ = output->endBit;
+    done_ = output->streamEnd;
+    return true;
+  }
+  return false;
+}
+
+u64 ParallelGzip::startBit(u64 _chunk) const {
+  if (_chunk == 0) {
+    return firstBit_;
+  }
+  return ((firstBit_ >> 3) + (_chunk * chunkSize_)) << 3;
+}
+
+u64 ParallelGzip::stopBit(u64 _chunk) const {
+  if (_chunk + 1 == numChunks_) {
+    return U64_MAX;
+  }
+  return startBit(_chunk + 1);
+}
+
+std::unique_ptr<Inflater::Output> ParallelGzip::decodeChunk(u64 _chunk) const {
+  std::unique_ptr<Inflater::Output> output =
+      std::make_unique<Inflater::Output>();
+  u64 stop = stopBit(_chunk);
+
+  // the first chunk starts at a known position with an empty window
+  if (_chunk == 0) {
+    if (!inflater_.decode(firstBit_, stop, nullptr, 0, output.get())) {
+      throw ex::Exception("Error while decompressing input file\n");
+    }
+    return output;
+  }
+
+  // try each plausible block start until one decodes cleanly
+  u64 bit = startBit(_chunk);
+  u64 candidate;
+  while (inflater_.findBlock(bit, stop, &candidate)) {
+    if (inflater_.decodeSpeculative(candidate, stop, output.get())) {
+      return output;
+    }
+    output = std::make_unique<Inflater::Output>();
+    bit = candidate + 1;
+  }
+  return output;
+}
+
+void ParallelGzip::append(const Inflater::Output& _output,
+                          std::vector<char>* _buffer) {
+  u64 offset = _buffer->size();
+  u64 size = _output.size();
+  _buffer->resize(offset + size);
+  u8* dst = reinterpret_cast<u8*>(_buffer->data() + offset);
+  _output.resolve(window_.data(), dst);
+
+  // verify the gzip member checksums
+  u64 checked = 0;
+  for (const Inflater::Member& member : _output.members) {
+    crc_ = crc32_z(crc_, dst + checked, member.offset - checked);
+    memberSize_ += member.offset - checked;
+    checked = member.offset;
+    if (crc_ != member.crc || static_cast<u32>(memberSize_) != member.size) {
+      throw ex::Exception("Input file is corrupted, checksum mismatch\n");
+    }
+    crc_ = crc32(0, nullptr, 0);
+    memberSize_ = 0;
+  }
+  crc_ = crc32_z(crc_, dst + checked, size - checked);
+  memberSize_ += size - checked;
+
+  // slide the window
+  if (size >= Inflater::WINDOW_SIZE) {
+    std::memcpy(window_.data(), dst + size - Inflater::WINDOW_SIZE,
+                Inflater::WINDOW_SIZE);
+  } else {
+    std::memmove(window_.data(), window_.data() + size,
+                 Inflater::WINDOW_SIZE - size);
+    std::memcpy(window_.data() + Inflater::WINDOW_SIZE - size, dst, size);
+  }
+  windowSize_ = std::min<u64>(windowSize_ + size, Inflater::WINDOW_SIZE);
+}
@@ -0,0 +1,89 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PARALLELGZIP_H_
+#define PARSE_PARALLELGZIP_H_
+
+#include <prim/prim.h>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "parse/Codec.h"
+#include "parse/Inflater.h"
+
+// This class decompresses gzip data held in memory using multiple threads.
+// The compressed data is cut into chunks and each worker searches its chunk
+// for the first deflate block boundary and decodes from there without knowing
+// the preceding window. The chunks are then stitched together in order. When a
+// guessed boundary doesn't match where the previous chunk ended the chunk is
+// decoded again sequentially, so the output is always exact.
+class ParallelGzip : public Codec {
+ public:
+  // _chunkSize of 0 picks a size based on the input size
+  ParallelGzip(const u8* _data, u64 _size, u32 _threads, u64 _chunkSize = 0);
+  ~ParallelGzip() override;
+
+  // appends the next piece of decompressed data to _buffer, returns false at
+  // the end of the stream
+  bool read(std::vector<char>* _buffer) override;
+
+ private:
+  u64 startBit(u64 _chunk) const;
+  u64 stopBit(u64 _chunk) const;
+  std::unique_ptr<Inflater::Output> decodeChunk(u64 _chunk) const;
+  void append(const Inflater::Output& _output, std::vector<char>* _buffer);
+
+  Inflater inflater_;
+  const u32 threads_;
+  u64 chunkSize_;
+  u64 firstBit_;
+  u64 numChunks_;
+
+  // the actual stream position reached so far
+  u64 bit_;
+  bool done_;
+  u64 nextChunk_;
+
+  // the last WINDOW_SIZE bytes of output, zero padded at the front
+  std::vector<u8> window_;
+  u64 windowSize_;
+
+  // checksum state of the current gzip member
+  u32 crc_;
+  u64 memberSize_;
+
+  // chunks being decoded in the background
+  std::deque<std::future<std::unique_ptr<Inflater::Output> > > pending_;
+};
+
+#endif  // PARSE_PARALLELGZIP_H_
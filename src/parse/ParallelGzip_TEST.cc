@@ -0,0 +1,93 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelGzip.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/TestData_TEST.h"
+
+static std::string gunzip(const std::string& _data, u32 _threads,
+                          u64 _chunkSize) {
+  ParallelGzip gz(reinterpret_cast<const u8*>(_data.data()), _data.size(),
+                  _threads, _chunkSize);
+  std::vector<char> buffer;
+  while (gz.read(&buffer)) {
+  }
+  return std::string(buffer.begin(), buffer.end());
+}
+
+TEST(ParallelGzip, levels) {
+  std::string text = numberedText(20000);
+  for (s32 level : {0, 1, 6, 9}) {
+    std::string data = gzipText(text, level);
+    for (u64 chunkSize : {1000lu, 7777lu, 65536lu, 0lu}) {
+      ASSERT_EQ(gunzip(data, 4, chunkSize), text);
+    }
+  }
+}
+
+TEST(ParallelGzip, singleThread) {
+  std::string text = numberedText(5000);
+  std::string data = gzipText(text);
+  ASSERT_EQ(gunzip(data, 1, 4096), text);
+}
+
+TEST(ParallelGzip, multiMember) {
+  std::string text = numberedText(10000);
+  std::string data;
+  u64 third = text.size() / 3;
+  for (u64 part = 0; part < 3; part++) {
+    data += gzipText(
+        text.substr(part * third, (part == 2) ? std::string::npos : third));
+  }
+  for (u64 chunkSize : {3000lu, 50000lu, 0lu}) {
+    ASSERT_EQ(gunzip(data, 3, chunkSize), text);
+  }
+}
+
+TEST(ParallelGzip, empty) {
+  std::string data = gzipText("");
+  ASSERT_EQ(gunzip(data, 2, 0), "");
+}
+
+TEST(ParallelGzip, corrupted) {
+  std::string text = numberedText(5000);
+  std::string data = gzipText(text);
+  data.at(data.size() - 6) ^= 0xFF;  // checksum
+  ASSERT_THROW(gunzip(data, 2, 4096), ex::Exception);
+  data.resize(data.size() / 2);  // truncated
+  ASSERT_THROW(gunzip(data, 2, 4096), ex::Exception);
+}
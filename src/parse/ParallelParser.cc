@@ -0,0 +1,114 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelParser.h"
+
+#include <deque>
+#include <future>
+#include <string_view>
+#include <utility>
+
+#include "parse/Parser.h"
+
+// returns true if the line is a message end ('-M')
+static bool isMessageEnd(std::string_view _line) {
+  u64 first = 0;
+  while (first < _line.size() &&
+         (_line[first] == ' ' || _line[first] == '\t')) {
+    first++;
+  }
+  return _line.size() - first >= 2 && _line[first] == '-' &&
+         _line[first + 1] == 'M';
+}
+
+ParallelParser::ParallelParser(Engine* _engine, u32 _threads, u64 _chunkSize)
+    : engine_(_engine), threads_(_threads), chunkSize_(_chunkSize) {}
+
+ParallelParser::~ParallelParser() {}
+
+void ParallelParser::parse(Reader* _reader) {
+  std::deque<std::future<std::unique_ptr<Partial> > > pending;
+
+  // merges the oldest chunk into the engine
+  auto mergeFront = [&]() {
+    std::unique_ptr<Partial> partial = pending.front().get();
+    pending.pop_front();
+    engine_->merge(partial.get());
+  };
+
+  // hands a chunk to a worker, waits when enough chunks are in flight
+  auto dispatch = [&](std::string* _chunk) {
+    if (pending.size() >= threads_ * 2) {
+      mergeFront();
+    }
+    pending.push_back(std::async(std::launch::async,
+                                 &ParallelParser::parseChunk,
+                                 engine_->newPartial(), std::move(*_chunk)));
+    _chunk->clear();
+    _chunk->reserve(chunkSize_ + 4096);
+  };
+
+  std::string chunk;
+  chunk.reserve(chunkSize_ + 4096);
+  std::string_view line;
+  try {
+    while (_reader->nextLine(&line)) {
+      chunk.append(line.data(), line.size());
+      chunk.push_back('\n');
+      // message blocks are independent so chunks are only cut after one ends
+      if (chunk.size() >= chunkSize_ && isMessageEnd(line)) {
+        dispatch(&chunk);
+      }
+    }
+    if (!chunk.empty()) {
+      dispatch(&chunk);
+    }
+    while (!pending.empty()) {
+      mergeFront();
+    }
+  } catch (...) {
+    // let the workers finish before unwinding
+    for (auto& future : pending) {
+      future.wait();
+    }
+    throw;
+  }
+}
+
+std::unique_ptr<Partial> ParallelParser::parseChunk(
+    std::unique_ptr<Partial> _partial, std::string _chunk) {
+  Parser parser(_partial.get());
+  parser.parseBlock(_chunk);
+  // the last batches are filtered here rather than on the merging thread
+  if (_partial->idle()) {
+    _partial->flush();
+  }
+  return _partial;
+}
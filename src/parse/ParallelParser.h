@@ -0,0 +1,64 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PARALLELPARSER_H_
+#define PARSE_PARALLELPARSER_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+
+#include "parse/Engine.h"
+#include "parse/Partial.h"
+#include "parse/Reader.h"
+
+// This class parses a message log using multiple threads. The lines are cut
+// into chunks after '-M' lines, each chunk is parsed into its own Partial on a
+// worker thread, and the partials are merged into the engine in file order.
+// The outputs are identical to single threaded parsing.
+class ParallelParser {
+ public:
+  ParallelParser(Engine* _engine, u32 _threads, u64 _chunkSize = 1 << 20);
+  ~ParallelParser();
+
+  // feeds every line of the reader into the engine
+  void parse(Reader* _reader);
+
+ private:
+  static std::unique_ptr<Partial> parseChunk(std::unique_ptr<Partial> _partial,
+                                             std::string _chunk);
+
+  Engine* engine_;
+  const u32 threads_;
+  const u64 chunkSize_;
+};
+
+#endif  // PARSE_PARALLELPARSER_H_
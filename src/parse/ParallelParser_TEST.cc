@@ -0,0 +1,93 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelParser.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "parse/Engine.h"
+#include "parse/Reader.h"
+#include "parse/TestData_TEST.h"
+
+// runs the engine with a single-threaded or a parallel parser
+static std::vector<std::string> run(const std::string& _input, u32 _threads,
+                                    u64 _chunkSize,
+                                    const std::vector<std::string>& _filters) {
+  if (_threads == 1) {
+    return runEngine(_input, _filters, parseLog, 0.5);
+  }
+  return runEngine(
+      _input, _filters,
+      [&](const std::string& _log, Engine* _engine) {
+        Reader reader(_log);
+        ParallelParser parser(_engine, _threads, _chunkSize);
+        parser.parse(&reader);
+      },
+      0.5);
+}
+
+TEST(ParallelParser, matchesSingleThread) {
+  std::string input = writeLog("parallelparser.mpf", randomLog(2000, 64));
+  for (const std::vector<std::string>& filters :
+       {std::vector<std::string>(),
+        std::vector<std::string>({"+app=0", "-pc=1"}),
+        std::vector<std::string>({"+msgcnt=1-3", "-hc=2"})}) {
+    std::vector<std::string> expected = run(input, 1, 0, filters);
+    ASSERT_GT(expected.at(0).size(), 0u);
+    for (u32 threads : {2u, 3u, 8u}) {
+      for (u64 chunkSize : {1lu, 100lu, 4096lu, 1lu << 20}) {
+        ASSERT_EQ(expected, run(input, threads, chunkSize, filters));
+      }
+    }
+  }
+  std::remove(input.c_str());
+}
+
+TEST(ParallelParser, unfinishedMessage) {
+  std::string input = writeLog(
+      "parallelparser.mpf",
+      randomLog(100, 64) + "+T,5,1\n +M,0,1,2,5,0,0,0\n");
+  ASSERT_THROW(run(input, 4, 100, {}), ex::Exception);
+  std::remove(input.c_str());
+}
+
+TEST(ParallelParser, corrupted) {
+  std::string log = randomLog(100, 64);
+  log.insert(log.size() / 2, "  +P,0,1\n");
+  std::string input = writeLog("parallelparser.mpf", log);
+  ASSERT_ANY_THROW(run(input, 4, 100, {}));
+  std::remove(input.c_str());
+}
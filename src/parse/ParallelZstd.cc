@@ -0,0 +1,223 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelZstd.h"
+
+#include <ex/Exception.h>
+#include <zstd.h>
+
+// the seekable format stores its seek table in a skippable frame at the end
+const u32 SKIPPABLE_MAGIC = 0x184D2A5E;
+const u32 SEEKABLE_MAGIC = 0x8F92EAB1;
+const u64 SEEKABLE_FOOTER_SIZE = 9;
+
+static u32 readU32(const u8* _data) {
+  return static_cast<u32>(_data[0]) | static_cast<u32>(_data[1]) << 8 |
+         static_cast<u32>(_data[2]) << 16 | static_cast<u32>(_data[3]) << 24;
+}
+
+static bool isSkippable(const u8* _data, u64 _size) {
+  return _size >= 4 && (readU32(_data) & 0xFFFFFFF0) == 0x184D2A50;
+}
+
+ParallelZstd::ParallelZstd(const std::string& _filename, const u8* _data,
+                           u64 _size, u32 _threads, u64 _chunkSize)
+    : filename_(_filename),
+      data_(_data),
+      size_(_size),
+      threads_(_threads),
+      nextChunk_(0) {
+  if (!readSeekTable(data_, size_, &frames_)) {
+    frames_.clear();
+    walkFrames();
+  }
+
+  // group the frames into chunks of about _chunkSize decompressed bytes,
+  // unknown sizes are estimated from the compressed size
+  u64 chunkSize = 0;
+  for (u64 frame = 0; frame < frames_.size(); frame++) {
+    if (chunkSize == 0) {
+      chunks_.push_back(frame);
+    }
+    u64 contentSize = frames_[frame].contentSize;
+    chunkSize += (contentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+                     ? frames_[frame].size * 4
+                     : contentSize;
+    if (chunkSize >= _chunkSize) {
+      chunkSize = 0;
+    }
+  }
+  chunks_.push_back(frames_.size());
+}
+
+ParallelZstd::~ParallelZstd() {}
+
+bool ParallelZstd::multiFrame(const u8* _data, u64 _size) {
+  std::vector<Frame> frames;
+  if (readSeekTable(_data, _size, &frames)) {
+    return frames.size() > 1;
+  }
+  u64 pos = 0;
+  u64 count = 0;
+  while (pos < _size && count < 2) {
+    size_t size = ZSTD_findFrameCompressedSize(_data + pos, _size - pos);
+    if (ZSTD_isError(size)) {
+      return false;
+    }
+    if (!isSkippable(_data + pos, _size - pos)) {
+      count++;
+    }
+    pos += size;
+  }
+  return count > 1;
+}
+
+bool ParallelZstd::read(std::vector<char>* _buffer) {
+  if (nextChunk_ + 1 >= chunks_.size()) {
+    return false;
+  }
+
+  // keep all threads busy with upcoming chunks
+  u64 numChunks = chunks_.size() - 1;
+  while (pending_.size() < threads_ * 2 &&
+         nextChunk_ + pending_.size() < numChunks) {
+    u64 chunk = nextChunk_ + pending_.size();
+    pending_.push_back(std::async(
+        std::launch::async, [this, chunk] { return decodeChunk(chunk); }));
+  }
+
+  std::vector<char> output = pending_.front().get();
+  pending_.pop_front();
+  nextChunk_++;
+  _buffer->insert(_buffer->end(), output.begin(), output.end());
+  return true;
+}
+
+bool ParallelZstd::readSeekTable(const u8* _data, u64 _size,
+                                 std::vector<Frame>* _frames) {
+  // footer: number of frames, descriptor, magic
+  if (_size < SEEKABLE_FOOTER_SIZE + 8) {
+    return false;
+  }
+  const u8* footer = _data + _size - SEEKABLE_FOOTER_SIZE;
+  if (readU32(footer + 5) != SEEKABLE_MAGIC) {
+    return false;
+  }
+  u64 numFrames = readU32(footer);
+  bool checksums = (footer[4] & 0x80) != 0;
+  u64 entrySize = checksums ? 12 : 8;
+  u64 tableSize = numFrames * entrySize + SEEKABLE_FOOTER_SIZE;
+  if (tableSize + 8 > _size) {
+    return false;
+  }
+  const u8* header = _data + _size - tableSize - 8;
+  if (readU32(header) != SKIPPABLE_MAGIC || readU32(header + 4) != tableSize) {
+    return false;
+  }
+
+  // the entries describe consecutive frames from the start of the data
+  u64 offset = 0;
+  const u8* entry = header + 8;
+  for (u64 frame = 0; frame < numFrames; frame++) {
+    Frame f;
+    f.offset = offset;
+    f.size = readU32(entry);
+    f.contentSize = readU32(entry + 4);
+    _frames->push_back(f);
+    offset += f.size;
+    entry += entrySize;
+  }
+  return offset == _size - tableSize - 8;
+}
+
+void ParallelZstd::walkFrames() {
+  u64 pos = 0;
+  while (pos < size_) {
+    size_t size = ZSTD_findFrameCompressedSize(data_ + pos, size_ - pos);
+    if (ZSTD_isError(size)) {
+      throw ex::Exception("Input file is truncated or corrupted: %s (%s)\n",
+                          filename_.c_str(), ZSTD_getErrorName(size));
+    }
+    if (!isSkippable(data_ + pos, size_ - pos)) {
+      Frame f;
+      f.offset = pos;
+      f.size = size;
+      f.contentSize = ZSTD_getFrameContentSize(data_ + pos, size_ - pos);
+      if (f.contentSize == ZSTD_CONTENTSIZE_ERROR) {
+        f.contentSize = ZSTD_CONTENTSIZE_UNKNOWN;
+      }
+      frames_.push_back(f);
+    }
+    pos += size;
+  }
+}
+
+std::vector<char> ParallelZstd::decodeChunk(u64 _chunk) const {
+  const Frame& first = frames_[chunks_[_chunk]];
+  const Frame& last = frames_[chunks_[_chunk + 1] - 1];
+  ZSTD_inBuffer in = {data_ + first.offset,
+                      last.offset + last.size - first.offset, 0};
+
+  // start with the known sizes and grow when they aren't known
+  u64 expected = 0;
+  for (u64 frame = chunks_[_chunk]; frame < chunks_[_chunk + 1]; frame++) {
+    u64 contentSize = frames_[frame].contentSize;
+    expected += (contentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+                    ? frames_[frame].size * 4
+                    : contentSize;
+  }
+  std::vector<char> output(expected + 1);
+
+  ZSTD_DCtx* context = ZSTD_createDCtx();
+  u64 produced = 0;
+  size_t ret = 0;
+  while (true) {
+    if (produced == output.size()) {
+      output.resize(output.size() * 2);
+    }
+    ZSTD_outBuffer out = {output.data() + produced, output.size() - produced,
+                          0};
+    ret = ZSTD_decompressStream(context, &out, &in);
+    produced += out.pos;
+    if (ZSTD_isError(ret) || (in.pos == in.size && out.pos < out.size)) {
+      break;
+    }
+  }
+  ZSTD_freeDCtx(context);
+  if (ZSTD_isError(ret)) {
+    throw ex::Exception("Error while decompressing input file: %s (%s)\n",
+                        filename_.c_str(), ZSTD_getErrorName(ret));
+  }
+  if (ret != 0) {
+    throw ex::Exception("Input file is truncated: %s\n", filename_.c_str());
+  }
+  output.resize(produced);
+  return output;
+}
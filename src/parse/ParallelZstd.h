@@ -0,0 +1,85 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PARALLELZSTD_H_
+#define PARSE_PARALLELZSTD_H_
+
+#include <prim/prim.h>
+
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "parse/Codec.h"
+
+// This class decompresses zstd data held in memory using multiple threads.
+// Zstd frames are independent so the frames are grouped into chunks which are
+// decompressed in parallel and appended in order. The frames are found from
+// the seek table of the seekable format when there is one, otherwise by
+// walking the frame headers.
+class ParallelZstd : public Codec {
+ public:
+  // _chunkSize is the decompressed size that frames are grouped up to
+  ParallelZstd(const std::string& _filename, const u8* _data, u64 _size,
+               u32 _threads, u64 _chunkSize = 1 << 22);
+  ~ParallelZstd() override;
+
+  // returns true if the data holds more than one zstd frame
+  static bool multiFrame(const u8* _data, u64 _size);
+
+  bool read(std::vector<char>* _buffer) override;
+
+ private:
+  struct Frame {
+    u64 offset;
+    u64 size;
+    u64 contentSize;  // ZSTD_CONTENTSIZE_UNKNOWN if not known
+  };
+
+  static bool readSeekTable(const u8* _data, u64 _size,
+                            std::vector<Frame>* _frames);
+  void walkFrames();
+  std::vector<char> decodeChunk(u64 _chunk) const;
+
+  const std::string filename_;
+  const u8* data_;
+  const u64 size_;
+  const u32 threads_;
+
+  std::vector<Frame> frames_;
+  std::vector<u64> chunks_;  // first frame of each chunk, plus the end
+  u64 nextChunk_;
+
+  // chunks being decompressed in the background
+  std::deque<std::future<std::vector<char> > > pending_;
+};
+
+#endif  // PARSE_PARALLELZSTD_H_
@@ -0,0 +1,117 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ParallelZstd.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+#include <zstd.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/TestData_TEST.h"
+
+static void appendU32(std::string* _out, u32 _value) {
+  for (u32 byte = 0; byte < 4; byte++) {
+    _out->push_back(static_cast<char>(_value >> (byte * 8)));
+  }
+}
+
+// compresses _text as one zstd frame per _frameSize bytes, optionally followed
+// by the seek table of the seekable format
+static std::string compress(const std::string& _text, u64 _frameSize,
+                            bool _seekTable) {
+  std::string out;
+  std::string table;
+  u32 frames = 0;
+  for (u64 pos = 0; pos < _text.size(); pos += _frameSize) {
+    u64 size = std::min(_frameSize, _text.size() - pos);
+    std::string frame(ZSTD_compressBound(size), '\0');
+    size_t compressed = ZSTD_compress(frame.data(), frame.size(),
+                                      _text.data() + pos, size, 1);
+    EXPECT_FALSE(ZSTD_isError(compressed));
+    out.append(frame.data(), compressed);
+    appendU32(&table, compressed);
+    appendU32(&table, size);
+    frames++;
+  }
+  if (_seekTable) {
+    appendU32(&out, 0x184D2A5E);
+    appendU32(&out, table.size() + 9);
+    out += table;
+    appendU32(&out, frames);
+    out.push_back('\0');
+    appendU32(&out, 0x8F92EAB1);
+  }
+  return out;
+}
+
+static std::string decompress(const std::string& _data, u32 _threads,
+                              u64 _chunkSize) {
+  ParallelZstd codec("test", reinterpret_cast<const u8*>(_data.data()),
+                     _data.size(), _threads, _chunkSize);
+  std::vector<char> buffer;
+  while (codec.read(&buffer)) {}
+  return std::string(buffer.begin(), buffer.end());
+}
+
+TEST(ParallelZstd, multiFrame) {
+  std::string text = numberedText(10000);
+  auto multiFrame = [](const std::string& _data) {
+    return ParallelZstd::multiFrame(
+        reinterpret_cast<const u8*>(_data.data()), _data.size());
+  };
+  ASSERT_FALSE(multiFrame(compress(text, text.size(), false)));
+  ASSERT_FALSE(multiFrame(compress(text, text.size(), true)));
+  ASSERT_TRUE(multiFrame(compress(text, 10000, false)));
+  ASSERT_TRUE(multiFrame(compress(text, 10000, true)));
+}
+
+TEST(ParallelZstd, frames) {
+  std::string text = numberedText(10000);
+  for (bool seekTable : {false, true}) {
+    for (u64 frameSize : {1000lu, 65536lu, text.size()}) {
+      std::string compressed = compress(text, frameSize, seekTable);
+      for (u32 threads : {1u, 3u}) {
+        for (u64 chunkSize : {1lu, 100000lu, 1lu << 22}) {
+          ASSERT_EQ(decompress(compressed, threads, chunkSize), text);
+        }
+      }
+    }
+  }
+}
+
+TEST(ParallelZstd, truncated) {
+  std::string compressed = compress(numberedText(10000), 10000, false);
+  ASSERT_THROW(decompress(compressed.substr(0, compressed.size() / 2), 2, 1),
+               ex::Exception);
+}
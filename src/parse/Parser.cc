@@ -0,0 +1,230 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Parser.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "parse/util.h"
+
+// the most fields any record has (+M)
+const u64 MAX_WORDS = 8;
+
+// text is indexed in blocks of about this size
+const u64 INDEX_BLOCK_SIZE = 1 << 16;
+
+static bool isSpace(char _c) {
+  return _c == ' ' || _c == '\t' || _c == '\r' || _c == '\n' || _c == '\v' ||
+         _c == '\f';
+}
+
+static void checkWords(u64 _wordCount, u64 _required) {
+  if (_wordCount < _required) {
+    throw ex::Exception("Missing line fields. File corrupted :(\n");
+  }
+}
+
+static void checkNumbers(bool _ok) {
+  if (!_ok) {
+    throw ex::Exception("Invalid number field. File corrupted :(\n");
+  }
+}
+
+Parser::Parser(RecordHandler* _handler) : handler_(_handler) {}
+
+Parser::~Parser() {}
+
+void Parser::parse(Reader* _reader) {
+  std::string_view block;
+  while (_reader->nextBlock(&block)) {
+    parseBlock(block);
+  }
+}
+
+void Parser::parseBlock(std::string_view _text) {
+  while (!_text.empty()) {
+    // take whole lines up to about INDEX_BLOCK_SIZE
+    u64 size = std::min(_text.size(), INDEX_BLOCK_SIZE);
+    const char* last =
+        static_cast<const char*>(memrchr(_text.data(), '\n', size));
+    if (last == nullptr) {
+      last = static_cast<const char*>(
+          std::memchr(_text.data() + size, '\n', _text.size() - size));
+    }
+    if (last == nullptr) {
+      // the last line isn't newline terminated
+      parseLine(_text);
+      return;
+    }
+    std::string_view piece = _text.substr(0, last - _text.data() + 1);
+    _text.remove_prefix(piece.size());
+
+    // decode the fields directly from the delimiter offsets
+    indexer_.index(piece);
+    const std::vector<u32>& delimiters = indexer_.delimiters();
+    for (const Indexer::Line& line : indexer_.lines()) {
+      if (line.tag == 0) {
+        continue;  // blank line
+      }
+
+      // remove the line ending
+      u64 end = delimiters[line.last];
+      while (end > line.start && isSpace(piece[end - 1])) {
+        end--;
+      }
+
+      // the fields are separated by the commas before the end, a trailing
+      // empty field is dropped like split() does
+      std::string_view words[MAX_WORDS];
+      u64 wordCount = 0;
+      u64 pos = line.start;
+      for (u32 idx = line.first; idx < line.last; idx++) {
+        u64 comma = delimiters[idx];
+        if (wordCount < MAX_WORDS) {
+          words[wordCount] = piece.substr(pos, comma - pos);
+        }
+        wordCount++;
+        pos = comma + 1;
+      }
+      if (pos < end) {
+        if (wordCount < MAX_WORDS) {
+          words[wordCount] = piece.substr(pos, end - pos);
+        }
+        wordCount++;
+      }
+      decode(line.tag, words, wordCount);
+    }
+  }
+}
+
+void Parser::parseLine(std::string_view _line) {
+  // remove the indentation and line ending
+  u64 first = 0;
+  u64 last = _line.size();
+  while (first < last && isSpace(_line[first])) {
+    first++;
+  }
+  while (last > first && isSpace(_line[last - 1])) {
+    last--;
+  }
+  _line = _line.substr(first, last - first);
+
+  std::string_view words[MAX_WORDS];
+  u64 wordCount = split(_line, words, MAX_WORDS);
+  if (wordCount == 0) {
+    return;  // probably the last line
+  }
+  decode(recordTag(_line[0], _line.size() > 1 ? _line[1] : ','), words,
+         wordCount);
+}
+
+void Parser::decode(u16 _tag, const std::string_view* _words,
+                    u64 _wordCount) {
+  // the record type is determined by the first two bytes, the second byte of
+  // a flit record is the delimiter
+  if (_tag != recordTag('F', ',') && _words[0].size() != 2) {
+    throw ex::Exception("Invalid line command. File corrupted :(\n");
+  }
+  switch (_tag) {
+    case recordTag('F', ','): {
+      // parse the flit occurrence command
+      checkWords(_wordCount, 4);
+      u32 flitId;
+      u64 flitSend, flitRecv;
+      checkNumbers(parseU32(_words[1], &flitId) &
+                   parseU64(_words[2], &flitSend) &
+                   parseU64(_words[3], &flitRecv));
+      handler_->flit(flitId, flitSend, flitRecv);
+      break;
+    }
+
+    case recordTag('+', 'P'): {
+      // parse the packet start command
+      checkWords(_wordCount, 3);
+      u32 pktId, hopCount;
+      checkNumbers(parseU32(_words[1], &pktId) &
+                   parseU32(_words[2], &hopCount));
+      handler_->packetStart(pktId, hopCount);
+      break;
+    }
+
+    case recordTag('-', 'P'):
+      // parse the packet end command
+      handler_->packetEnd();
+      break;
+
+    case recordTag('+', 'M'): {
+      // parse the message start command
+      checkWords(_wordCount, 8);
+      u32 msgId, msgSrc, msgDst, protocolClass, minimalHops, opCode;
+      u64 transId;
+      checkNumbers(
+          parseU32(_words[1], &msgId) & parseU32(_words[2], &msgSrc) &
+          parseU32(_words[3], &msgDst) & parseU64(_words[4], &transId) &
+          parseU32(_words[5], &protocolClass) &
+          parseU32(_words[6], &minimalHops) & parseU32(_words[7], &opCode));
+      handler_->messageStart(msgId, msgSrc, msgDst, transId, protocolClass,
+                            minimalHops, opCode);
+      break;
+    }
+
+    case recordTag('-', 'M'):
+      // parse the message end command
+      handler_->messageEnd();
+      break;
+
+    case recordTag('+', 'T'): {
+      // parse the transaction start command
+      checkWords(_wordCount, 3);
+      u64 transId, transStart;
+      checkNumbers(parseU64(_words[1], &transId) &
+                   parseU64(_words[2], &transStart));
+      handler_->transactionStart(transId, transStart);
+      break;
+    }
+
+    case recordTag('-', 'T'): {
+      // parse the transaction end command
+      checkWords(_wordCount, 3);
+      u64 transId, transEnd;
+      checkNumbers(parseU64(_words[1], &transId) &
+                   parseU64(_words[2], &transEnd));
+      handler_->transactionEnd(transId, transEnd);
+      break;
+    }
+
+    default:
+      throw ex::Exception("Invalid line command. File corrupted :(\n");
+  }
+}
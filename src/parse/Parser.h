@@ -0,0 +1,65 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PARSER_H_
+#define PARSE_PARSER_H_
+
+#include <prim/prim.h>
+
+#include <string_view>
+
+#include "parse/Indexer.h"
+#include "parse/Reader.h"
+#include "parse/RecordHandler.h"
+
+// This class decodes the lines of a SuperSim message log (.mpf) and feeds
+// the records into a handler.
+class Parser {
+ public:
+  explicit Parser(RecordHandler* _handler);
+  ~Parser();
+
+  // feeds every line of the reader into the handler
+  void parse(Reader* _reader);
+
+  // decodes a block of whole lines and feeds them into the handler
+  void parseBlock(std::string_view _text);
+
+  // decodes a single line and feeds it into the handler
+  void parseLine(std::string_view _line);
+
+ private:
+  void decode(u16 _tag, const std::string_view* _words, u64 _wordCount);
+
+  RecordHandler* handler_;
+  Indexer indexer_;
+};
+
+#endif  // PARSE_PARSER_H_
@@ -0,0 +1,661 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Partial.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "parse/RecordWriter.h"
+#include "parse/Transient.h"
+
+/*** Hop counts ***/
+
+HopCounts::HopCounts()
+    : pktCount(0),
+      totalHops(0),
+      minHops(0),
+      nonMinHops(0),
+      hopCounts(100, 0),
+      minHopCounts(100, 0),
+      nonMinHopCounts(100, 0),
+      minPktCount(0),
+      nonMinPktCount(0) {}
+
+HopCounts::~HopCounts() {}
+
+void HopCounts::add(u32 _hopCount, u32 _minHopCount, u32 _nonMinHopCount) {
+  pktCount++;
+  totalHops += _hopCount;
+  minHops += _minHopCount;
+  nonMinHops += _nonMinHopCount;
+
+  hopCounts.at(_hopCount)++;
+  minHopCounts.at(_minHopCount)++;
+  nonMinHopCounts.at(_nonMinHopCount)++;
+
+  (_nonMinHopCount > 0) ? (nonMinPktCount++) : (minPktCount++);
+}
+
+void HopCounts::merge(const HopCounts& _other) {
+  pktCount += _other.pktCount;
+  totalHops += _other.totalHops;
+  minHops += _other.minHops;
+  nonMinHops += _other.nonMinHops;
+  for (u64 i = 0; i < hopCounts.size(); i++) {
+    hopCounts[i] += _other.hopCounts[i];
+    minHopCounts[i] += _other.minHopCounts[i];
+    nonMinHopCounts[i] += _other.nonMinHopCounts[i];
+  }
+  minPktCount += _other.minPktCount;
+  nonMinPktCount += _other.nonMinPktCount;
+}
+
+/*** Latency samples ***/
+
+LatencySamples::LatencySamples() : wide_(false) {}
+
+LatencySamples::~LatencySamples() {}
+
+void LatencySamples::add(u64 _ticks) {
+  if (!wide_ && _ticks > U32_MAX) {
+    widen();
+  }
+  if (wide_) {
+    wideSamples_.push_back(_ticks);
+  } else {
+    narrow_.push_back((u32)_ticks);
+  }
+}
+
+void LatencySamples::reserve(u64 _count) {
+  if (wide_) {
+    wideSamples_.reserve(_count);
+  } else {
+    narrow_.reserve(_count);
+  }
+}
+
+u64 LatencySamples::size() const {
+  return wide_ ? wideSamples_.size() : narrow_.size();
+}
+
+void LatencySamples::merge(LatencySamples* _other) {
+  if (_other->wide_ && !wide_) {
+    widen();
+  }
+  if (!wide_) {
+    narrow_.insert(narrow_.end(), _other->narrow_.begin(),
+                   _other->narrow_.end());
+  } else if (_other->wide_) {
+    wideSamples_.insert(wideSamples_.end(), _other->wideSamples_.begin(),
+                        _other->wideSamples_.end());
+  } else {
+    wideSamples_.insert(wideSamples_.end(), _other->narrow_.begin(),
+                        _other->narrow_.end());
+  }
+  *_other = LatencySamples();
+}
+
+bool LatencySamples::wide() const {
+  return wide_;
+}
+
+std::vector<u32>* LatencySamples::narrow() {
+  return &narrow_;
+}
+
+std::vector<u64>* LatencySamples::wideSamples() {
+  return &wideSamples_;
+}
+
+void LatencySamples::widen() {
+  wideSamples_.reserve(std::max(narrow_.capacity(), narrow_.size() + 1));
+  wideSamples_.assign(narrow_.begin(), narrow_.end());
+  narrow_ = std::vector<u32>();
+  wide_ = true;
+}
+
+/*** State machine classes ***/
+
+Partial::MsgFsm::MsgFsm() {
+  reset();
+}
+
+Partial::MsgFsm::~MsgFsm() {}
+
+void Partial::MsgFsm::reset() {
+  enabled = false;
+  start = U64_MAX;
+  end = 0;
+  transId = U64_MAX;
+  pktCount = 0;
+  flitCount = 0;
+  minHopCount = 0;
+}
+
+Partial::PktFsm::PktFsm() {
+  reset();
+}
+
+Partial::PktFsm::~PktFsm() {}
+
+void Partial::PktFsm::reset() {
+  enabled = false;
+  headStart = U64_MAX;
+  headEnd = 0;
+  tailEnd = 0;
+  flitCount = 0;
+  nonMinHopCount = 0;
+}
+
+/*** Partial class ***/
+
+// returns true if any query counts the flits of each time bin
+static bool keepFlitTimes(const std::vector<Partial::Outputs>& _outputs) {
+  for (const Partial::Outputs& outputs : _outputs) {
+    if (outputs.throughputBinWidth > 0.0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Partial::Partial(f64 _scalar, bool _packetHeaderLatency,
+                 const FilterChains& _chains,
+                 const std::vector<Outputs>& _outputs)
+    : scalar_(_scalar),
+      packetHeaderLatency_(_packetHeaderLatency),
+      chains_(_chains),
+      outputs_(_outputs),
+      aggregates_(_outputs.size()),
+      msgBatch_(BATCH_SIZE),
+      pktBatch_(BATCH_SIZE),
+      msgTicks_(BATCH_SIZE),
+      pktTicks_(BATCH_SIZE),
+      msgIds_(BATCH_SIZE),
+      pktMsgIds_(BATCH_SIZE),
+      pktIds_(BATCH_SIZE),
+      keepFlitTimes_(keepFlitTimes(_outputs)) {
+  chains_.clearStats();
+  for (u32 query = 0; query < outputs_.size(); query++) {
+    aggregates_[query].msgTable = RecordTable(Filter::Level::MESSAGE);
+    aggregates_[query].pktTable = RecordTable(Filter::Level::PACKET);
+    if (outputs_[query].latencySketch > 0.0) {
+      aggregates_[query].msgSketch =
+          QuantileSketch(outputs_[query].latencySketch);
+      aggregates_[query].pktSketch =
+          QuantileSketch(outputs_[query].latencySketch);
+    }
+    if (outputs_[query].transient) {
+      aggregates_[query].transientBins = std::make_shared<TransientBins>(
+          outputs_[query].transient->bins(outputs_[query].latencySketch));
+    }
+    if (outputs_[query].throughputBinWidth > 0.0) {
+      aggregates_[query].throughput =
+          Throughput(outputs_[query].throughputBinWidth,
+                     outputs_[query].throughputGrouping);
+    }
+  }
+}
+
+Partial::~Partial() {}
+
+void Partial::transactionStart(u64 _transId, u64 _transStart) {
+  Event event;
+  event.type = Event::Type::TRANSACTION_START;
+  event.transId = _transId;
+  event.time = _transStart;
+  events_.push_back(event);
+}
+
+void Partial::transactionEnd(u64 _transId, u64 _transEnd) {
+  Event event;
+  event.type = Event::Type::TRANSACTION_END;
+  event.transId = _transId;
+  event.time = _transEnd;
+  events_.push_back(event);
+}
+
+void Partial::messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                           u32 _protocolClass, u32 _minHopCount,
+                           u32 _opCode) {
+  if (msgFsm_.enabled == true) {
+    throw ex::Exception("Two '+M's without '-M'. File corrupted :(\n");
+  }
+  msgFsm_.enabled = true;
+  msgFsm_.id = _msgId;
+  msgFsm_.src = _msgSrc;
+  msgFsm_.dst = _msgDst;
+  msgFsm_.transId = _transId;
+  msgFsm_.protocolClass = _protocolClass;
+  msgFsm_.minHopCount = _minHopCount;
+  msgFsm_.opCode = _opCode;
+}
+
+void Partial::messageEnd() {
+  if (msgFsm_.enabled == false) {
+    throw ex::Exception("Missing '+M'. File corrupted :(\n");
+  }
+  if (msgFsm_.pktCount == 0) {
+    throw ex::Exception("Message without packets. File corrupted :(\n");
+  }
+
+  // the message is filtered with its batch
+  Filter::Record record = {};
+  Filter::messageRecord(msgFsm_.src, msgFsm_.dst, msgFsm_.transId,
+                        msgFsm_.protocolClass, msgFsm_.opCode,
+                        msgFsm_.start * scalar_, msgFsm_.end * scalar_,
+                        msgFsm_.pktCount, msgFsm_.flitCount,
+                        msgFsm_.minHopCount, &record);
+  msgTicks_[msgBatch_.size] = msgFsm_.end - msgFsm_.start;
+  msgIds_[msgBatch_.size] = msgFsm_.id;
+  if (msgBatch_.add(record)) {
+    flushMessages();
+  }
+
+  // the contribution of this message to its transaction
+  Event event;
+  event.type = Event::Type::MESSAGE;
+  event.transId = msgFsm_.transId;
+  event.start = msgFsm_.start;
+  event.end = msgFsm_.end;
+  event.pktCount = msgFsm_.pktCount;
+  event.flitCount = msgFsm_.flitCount;
+  events_.push_back(event);
+
+  // reset the state machine
+  msgFsm_.reset();
+}
+
+void Partial::packetStart(u32 _pktId, u32 _pktHopCount) {
+  if (msgFsm_.enabled == false) {
+    throw ex::Exception("Missing '+M'. File corrupted :(\n");
+  }
+  if (pktFsm_.enabled == true) {
+    throw ex::Exception("Two '+P's without '-S'. File corrupted :(\n");
+  }
+  pktFsm_.enabled = true;
+  pktFsm_.id = _pktId;
+  pktFsm_.hopCount = _pktHopCount;
+  if (_pktHopCount >= msgFsm_.minHopCount) {
+    pktFsm_.nonMinHopCount = _pktHopCount - msgFsm_.minHopCount;
+  } else {
+    pktFsm_.nonMinHopCount = 0;
+  }
+
+  // count this packet in the message
+  msgFsm_.pktCount++;
+}
+
+void Partial::packetEnd() {
+  if (msgFsm_.enabled == false) {
+    throw ex::Exception("Missing '+M'. File corrupted :(\n");
+  }
+  if (pktFsm_.enabled == false) {
+    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+  }
+  if (pktFsm_.flitCount == 0) {
+    throw ex::Exception("Packet without flits. File corrupted :(\n");
+  }
+
+  // determine the right packet end time
+  u64 pktEnd = packetHeaderLatency_ ? pktFsm_.headEnd : pktFsm_.tailEnd;
+
+  // the packet is filtered with its batch
+  Filter::Record record = {};
+  Filter::packetRecord(msgFsm_.src, msgFsm_.dst, msgFsm_.transId,
+                       msgFsm_.protocolClass, msgFsm_.opCode,
+                       pktFsm_.headStart * scalar_, pktEnd * scalar_,
+                       pktFsm_.flitCount, pktFsm_.hopCount,
+                       msgFsm_.minHopCount, pktFsm_.nonMinHopCount, &record);
+  pktTicks_[pktBatch_.size] = pktEnd - pktFsm_.headStart;
+  pktMsgIds_[pktBatch_.size] = msgFsm_.id;
+  pktIds_[pktBatch_.size] = pktFsm_.id;
+  if (pktBatch_.add(record)) {
+    flushPackets();
+  }
+
+  // update the message times
+  if (pktFsm_.headStart < msgFsm_.start) {
+    msgFsm_.start = pktFsm_.headStart;
+  }
+  if (pktFsm_.tailEnd > msgFsm_.end) {
+    msgFsm_.end = pktFsm_.tailEnd;
+  }
+
+  // reset the state machine
+  pktFsm_.reset();
+}
+
+void Partial::flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) {
+  if (pktFsm_.enabled == false) {
+    throw ex::Exception("Missing '+P'. File corrupted :(\n");
+  }
+
+  // count this flit in the message and packet
+  msgFsm_.flitCount++;
+  pktFsm_.flitCount++;
+
+  // times stay unscaled until they are reported
+  if (_flitSendTime > _flitReceiveTime) {
+    throw ex::Exception(
+        "Flit received before it was sent? "
+        "File corrupted :(\n");
+  }
+
+  // update th packet times
+  if (_flitId == 0) {
+    pktFsm_.headStart = _flitSendTime;
+    pktFsm_.headEnd = _flitReceiveTime;
+  } else {
+    // flit 0 should always be earliest
+    assert(_flitSendTime >= pktFsm_.headStart);
+  }
+  if (_flitReceiveTime > pktFsm_.tailEnd) {
+    pktFsm_.tailEnd = _flitReceiveTime;
+  }
+
+  // flits are binned with their packet
+  if (keepFlitTimes_) {
+    flitTimes_.push_back(_flitReceiveTime);
+  }
+}
+
+bool Partial::idle() const {
+  return (msgFsm_.enabled == false) && (pktFsm_.enabled == false);
+}
+
+void Partial::flush() {
+  flushMessages();
+  flushPackets();
+}
+
+const std::vector<Partial::Event>& Partial::events() const {
+  return events_;
+}
+
+const std::string& Partial::messageRecords(u32 _query) const {
+  return aggregates_.at(_query).msgRecords;
+}
+
+const std::string& Partial::packetRecords(u32 _query) const {
+  return aggregates_.at(_query).pktRecords;
+}
+
+const RecordTable& Partial::messageTable(u32 _query) const {
+  return aggregates_.at(_query).msgTable;
+}
+
+const RecordTable& Partial::packetTable(u32 _query) const {
+  return aggregates_.at(_query).pktTable;
+}
+
+void Partial::clearEvents() {
+  events_.clear();
+  for (Aggregates& aggregates : aggregates_) {
+    aggregates.msgRecords.clear();
+    aggregates.pktRecords.clear();
+    aggregates.msgTable.clear();
+    aggregates.pktTable.clear();
+  }
+}
+
+LatencySamples* Partial::messageLatencies(u32 _query) {
+  return &aggregates_.at(_query).msgLatencies;
+}
+
+LatencySamples* Partial::packetLatencies(u32 _query) {
+  return &aggregates_.at(_query).pktLatencies;
+}
+
+const QuantileSketch& Partial::messageSketch(u32 _query) const {
+  return aggregates_.at(_query).msgSketch;
+}
+
+const QuantileSketch& Partial::packetSketch(u32 _query) const {
+  return aggregates_.at(_query).pktSketch;
+}
+
+const HopCounts& Partial::hopCounts(u32 _query) const {
+  return aggregates_.at(_query).hops;
+}
+
+const TrafficMatrix& Partial::trafficMatrix(u32 _query) const {
+  return aggregates_.at(_query).matrix;
+}
+
+const Throughput& Partial::throughput(u32 _query) const {
+  return aggregates_.at(_query).throughput;
+}
+
+TransientBins* Partial::transientBins(u32 _query) {
+  return aggregates_.at(_query).transientBins.get();
+}
+
+void Partial::reserve(u64 _count) {
+  for (u32 query = 0; query < outputs_.size(); query++) {
+    if (outputs_[query].latencies && outputs_[query].latencySketch <= 0.0) {
+      aggregates_[query].msgLatencies.reserve(_count);
+      aggregates_[query].pktLatencies.reserve(_count);
+    }
+  }
+}
+
+const FilterChains& Partial::filterChains() const {
+  return chains_;
+}
+
+void Partial::merge(Partial* _other) {
+  assert(msgBatch_.size == 0 && pktBatch_.size == 0);
+  assert(_other->msgBatch_.size == 0 && _other->pktBatch_.size == 0);
+  chains_.mergeStats(_other->chains_);
+  _other->chains_.clearStats();
+  for (u32 query = 0; query < aggregates_.size(); query++) {
+    Aggregates& to = aggregates_[query];
+    Aggregates& from = _other->aggregates_[query];
+    to.msgLatencies.merge(&from.msgLatencies);
+    to.pktLatencies.merge(&from.pktLatencies);
+    to.msgSketch.merge(from.msgSketch);
+    to.pktSketch.merge(from.pktSketch);
+    to.hops.merge(from.hops);
+    to.matrix.merge(from.matrix);
+    to.throughput.merge(from.throughput);
+    if (to.transientBins) {
+      to.transientBins->merge(from.transientBins.get());
+    }
+    from.msgSketch.clear();
+    from.pktSketch.clear();
+    from.hops = HopCounts();
+    from.matrix.clear();
+    from.throughput.clear();
+  }
+}
+
+void Partial::flushMessages() {
+  // determine which queries log each message
+  u32 rows = msgBatch_.size;
+  accepted_.resize(rows);
+  chains_.evaluate(Filter::Level::MESSAGE, msgBatch_, accepted_.data());
+  const f64* start = msgBatch_.times[0].data();
+  const f64* end = msgBatch_.times[1].data();
+  const u64* minHopCount = msgBatch_.ints[Filter::MIN_HOP_COUNT].data();
+  const u64* src = msgBatch_.ints[Filter::SOURCE_ID].data();
+  const u64* dst = msgBatch_.ints[Filter::DESTINATION_ID].data();
+  const u64* app = msgBatch_.ints[Filter::APPLICATION_ID].data();
+
+  // save the message latencies
+  for (u32 row = 0; row < rows; row++) {
+    // the record text of the first query is copied for the others
+    const std::string* line = nullptr;
+    u64 lineStart = 0;
+    bool lineFixed = false;
+    for (u64 mask = accepted_[row]; mask != 0; mask &= mask - 1) {
+      u32 query = __builtin_ctzll(mask);
+      const Outputs& outputs = outputs_[query];
+      Aggregates& aggregates = aggregates_[query];
+      if (outputs.latencies) {
+        if (outputs.latencySketch > 0.0) {
+          aggregates.msgSketch.add(msgTicks_[row] * scalar_);
+        } else {
+          aggregates.msgLatencies.add(msgTicks_[row]);
+        }
+      }
+      if (outputs.trafficMatrix) {
+        aggregates.matrix.addMessage(src[row], dst[row],
+                                     msgTicks_[row] * scalar_);
+      }
+      if (outputs.throughputBinWidth > 0.0) {
+        u64 group =
+            (outputs.throughputGrouping == Throughput::Grouping::DESTINATION)
+                ? dst[row]
+                : app[row];
+        aggregates.throughput.add(Throughput::MESSAGES, group, end[row]);
+      }
+      if (outputs.messageRecords) {
+        std::string& records = aggregates.msgRecords;
+        if (line != nullptr && lineFixed == outputs.fixedTimes) {
+          records.append(*line, lineStart, std::string::npos);
+        } else {
+          line = &records;
+          lineStart = records.size();
+          lineFixed = outputs.fixedTimes;
+          appendTime(start[row], outputs.fixedTimes, &records);
+          records += ',';
+          appendTime(end[row], outputs.fixedTimes, &records);
+          records += ',';
+          appendU64(minHopCount[row], &records);
+          records += '\n';
+        }
+      }
+      if (outputs.messageTable) {
+        aggregates.msgTable.add(msgBatch_, row, msgIds_[row], 0);
+      }
+    }
+  }
+  msgBatch_.size = 0;
+}
+
+void Partial::flushPackets() {
+  // determine which queries log each packet
+  u32 rows = pktBatch_.size;
+  accepted_.resize(rows);
+  chains_.evaluate(Filter::Level::PACKET, pktBatch_, accepted_.data());
+  const f64* start = pktBatch_.times[0].data();
+  const f64* end = pktBatch_.times[1].data();
+  const u64* hopCount = pktBatch_.ints[Filter::HOP_COUNT].data();
+  const u64* minHopCount = pktBatch_.ints[Filter::MIN_HOP_COUNT].data();
+  const u64* nonMinHopCount = pktBatch_.ints[Filter::NON_MIN_HOP_COUNT].data();
+  const u64* src = pktBatch_.ints[Filter::SOURCE_ID].data();
+  const u64* dst = pktBatch_.ints[Filter::DESTINATION_ID].data();
+  const u64* flitCount = pktBatch_.ints[Filter::FLIT_COUNT].data();
+  const u64* app = pktBatch_.ints[Filter::APPLICATION_ID].data();
+  const u64* flitTime = flitTimes_.data();
+
+  // save the packet latencies
+  for (u32 row = 0; row < rows; row++) {
+    // the record text of the first query is copied for the others
+    const std::string* line = nullptr;
+    u64 lineStart = 0;
+    bool lineFixed = false;
+    for (u64 mask = accepted_[row]; mask != 0; mask &= mask - 1) {
+      u32 query = __builtin_ctzll(mask);
+      const Outputs& outputs = outputs_[query];
+      Aggregates& aggregates = aggregates_[query];
+      if (outputs.latencies) {
+        if (outputs.latencySketch > 0.0) {
+          aggregates.pktSketch.add(pktTicks_[row] * scalar_);
+        } else {
+          aggregates.pktLatencies.add(pktTicks_[row]);
+        }
+      }
+      if (outputs.hopCounts) {
+        aggregates.hops.add(hopCount[row], minHopCount[row],
+                            nonMinHopCount[row]);
+      }
+      if (outputs.trafficMatrix) {
+        aggregates.matrix.addPacket(src[row], dst[row], flitCount[row],
+                                    pktTicks_[row] * scalar_);
+      }
+      if (outputs.throughputBinWidth > 0.0) {
+        u64 group =
+            (outputs.throughputGrouping == Throughput::Grouping::DESTINATION)
+                ? dst[row]
+                : app[row];
+        Throughput& throughput = aggregates.throughput;
+        throughput.add(Throughput::PACKETS, group, end[row]);
+        for (u64 flit = 0; flit < flitCount[row]; flit++) {
+          throughput.add(Throughput::FLITS, group, flitTime[flit] * scalar_);
+        }
+      }
+      if (outputs.packetRecords) {
+        std::string& records = aggregates.pktRecords;
+        if (line != nullptr && lineFixed == outputs.fixedTimes) {
+          records.append(*line, lineStart, std::string::npos);
+        } else {
+          line = &records;
+          lineStart = records.size();
+          lineFixed = outputs.fixedTimes;
+          appendTime(start[row], outputs.fixedTimes, &records);
+          records += ',';
+          appendTime(end[row], outputs.fixedTimes, &records);
+          records += ',';
+          appendU64(hopCount[row], &records);
+          records += ',';
+          appendU64(minHopCount[row], &records);
+          records += ',';
+          appendU64(nonMinHopCount[row], &records);
+          records += '\n';
+        }
+      }
+      if (outputs.packetTable) {
+        aggregates.pktTable.add(pktBatch_, row, pktMsgIds_[row], pktIds_[row]);
+      }
+      if (outputs.transient) {
+        PacketSample sample = {start[row], end[row], (u32)hopCount[row],
+                               (u32)minHopCount[row],
+                               (u32)nonMinHopCount[row]};
+        aggregates.transientBins->add(sample);
+      }
+    }
+    if (keepFlitTimes_) {
+      flitTime += flitCount[row];
+    }
+  }
+
+  // the flits of an open packet stay for its batch
+  if (keepFlitTimes_) {
+    flitTimes_.erase(flitTimes_.begin(),
+                     flitTimes_.begin() + (flitTime - flitTimes_.data()));
+  }
+  pktBatch_.size = 0;
+}
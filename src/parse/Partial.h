@@ -0,0 +1,287 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PARTIAL_H_
+#define PARSE_PARTIAL_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parse/FilterChains.h"
+#include "parse/QuantileSketch.h"
+#include "parse/RecordHandler.h"
+#include "parse/RecordTable.h"
+#include "parse/Throughput.h"
+#include "parse/TrafficMatrix.h"
+
+class Transient;
+class TransientBins;
+
+// packet hop count histograms for aggregate computations
+struct HopCounts {
+  HopCounts();
+  ~HopCounts();
+
+  void add(u32 _hopCount, u32 _minHopCount, u32 _nonMinHopCount);
+  void merge(const HopCounts& _other);
+
+  u64 pktCount;
+  u64 totalHops;
+  u64 minHops;
+  u64 nonMinHops;
+  std::vector<u64> hopCounts;        // [hopcount]
+  std::vector<u64> minHopCounts;     // [minhopcount]
+  std::vector<u64> nonMinHopCounts;  // [nonminhopcount]
+
+  // packet counts
+  u64 minPktCount;
+  u64 nonMinPktCount;
+};
+
+// latency samples in simulator ticks, they are stored in 32 bits until a
+// sample needs more
+class LatencySamples {
+ public:
+  LatencySamples();
+  ~LatencySamples();
+
+  void add(u64 _ticks);
+  void reserve(u64 _count);
+  u64 size() const;
+
+  // moves the samples of _other to the end of these
+  void merge(LatencySamples* _other);
+
+  // the storage in use, the other one is empty
+  bool wide() const;
+  std::vector<u32>* narrow();
+  std::vector<u64>* wideSamples();
+
+ private:
+  void widen();
+
+  bool wide_;
+  std::vector<u32> narrow_;
+  std::vector<u64> wideSamples_;
+};
+
+// the times and hop counts of a logged packet for time-binned aggregates
+struct PacketSample {
+  f64 start;  // scaled
+  f64 end;
+  u32 hopCount;
+  u32 minHopCount;
+  u32 nonMinHopCount;
+};
+
+// This class processes the message blocks ('+M' ... '-M') of a message log.
+// A message block only contributes a few counters to its transaction, so any
+// range of message blocks can be processed on its own. Transaction records
+// aren't resolved here, they are kept as events in file order together with
+// the contribution of each message, and resolved when the engine merges the
+// partial results in order. Completed messages and packets are gathered into
+// column batches, each batch is filtered at once and its records are routed to
+// the aggregates of the queries whose filter chain accepts them.
+class Partial : public RecordHandler {
+ public:
+  // what is collected for a query
+  struct Outputs {
+    bool messageRecords;
+    bool packetRecords;
+    bool fixedTimes;  // see Query
+    bool messageTable;
+    bool packetTable;
+    bool latencies;
+    f64 latencySketch;  // relative error, 0 keeps every latency
+    bool hopCounts;
+    std::shared_ptr<const Transient> transient;
+    bool trafficMatrix;
+    f64 throughputBinWidth;  // 0 without a throughput
+    Throughput::Grouping throughputGrouping;
+  };
+
+  // the chains are copied with their order but without their counts
+  Partial(f64 _scalar, bool _packetHeaderLatency, const FilterChains& _chains,
+          const std::vector<Outputs>& _outputs);
+  ~Partial() override;
+
+  void transactionStart(u64 _transId, u64 _transStart) override;
+  void transactionEnd(u64 _transId, u64 _transEnd) override;
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override;
+  void messageEnd() override;
+  void packetStart(u32 _pktId, u32 _pktHopCount) override;
+  void packetEnd() override;
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override;
+
+  // a change to the transaction state
+  struct Event {
+    enum class Type { TRANSACTION_START, TRANSACTION_END, MESSAGE };
+    Type type;
+    u64 transId;
+    u64 time;   // transaction start or end (unscaled)
+    u64 start;  // message times (unscaled)
+    u64 end;
+    u32 pktCount;
+    u32 flitCount;
+  };
+
+  // the number of records in a message or packet batch
+  static const u32 BATCH_SIZE = 512;
+
+  // returns true if no message or packet is open
+  bool idle() const;
+
+  // filters and aggregates the pending message and packet batches
+  void flush();
+
+  // transaction events and output records since the last clearEvents() and
+  // flush()
+  const std::vector<Event>& events() const;
+  const std::string& messageRecords(u32 _query) const;
+  const std::string& packetRecords(u32 _query) const;
+  const RecordTable& messageTable(u32 _query) const;
+  const RecordTable& packetTable(u32 _query) const;
+  void clearEvents();
+
+  // aggregate state
+  LatencySamples* messageLatencies(u32 _query);
+  LatencySamples* packetLatencies(u32 _query);
+  const QuantileSketch& messageSketch(u32 _query) const;
+  const QuantileSketch& packetSketch(u32 _query) const;
+  const HopCounts& hopCounts(u32 _query) const;
+  TransientBins* transientBins(u32 _query);
+  const TrafficMatrix& trafficMatrix(u32 _query) const;
+  const Throughput& throughput(u32 _query) const;
+
+  // sizes the latency storage of the queries for about _count records
+  void reserve(u64 _count);
+
+  // the message and packet filter evaluations
+  const FilterChains& filterChains() const;
+
+  // moves the aggregate state of _other into this one, both must be flushed
+  void merge(Partial* _other);
+
+ private:
+  void flushMessages();
+  void flushPackets();
+
+  const f64 scalar_;
+  const bool packetHeaderLatency_;
+  FilterChains chains_;
+  const std::vector<Outputs> outputs_;
+
+  std::vector<Event> events_;
+
+  // the records and aggregates of a query
+  struct Aggregates {
+    std::string msgRecords;
+    std::string pktRecords;
+    RecordTable msgTable;
+    RecordTable pktTable;
+
+    // latency vectors for aggregate computations
+    //  holds each latency sample
+    LatencySamples msgLatencies;
+    LatencySamples pktLatencies;
+
+    // or summarizes them when sketching
+    QuantileSketch msgSketch;
+    QuantileSketch pktSketch;
+
+    HopCounts hops;
+    // packets of a transient, binned as they complete
+    std::shared_ptr<TransientBins> transientBins;
+    TrafficMatrix matrix;
+    Throughput throughput;
+  };
+  std::vector<Aggregates> aggregates_;
+
+  // completed records waiting to be filtered, their unscaled latencies and
+  // their ids
+  Filter::Columns msgBatch_;
+  Filter::Columns pktBatch_;
+  std::vector<u64> msgTicks_;
+  std::vector<u64> pktTicks_;
+  std::vector<u32> msgIds_;
+  std::vector<u32> pktMsgIds_;
+  std::vector<u32> pktIds_;
+  std::vector<u64> accepted_;  // [row] -> chain mask
+
+  // the unscaled receive times of the flits of the batched packets and the
+  // open packet, only kept for throughputs
+  const bool keepFlitTimes_;
+  std::vector<u64> flitTimes_;
+
+  // message state machine
+  struct MsgFsm {
+    MsgFsm();
+    ~MsgFsm();
+    void reset();
+
+    bool enabled;
+    u32 id;
+    u64 start;  // unscaled
+    u64 end;
+    u32 src;
+    u32 dst;
+    u64 transId;
+    u32 protocolClass;
+    u32 pktCount;
+    u32 flitCount;
+    u32 minHopCount;
+    u32 opCode;
+  };
+  MsgFsm msgFsm_;
+
+  // packet state machine
+  struct PktFsm {
+    PktFsm();
+    ~PktFsm();
+    void reset();
+
+    bool enabled;
+    u32 id;
+    u64 headStart;  // unscaled
+    u64 headEnd;
+    u64 tailEnd;
+    u32 hopCount;
+    u32 flitCount;
+    u32 nonMinHopCount;
+  };
+  PktFsm pktFsm_;
+};
+
+#endif  // PARSE_PARTIAL_H_
@@ -0,0 +1,144 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "parse/Parser.h"
+
+Pipeline::Pipeline(RecordHandler* _handler, u64 _chunkSize, u64 _depth)
+    : handler_(_handler), chunkSize_(_chunkSize), depth_(_depth) {}
+
+Pipeline::~Pipeline() {}
+
+void Pipeline::parse(Reader* _reader) {
+  SpscRing<std::string> chunks(depth_);
+  SpscRing<std::unique_ptr<RecordBatch> > batches(depth_);
+
+  // the first error of each stage
+  std::exception_ptr readError;
+  std::exception_ptr decodeError;
+  std::exception_ptr handleError;
+
+  std::thread reader([&]() {
+    try {
+      readStage(_reader, &chunks);
+    } catch (...) {
+      readError = std::current_exception();
+    }
+    chunks.close();
+  });
+  std::thread decoder([&]() {
+    try {
+      decodeStage(&chunks, &batches);
+    } catch (...) {
+      decodeError = std::current_exception();
+    }
+    chunks.close();
+    batches.close();
+  });
+
+  try {
+    std::unique_ptr<RecordBatch> batch;
+    while (batches.pop(&batch)) {
+      batch->replay(handler_);
+    }
+  } catch (...) {
+    handleError = std::current_exception();
+    batches.close();
+  }
+  reader.join();
+  decoder.join();
+
+  // report the error that is first in file order, each stage only sees data
+  // that the earlier stages have handled
+  if (handleError) {
+    std::rethrow_exception(handleError);
+  }
+  if (decodeError) {
+    std::rethrow_exception(decodeError);
+  }
+  if (readError) {
+    std::rethrow_exception(readError);
+  }
+}
+
+void Pipeline::readStage(Reader* _reader, SpscRing<std::string>* _chunks) {
+  std::string chunk;
+  chunk.reserve(chunkSize_ + 4096);
+  std::string_view block;
+  while (_reader->nextBlock(&block)) {
+    while (!block.empty()) {
+      // fill the chunk up with whole lines
+      u64 take = block.size();
+      u64 want = chunkSize_ - std::min(chunkSize_, chunk.size());
+      if (want < block.size()) {
+        const char* nl = static_cast<const char*>(
+            std::memchr(block.data() + want, '\n', block.size() - want));
+        if (nl != nullptr) {
+          take = nl + 1 - block.data();
+        }
+      }
+      chunk.append(block.data(), take);
+      block.remove_prefix(take);
+
+      if (chunk.size() >= chunkSize_) {
+        if (!_chunks->push(std::move(chunk))) {
+          return;  // a later stage stopped
+        }
+        chunk = std::string();
+        chunk.reserve(chunkSize_ + 4096);
+      }
+    }
+  }
+  if (!chunk.empty()) {
+    _chunks->push(std::move(chunk));
+  }
+}
+
+void Pipeline::decodeStage(
+    SpscRing<std::string>* _chunks,
+    SpscRing<std::unique_ptr<RecordBatch> >* _batches) {
+  std::string chunk;
+  while (_chunks->pop(&chunk)) {
+    std::unique_ptr<RecordBatch> batch = std::make_unique<RecordBatch>();
+    Parser parser(batch.get());
+    parser.parseBlock(chunk);
+    if (!_batches->push(std::move(batch))) {
+      return;  // a later stage stopped
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_PIPELINE_H_
+#define PARSE_PIPELINE_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+
+#include "parse/Reader.h"
+#include "parse/RecordBatch.h"
+#include "parse/RecordHandler.h"
+#include "parse/SpscRing.h"
+
+// This class parses a message log in three pipelined stages: reading and
+// decompressing into chunks of whole lines, decoding the lines into record
+// batches, and feeding the records into the handler. The first two stages run
+// on their own threads, the last one on the calling thread, and they are
+// connected by SPSC rings. The handler sees the same calls in the same order
+// as with the Parser.
+class Pipeline {
+ public:
+  Pipeline(RecordHandler* _handler, u64 _chunkSize = 1 << 18,
+           u64 _depth = 8);
+  ~Pipeline();
+
+  // feeds every line of the reader into the handler
+  void parse(Reader* _reader);
+
+ private:
+  void readStage(Reader* _reader, SpscRing<std::string>* _chunks);
+  void decodeStage(SpscRing<std::string>* _chunks,
+                   SpscRing<std::unique_ptr<RecordBatch> >* _batches);
+
+  RecordHandler* handler_;
+  const u64 chunkSize_;
+  const u64 depth_;
+};
+
+#endif  // PARSE_PIPELINE_H_
@@ -0,0 +1,130 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Pipeline.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+
+#include "parse/Parser.h"
+#include "parse/Reader.h"
+#include "parse/RecordHandler.h"
+#include "parse/TestData_TEST.h"
+
+namespace {
+
+// records every call as text
+class Recorder : public RecordHandler {
+ public:
+  void transactionStart(u64 _transId, u64 _transStart) override {
+    text += "+T" + std::to_string(_transId) + "," +
+            std::to_string(_transStart) + "\n";
+  }
+  void transactionEnd(u64 _transId, u64 _transEnd) override {
+    text += "-T" + std::to_string(_transId) + "," +
+            std::to_string(_transEnd) + "\n";
+  }
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override {
+    text += "+M" + std::to_string(_msgId) + "," + std::to_string(_msgSrc) +
+            "," + std::to_string(_msgDst) + "," + std::to_string(_transId) +
+            "," + std::to_string(_protocolClass) + "," +
+            std::to_string(_minHopCount) + "," + std::to_string(_opCode) +
+            "\n";
+  }
+  void messageEnd() override {
+    text += "-M\n";
+  }
+  void packetStart(u32 _pktId, u32 _pktHopCount) override {
+    text += "+P" + std::to_string(_pktId) + "," +
+            std::to_string(_pktHopCount) + "\n";
+  }
+  void packetEnd() override {
+    text += "-P\n";
+  }
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override {
+    text += "F" + std::to_string(_flitId) + "," +
+            std::to_string(_flitSendTime) + "," +
+            std::to_string(_flitReceiveTime) + "\n";
+    if (failAt > 0 && --failAt == 0) {
+      throw ex::Exception("handler failed\n");
+    }
+  }
+
+  std::string text;
+  u64 failAt = 0;
+};
+
+}  // namespace
+
+TEST(Pipeline, matchesParser) {
+  std::string input = writeLog("pipeline.mpf", randomLog(5000, 8));
+  Recorder expected;
+  {
+    Reader reader(input);
+    Parser parser(&expected);
+    parser.parse(&reader);
+  }
+  for (u64 chunkSize : {1lu, 1000lu, 1lu << 18}) {
+    for (u64 depth : {1lu, 2lu, 8lu}) {
+      Recorder actual;
+      Reader reader(input);
+      Pipeline pipeline(&actual, chunkSize, depth);
+      pipeline.parse(&reader);
+      ASSERT_EQ(expected.text, actual.text);
+    }
+  }
+  std::remove(input.c_str());
+}
+
+TEST(Pipeline, decodeError) {
+  std::string input = writeLog(
+      "pipeline.mpf", randomLog(5000, 8) + "+T,x,1\n" + randomLog(100, 8));
+  Recorder actual;
+  Reader reader(input);
+  Pipeline pipeline(&actual, 1000, 2);
+  ASSERT_THROW(pipeline.parse(&reader), ex::Exception);
+  std::remove(input.c_str());
+}
+
+TEST(Pipeline, handlerError) {
+  std::string input = writeLog("pipeline.mpf", randomLog(5000, 8));
+  Recorder actual;
+  actual.failAt = 100;
+  Reader reader(input);
+  Pipeline pipeline(&actual, 1000, 2);
+  ASSERT_THROW(pipeline.parse(&reader), ex::Exception);
+  std::remove(input.c_str());
+}
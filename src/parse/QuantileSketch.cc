@@ -0,0 +1,190 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/QuantileSketch.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+QuantileSketch::QuantileSketch(f64 _relativeError, u32 _maxBuckets)
+    : relativeError_(_relativeError), maxBuckets_(_maxBuckets) {
+  if (!(_relativeError > 0.0 && _relativeError < 1.0)) {
+    throw ex::Exception("The sketch error must be in (0, 1): %f\n",
+                        _relativeError);
+  }
+  if (_maxBuckets == 0) {
+    throw ex::Exception("The sketch needs at least one bucket\n");
+  }
+  gamma_ = (1.0 + _relativeError) / (1.0 - _relativeError);
+  logGamma_ = std::log(gamma_);
+  clear();
+}
+
+QuantileSketch::~QuantileSketch() {}
+
+void QuantileSketch::add(f64 _value) {
+  // Welford's update
+  count_++;
+  f64 delta = _value - mean_;
+  mean_ += delta / count_;
+  m2_ += delta * (_value - mean_);
+  minimum_ = std::min(minimum_, _value);
+  maximum_ = std::max(maximum_, _value);
+
+  if (_value <= 0.0) {
+    zeroCount_++;
+    return;
+  }
+  s32 idx = index(_value);
+  grow(idx);
+  buckets_[std::max(idx - offset_, 0)]++;
+}
+
+void QuantileSketch::merge(const QuantileSketch& _other) {
+  if (_other.relativeError_ != relativeError_) {
+    throw ex::Exception("Sketches with different errors can't be merged\n");
+  }
+  if (_other.count_ == 0) {
+    return;
+  }
+
+  // the parallel variance update
+  u64 count = count_ + _other.count_;
+  f64 delta = _other.mean_ - mean_;
+  mean_ += delta * _other.count_ / count;
+  m2_ += _other.m2_ + delta * delta * count_ * _other.count_ / count;
+  count_ = count;
+  zeroCount_ += _other.zeroCount_;
+  minimum_ = std::min(minimum_, _other.minimum_);
+  maximum_ = std::max(maximum_, _other.maximum_);
+
+  if (!_other.buckets_.empty()) {
+    grow(_other.offset_);
+    grow(_other.offset_ + (s32)_other.buckets_.size() - 1);
+    for (u32 idx = 0; idx < _other.buckets_.size(); idx++) {
+      s32 bucket = std::max(_other.offset_ + (s32)idx - offset_, 0);
+      buckets_[bucket] += _other.buckets_[idx];
+    }
+  }
+}
+
+void QuantileSketch::clear() {
+  count_ = 0;
+  zeroCount_ = 0;
+  minimum_ = F64_POS_INF;
+  maximum_ = F64_NEG_INF;
+  mean_ = 0.0;
+  m2_ = 0.0;
+  offset_ = 0;
+  buckets_.clear();
+}
+
+f64 QuantileSketch::relativeError() const {
+  return relativeError_;
+}
+
+u64 QuantileSketch::count() const {
+  return count_;
+}
+
+f64 QuantileSketch::minimum() const {
+  return minimum_;
+}
+
+f64 QuantileSketch::maximum() const {
+  return maximum_;
+}
+
+f64 QuantileSketch::mean() const {
+  return mean_;
+}
+
+f64 QuantileSketch::variance() const {
+  return count_ == 0 ? 0.0 : m2_ / count_;
+}
+
+f64 QuantileSketch::quantile(f64 _quantile) const {
+  if (count_ == 0) {
+    return std::nan("");
+  }
+  u64 rank = (u64)std::round((count_ - 1) * _quantile);
+  if (rank == 0) {
+    return minimum_;
+  }
+  if (rank == count_ - 1) {
+    return maximum_;
+  }
+  if (rank < zeroCount_) {
+    return 0.0;
+  }
+  u64 cumulative = zeroCount_;
+  for (u32 idx = 0; idx < buckets_.size(); idx++) {
+    cumulative += buckets_[idx];
+    if (cumulative > rank) {
+      // the estimate with the lowest relative error in the bucket
+      f64 value = 2.0 * std::pow(gamma_, offset_ + (s32)idx) / (gamma_ + 1.0);
+      return std::min(std::max(value, minimum_), maximum_);
+    }
+  }
+  return maximum_;
+}
+
+s32 QuantileSketch::index(f64 _value) const {
+  return (s32)std::ceil(std::log(_value) / logGamma_);
+}
+
+void QuantileSketch::grow(s32 _index) {
+  if (buckets_.empty()) {
+    offset_ = _index;
+    buckets_.resize(1, 0);
+    return;
+  }
+  if (_index < offset_) {
+    // indices below a collapsed range stay in the lowest bucket
+    u64 size = buckets_.size();
+    u64 room = size < maxBuckets_ ? maxBuckets_ - size : 0;
+    u64 extra = std::min((u64)(offset_ - _index), room);
+    buckets_.insert(buckets_.begin(), extra, 0);
+    offset_ -= (s32)extra;
+  } else if (_index >= offset_ + (s32)buckets_.size()) {
+    buckets_.resize(_index - offset_ + 1, 0);
+    if (buckets_.size() > maxBuckets_) {
+      // collapse the lowest buckets into one
+      u64 excess = buckets_.size() - maxBuckets_;
+      for (u64 idx = 0; idx < excess; idx++) {
+        buckets_[excess] += buckets_[idx];
+      }
+      buckets_.erase(buckets_.begin(), buckets_.begin() + excess);
+      offset_ += (s32)excess;
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_QUANTILESKETCH_H_
+#define PARSE_QUANTILESKETCH_H_
+
+#include <prim/prim.h>
+
+#include <vector>
+
+// This class summarizes a stream of non-negative values in bounded memory. It
+// is a relative-error quantile sketch (DDSketch): values are counted in
+// logarithmic buckets (gamma^(i-1), gamma^i] with
+// gamma = (1 + error) / (1 - error), so every quantile is reported within a
+// relative error of 'error' of the exact value of the same rank. Zeros are
+// counted exactly, as are the lowest and highest ranks. If the values span
+// more buckets than the cap (by default MAX_BUCKETS, a ratio of about 1e284
+// at 1% error) the lowest ones are collapsed, which only loosens the bound
+// of the lowest quantiles. The count, minimum, maximum, mean, and variance
+// are exact up to rounding. Sketches with the same error can be merged.
+class QuantileSketch {
+ public:
+  static constexpr f64 DEFAULT_ERROR = 0.01;
+  static const u32 MAX_BUCKETS = 1 << 15;
+
+  explicit QuantileSketch(f64 _relativeError = DEFAULT_ERROR,
+                          u32 _maxBuckets = MAX_BUCKETS);
+  ~QuantileSketch();
+
+  void add(f64 _value);
+  void merge(const QuantileSketch& _other);
+  void clear();
+
+  f64 relativeError() const;
+  u64 count() const;
+  f64 minimum() const;
+  f64 maximum() const;
+  f64 mean() const;
+  f64 variance() const;  // population variance
+
+  // the value of rank round((count - 1) * _quantile) in sorted order
+  f64 quantile(f64 _quantile) const;
+
+ private:
+  s32 index(f64 _value) const;
+  void grow(s32 _index);
+
+  f64 relativeError_;
+  u32 maxBuckets_;
+  f64 gamma_;
+  f64 logGamma_;
+
+  u64 count_;
+  u64 zeroCount_;
+  f64 minimum_;
+  f64 maximum_;
+  f64 mean_;
+  f64 m2_;  // sum of squared differences from the mean
+
+  s32 offset_;                // bucket index of buckets_[0]
+  std::vector<u64> buckets_;  // [index - offset_] -> count
+};
+
+#endif  // PARSE_QUANTILESKETCH_H_
@@ -0,0 +1,170 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/QuantileSketch.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// checks each quantile against the exact value of the same rank
+static void checkQuantiles(const QuantileSketch& _sketch,
+                           std::vector<f64> _values) {
+  std::sort(_values.begin(), _values.end());
+  ASSERT_EQ(_sketch.count(), _values.size());
+  for (f64 quantile : {0.0, 0.1, 0.5, 0.9, 0.99, 0.999, 0.9999, 1.0}) {
+    f64 exact = _values.at(std::round((_values.size() - 1) * quantile));
+    f64 estimate = _sketch.quantile(quantile);
+    ASSERT_LE(std::abs(estimate - exact),
+              exact * _sketch.relativeError() * (1 + 1e-9))
+        << quantile;
+  }
+}
+
+TEST(QuantileSketch, relativeError) {
+  std::mt19937_64 rng(12345);
+  std::lognormal_distribution<f64> dist(3.0, 2.0);
+  for (f64 error : {0.05, 0.01, 0.001}) {
+    QuantileSketch sketch(error);
+    std::vector<f64> values;
+    for (u32 idx = 0; idx < 100000; idx++) {
+      values.push_back(dist(rng));
+      sketch.add(values.back());
+    }
+    checkQuantiles(sketch, values);
+  }
+}
+
+TEST(QuantileSketch, moments) {
+  QuantileSketch sketch;
+  ASSERT_EQ(sketch.count(), 0u);
+  ASSERT_TRUE(std::isnan(sketch.quantile(0.5)));
+  for (f64 value : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+    sketch.add(value);
+  }
+  ASSERT_EQ(sketch.count(), 8u);
+  ASSERT_DOUBLE_EQ(sketch.minimum(), 2.0);
+  ASSERT_DOUBLE_EQ(sketch.maximum(), 9.0);
+  ASSERT_DOUBLE_EQ(sketch.mean(), 5.0);
+  ASSERT_DOUBLE_EQ(sketch.variance(), 4.0);
+  ASSERT_DOUBLE_EQ(sketch.quantile(0.0), 2.0);
+  ASSERT_DOUBLE_EQ(sketch.quantile(1.0), 9.0);
+
+  // zeros are exact
+  QuantileSketch zeros;
+  std::vector<f64> values = {0.0, 0.0, 0.0, 1.0, 100.0};
+  for (f64 value : values) {
+    zeros.add(value);
+  }
+  ASSERT_EQ(zeros.quantile(0.5), 0.0);
+  checkQuantiles(zeros, values);
+}
+
+TEST(QuantileSketch, merge) {
+  std::mt19937_64 rng(777);
+  std::exponential_distribution<f64> dist(0.01);
+  QuantileSketch all(0.02);
+  QuantileSketch parts[3] = {QuantileSketch(0.02), QuantileSketch(0.02),
+                             QuantileSketch(0.02)};
+  std::vector<f64> values;
+  for (u32 idx = 0; idx < 30000; idx++) {
+    values.push_back(dist(rng) * (idx % 3 + 1));
+    all.add(values.back());
+    parts[idx % 3].add(values.back());
+  }
+  parts[0].merge(parts[1]);
+  parts[0].merge(parts[2]);
+  parts[0].merge(QuantileSketch(0.02));
+  checkQuantiles(parts[0], values);
+  ASSERT_EQ(parts[0].count(), all.count());
+  ASSERT_NEAR(parts[0].mean(), all.mean(), 1e-9 * all.mean());
+  ASSERT_NEAR(parts[0].variance(), all.variance(), 1e-9 * all.variance());
+  for (f64 quantile : {0.5, 0.9, 0.99}) {
+    ASSERT_DOUBLE_EQ(parts[0].quantile(quantile), all.quantile(quantile));
+  }
+
+  ASSERT_THROW(all.merge(QuantileSketch(0.01)), ex::Exception);
+  ASSERT_THROW(QuantileSketch(0.0), ex::Exception);
+  ASSERT_THROW(QuantileSketch(1.0), ex::Exception);
+}
+
+TEST(QuantileSketch, bounded) {
+  // a huge range collapses the lowest buckets, the high quantiles keep
+  // their bound
+  QuantileSketch sketch(0.01);
+  std::vector<f64> values;
+  for (s32 exp = -300; exp <= 300; exp++) {
+    for (u32 idx = 0; idx < 10; idx++) {
+      values.push_back(std::pow(10.0, exp) * (1 + idx * 0.05));
+      sketch.add(values.back());
+    }
+  }
+  std::sort(values.begin(), values.end());
+  for (f64 quantile : {0.9, 0.99, 1.0}) {
+    f64 exact = values.at(std::round((values.size() - 1) * quantile));
+    ASSERT_LE(std::abs(sketch.quantile(quantile) - exact), exact * 0.01);
+  }
+  ASSERT_EQ(sketch.quantile(0.0), values.front());
+}
+
+TEST(QuantileSketch, bucketCap) {
+  // a small cap keeps the bound within gamma^cap of the largest value
+  const f64 ERROR = 0.02;
+  const u32 BUCKETS = 128;
+  f64 range = std::pow((1 + ERROR) / (1 - ERROR), BUCKETS - 1);
+  std::mt19937_64 rng(4321);
+  std::uniform_real_distribution<f64> dist(0.0, std::log(100.0));
+  QuantileSketch sketch(ERROR, BUCKETS);
+  QuantileSketch parts[2] = {QuantileSketch(ERROR, BUCKETS),
+                             QuantileSketch(ERROR, BUCKETS)};
+  std::vector<f64> values;
+  for (u32 idx = 0; idx < 20000; idx++) {
+    // a few values far below the range are collapsed into the lowest bucket
+    f64 scale = (idx % 200 == 0) ? 1e-6 : 1.0;
+    values.push_back(scale * std::exp(dist(rng)));
+    sketch.add(values.back());
+    parts[idx % 2].add(values.back());
+  }
+  parts[0].merge(parts[1]);
+  std::sort(values.begin(), values.end());
+  for (f64 quantile : {0.5, 0.9, 0.99}) {
+    f64 exact = values.at(std::round((values.size() - 1) * quantile));
+    ASSERT_GT(exact * range, values.back());
+    ASSERT_LE(std::abs(sketch.quantile(quantile) - exact), exact * ERROR);
+    ASSERT_LE(std::abs(parts[0].quantile(quantile) - exact), exact * ERROR);
+  }
+  ASSERT_EQ(sketch.quantile(0.0), values.front());
+  ASSERT_THROW(QuantileSketch(ERROR, 0), ex::Exception);
+}
@@ -0,0 +1,124 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Query.h"
+
+#include <ex/Exception.h>
+#include <strop/strop.h>
+
+#include <fstream>
+#include <sstream>
+
+Query::Query()
+    : throughputBinWidth(0.0),
+      throughputGrouping(Throughput::Grouping::NONE),
+      latencySketch(0.0),
+      fixedTimes(false) {}
+
+Query::~Query() {}
+
+Query Query::parse(const std::string& _spec) {
+  // the name and filters can't hold a ':', the filenames can
+  size_t first = _spec.find(':');
+  size_t second =
+      (first == std::string::npos) ? first : _spec.find(':', first + 1);
+  if (second == std::string::npos) {
+    throw ex::Exception("Invalid query, must be name:filters:outputs: %s\n",
+                        _spec.c_str());
+  }
+  Query query;
+  query.name = strop::trim(_spec.substr(0, first));
+  if (query.name.empty()) {
+    throw ex::Exception("Invalid query, missing name: %s\n", _spec.c_str());
+  }
+
+  // filters
+  std::istringstream filters(_spec.substr(first + 1, second - first - 1));
+  std::string filter;
+  while (filters >> filter) {
+    query.filters.push_back(filter);
+  }
+
+  // outputs
+  std::istringstream outputs(_spec.substr(second + 1));
+  std::string flag;
+  while (outputs >> flag) {
+    std::string filename;
+    if (!(outputs >> filename)) {
+      throw ex::Exception("Query %s is missing the file of %s\n",
+                          query.name.c_str(), flag.c_str());
+    }
+    if (flag == "-t" || flag == "--transactionfile") {
+      query.transactionsFile = filename;
+    } else if (flag == "-m" || flag == "--messagefile") {
+      query.messagesFile = filename;
+    } else if (flag == "-p" || flag == "--packetfile") {
+      query.packetsFile = filename;
+    } else if (flag == "-l" || flag == "--latencyfile") {
+      query.latencyFile = filename;
+    } else if (flag == "-c" || flag == "--hopcountfile") {
+      query.hopCountFile = filename;
+    } else if (flag == "--matrix") {
+      query.matrixFile = filename;
+    } else if (flag == "--throughput") {
+      query.throughputFile = filename;
+    } else {
+      throw ex::Exception("Query %s has an invalid output: %s\n",
+                          query.name.c_str(), flag.c_str());
+    }
+  }
+  if (!query.hasOutputs()) {
+    throw ex::Exception("Query %s has no outputs\n", query.name.c_str());
+  }
+  return query;
+}
+
+std::vector<Query> Query::readFile(const std::string& _filename) {
+  std::ifstream file(_filename);
+  if (!file) {
+    throw ex::Exception("Unable to open query file: %s\n", _filename.c_str());
+  }
+  std::vector<Query> queries;
+  std::string line;
+  while (std::getline(file, line)) {
+    line = strop::trim(line);
+    if (!line.empty() && line.at(0) != '#') {
+      queries.push_back(parse(line));
+    }
+  }
+  return queries;
+}
+
+bool Query::hasOutputs() const {
+  return !transactionsFile.empty() || !messagesFile.empty() ||
+         !packetsFile.empty() || !latencyFile.empty() ||
+         !hopCountFile.empty() || !matrixFile.empty() ||
+         !throughputFile.empty() || transient != nullptr;
+}
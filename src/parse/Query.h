@@ -0,0 +1,85 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_QUERY_H_
+#define PARSE_QUERY_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parse/Throughput.h"
+#include "parse/Transient.h"
+
+// The filters and output files of one analysis of a message log. Many queries
+// can be evaluated in a single pass.
+struct Query {
+  Query();
+  ~Query();
+
+  // parses "name:filters:outputs" where the filters are separated by spaces
+  // and the outputs are given as on the command line, for example
+  // "app1:+app=1 -pc=0:-l app1_lat.csv -c app1_hops.csv"
+  static Query parse(const std::string& _spec);
+
+  // reads one query per line, empty lines and lines starting with '#' are
+  // skipped
+  static std::vector<Query> readFile(const std::string& _filename);
+
+  // returns true if any output file is set
+  bool hasOutputs() const;
+
+  std::string name;
+  std::vector<std::string> filters;
+  std::vector<std::string> expressions;  // see Filter::Syntax::EXPRESSION
+  std::string transactionsFile;
+  std::string messagesFile;
+  std::string packetsFile;
+  std::string latencyFile;
+  std::string hopCountFile;
+  std::string matrixFile;
+  std::string throughputFile;
+  std::shared_ptr<Transient> transient;
+
+  // the bins of the throughput output and what its counts are split by
+  f64 throughputBinWidth;
+  Throughput::Grouping throughputGrouping;
+
+  // the relative error of sketched latency percentiles, 0 for exact ones
+  f64 latencySketch;
+
+  // record times are written with 6 decimals as by std::to_string instead of
+  // their shortest exact text
+  bool fixedTimes;
+};
+
+#endif  // PARSE_QUERY_H_
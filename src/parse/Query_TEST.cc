@@ -0,0 +1,111 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Query.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "parse/Engine.h"
+#include "parse/TestData_TEST.h"
+
+TEST(Query, parse) {
+  Query query = Query::parse("app1: +app=1  -pc=0 :-l lat.csv --packetfile "
+                             "/tmp/a:b.csv");
+  ASSERT_EQ(query.name, "app1");
+  ASSERT_EQ(query.filters, std::vector<std::string>({"+app=1", "-pc=0"}));
+  ASSERT_EQ(query.latencyFile, "lat.csv");
+  ASSERT_EQ(query.packetsFile, "/tmp/a:b.csv");
+  ASSERT_TRUE(query.hopCountFile.empty());
+
+  query = Query::parse("all::-c hops.csv");
+  ASSERT_TRUE(query.filters.empty());
+  ASSERT_EQ(query.hopCountFile, "hops.csv");
+
+  query = Query::parse("flows:+pc=1:--matrix flows.csv");
+  ASSERT_EQ(query.matrixFile, "flows.csv");
+  ASSERT_TRUE(query.hasOutputs());
+
+  query = Query::parse("load:+app=2:--throughput load.csv");
+  ASSERT_EQ(query.throughputFile, "load.csv");
+  ASSERT_TRUE(query.hasOutputs());
+
+  ASSERT_THROW(Query::parse("all:-l lat.csv"), ex::Exception);
+  ASSERT_THROW(Query::parse(":+pc=0:-l lat.csv"), ex::Exception);
+  ASSERT_THROW(Query::parse("all:+pc=0:"), ex::Exception);
+  ASSERT_THROW(Query::parse("all:+pc=0:-l"), ex::Exception);
+  ASSERT_THROW(Query::parse("all:+pc=0:-x lat.csv"), ex::Exception);
+}
+
+TEST(Query, engineMatchesSeparateRuns) {
+  std::string input = writeLog("query.mpf", randomLog(50, 8));
+  std::string prefix = testing::TempDir() + "query_";
+  const char* OUTPUTS[] = {"t", "m", "p", "l", "c"};
+  std::vector<std::vector<std::string> > chains = {
+      {"+pc=0"}, {"+app=1", "-hc=3"}, {}, {"+app=1"}};
+
+  // one pass for all queries
+  std::vector<Query> queries;
+  for (u32 idx = 0; idx < chains.size(); idx++) {
+    std::string spec = "q" + std::to_string(idx) + ":";
+    for (const std::string& filter : chains[idx]) {
+      spec += filter + " ";
+    }
+    spec += ":";
+    for (const char* output : OUTPUTS) {
+      spec += std::string(" -") + output + " " + prefix + "all" +
+              std::to_string(idx) + output;
+    }
+    queries.push_back(Query::parse(spec));
+  }
+  {
+    Engine engine(queries, 1.0, false);
+    parseLog(input, &engine);
+    engine.complete();
+  }
+
+  // one pass per query
+  for (u32 idx = 0; idx < chains.size(); idx++) {
+    std::vector<std::string> outputs = runEngine(input, chains[idx]);
+    for (u32 output = 0; output < outputs.size(); output++) {
+      std::string all = prefix + "all" + std::to_string(idx) + OUTPUTS[output];
+      ASSERT_FALSE(outputs[output].empty());
+      ASSERT_EQ(readFile(all), outputs[output])
+          << "query " << idx << " output " << OUTPUTS[output];
+      std::remove(all.c_str());
+    }
+  }
+  std::remove(input.c_str());
+}
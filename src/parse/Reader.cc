@@ -0,0 +1,202 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Reader.h"
+
+#include <ex/Exception.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "parse/GzipCodec.h"
+#include "parse/Lz4Codec.h"
+#include "parse/ParallelGzip.h"
+#include "parse/ParallelZstd.h"
+#include "parse/PlainCodec.h"
+#include "parse/ZstdCodec.h"
+
+Reader::Reader(const std::string& _filename, u32 _threads, u64 _bufferSize)
+    : filename_(_filename),
+      fd_(-1),
+      map_(nullptr),
+      mapSize_(0),
+      pos_(nullptr),
+      end_(nullptr),
+      done_(false) {
+  if (filename_ == "-") {
+    fd_ = STDIN_FILENO;
+  } else {
+    fd_ = open(filename_.c_str(), O_RDONLY);
+  }
+  if (fd_ < 0) {
+    throw ex::Exception("Unable to open input file: %s\n", filename_.c_str());
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    throw ex::Exception("Unable to stat input file: %s\n", filename_.c_str());
+  }
+  mapSize_ = st.st_size;
+
+  // the format is detected by its magic bytes, this works on pipes too
+  std::unique_ptr<InputStream> input =
+      std::make_unique<InputStream>(filename_, fd_);
+  char magic[FORMAT_MAGIC_SIZE];
+  Format format = detectFormat(magic, input->peek(magic, sizeof(magic)));
+
+  // regular files that aren't decompressed sequentially are memory mapped,
+  // everything else is read through the input stream
+  bool regular = S_ISREG(st.st_mode);
+  if (regular && format == Format::PLAIN) {
+    map(MADV_SEQUENTIAL);
+    pos_ = map_;
+    end_ = map_ + mapSize_;
+    done_ = true;
+    return;
+  }
+  if (regular && _threads > 1 && format == Format::GZIP) {
+    map(MADV_WILLNEED);
+    codec_ = std::make_unique<ParallelGzip>(
+        reinterpret_cast<const u8*>(map_), mapSize_, _threads);
+  } else if (regular && _threads > 1 && format == Format::ZSTD) {
+    map(MADV_WILLNEED);
+    const u8* data = reinterpret_cast<const u8*>(map_);
+    if (ParallelZstd::multiFrame(data, mapSize_)) {
+      codec_ = std::make_unique<ParallelZstd>(filename_, data, mapSize_,
+                                              _threads);
+    }
+  }
+  if (!codec_) {
+    switch (format) {
+      case Format::PLAIN:
+        codec_ = std::make_unique<PlainCodec>(std::move(input), _bufferSize);
+        break;
+      case Format::GZIP:
+        codec_ = std::make_unique<GzipCodec>(std::move(input), _bufferSize);
+        break;
+      case Format::ZSTD:
+        codec_ = std::make_unique<ZstdCodec>(std::move(input), _bufferSize);
+        break;
+      case Format::LZ4:
+        codec_ = std::make_unique<Lz4Codec>(std::move(input), _bufferSize);
+        break;
+    }
+  }
+  buffer_.reserve(_bufferSize);
+  pos_ = buffer_.data();
+  end_ = buffer_.data();
+}
+
+Reader::~Reader() {
+  // the decompression threads must finish before the input is unmapped
+  codec_.reset();
+  if (map_ != nullptr) {
+    munmap(const_cast<char*>(map_), mapSize_);
+  }
+  if (fd_ >= 0 && fd_ != STDIN_FILENO) {
+    close(fd_);
+  }
+}
+
+bool Reader::nextLine(std::string_view* _line) {
+  while (true) {
+    if (pos_ < end_) {
+      const char* nl =
+          static_cast<const char*>(std::memchr(pos_, '\n', end_ - pos_));
+      if (nl != nullptr) {
+        *_line = std::string_view(pos_, nl - pos_);
+        pos_ = nl + 1;
+        return true;
+      }
+    }
+    if (done_) {
+      // the last line might not be newline terminated
+      if (pos_ < end_) {
+        *_line = std::string_view(pos_, end_ - pos_);
+        pos_ = end_;
+        return true;
+      }
+      return false;
+    }
+    refill();
+  }
+}
+
+bool Reader::nextBlock(std::string_view* _block) {
+  while (true) {
+    if (pos_ < end_) {
+      const char* nl =
+          static_cast<const char*>(memrchr(pos_, '\n', end_ - pos_));
+      if (nl != nullptr) {
+        *_block = std::string_view(pos_, nl + 1 - pos_);
+        pos_ = nl + 1;
+        return true;
+      }
+    }
+    if (done_) {
+      // the last line might not be newline terminated
+      if (pos_ < end_) {
+        *_block = std::string_view(pos_, end_ - pos_);
+        pos_ = end_;
+        return true;
+      }
+      return false;
+    }
+    refill();
+  }
+}
+
+void Reader::map(s32 _advice) {
+  if (mapSize_ > 0) {
+    void* map = mmap(nullptr, mapSize_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED) {
+      throw ex::Exception("Unable to map input file: %s\n", filename_.c_str());
+    }
+    madvise(map, mapSize_, _advice);
+    map_ = static_cast<const char*>(map);
+  }
+}
+
+void Reader::refill() {
+  assert(codec_);
+
+  // move the partial line to the front of the buffer and append the next
+  // piece of decoded data
+  u64 leftover = end_ - pos_;
+  std::memmove(buffer_.data(), pos_, leftover);
+  buffer_.resize(leftover);
+  done_ = !codec_->read(&buffer_);
+  pos_ = buffer_.data();
+  end_ = buffer_.data() + buffer_.size();
+}
@@ -0,0 +1,85 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_READER_H_
+#define PARSE_READER_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "parse/Codec.h"
+
+// This class hands out the lines of an input file as views into a large
+// internal buffer. The format is detected by its magic bytes: uncompressed
+// files are memory mapped, compressed files (gzip, zstd, or lz4) are
+// decompressed by a codec into a reusable buffer. With more than one thread
+// gzip files and multi-frame zstd files are decompressed in parallel. A
+// filename of "-" reads stdin. Stdin, named pipes, and other non-regular files
+// are read sequentially through a bounded buffer. A returned line is valid
+// until the next call to nextLine() or nextBlock().
+class Reader {
+ public:
+  explicit Reader(const std::string& _filename, u32 _threads = 1,
+                  u64 _bufferSize = 1 << 24);
+  ~Reader();
+
+  // returns false when the input is exhausted
+  bool nextLine(std::string_view* _line);
+
+  // returns all whole lines that are currently buffered (at least one), the
+  // block is valid until the next call to nextLine() or nextBlock()
+  bool nextBlock(std::string_view* _block);
+
+ private:
+  void map(s32 _advice);
+  void refill();
+
+  std::string filename_;
+  s32 fd_;
+
+  // memory mapped input
+  const char* map_;
+  u64 mapSize_;
+
+  // compressed or streamed input
+  std::unique_ptr<Codec> codec_;
+  std::vector<char> buffer_;
+
+  // current window of decoded text
+  const char* pos_;
+  const char* end_;
+  bool done_;
+};
+
+#endif  // PARSE_READER_H_
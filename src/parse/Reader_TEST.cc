@@ -0,0 +1,137 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Reader.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <lz4frame.h>
+#include <prim/prim.h>
+#include <unistd.h>
+#include <zstd.h>
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "parse/TestData_TEST.h"
+
+static std::string zstd(const std::string& _text) {
+  std::string out(ZSTD_compressBound(_text.size()), '\0');
+  size_t size = ZSTD_compress(out.data(), out.size(), _text.data(),
+                              _text.size(), 3);
+  EXPECT_FALSE(ZSTD_isError(size));
+  out.resize(size);
+  return out;
+}
+
+static std::string lz4(const std::string& _text) {
+  std::string out(LZ4F_compressFrameBound(_text.size(), nullptr), '\0');
+  size_t size = LZ4F_compressFrame(out.data(), out.size(), _text.data(),
+                                   _text.size(), nullptr);
+  EXPECT_FALSE(LZ4F_isError(size));
+  out.resize(size);
+  return out;
+}
+
+// reads all lines of _data written into a pipe in small pieces
+static std::string readPipe(const std::string& _data, u64 _bufferSize) {
+  s32 fds[2];
+  EXPECT_EQ(pipe(fds), 0);
+  std::thread writer([&]() {
+    for (u64 pos = 0; pos < _data.size(); pos += 1000) {
+      u64 size = std::min<u64>(1000, _data.size() - pos);
+      EXPECT_EQ(write(fds[1], _data.data() + pos, size), (ssize_t)size);
+    }
+    close(fds[1]);
+  });
+  std::string text;
+  try {
+    Reader reader("/dev/fd/" + std::to_string(fds[0]), 1, _bufferSize);
+    std::string_view line;
+    while (reader.nextLine(&line)) {
+      text.append(line);
+      text.push_back('\n');
+    }
+  } catch (...) {
+    writer.join();
+    close(fds[0]);
+    throw;
+  }
+  writer.join();
+  close(fds[0]);
+  return text;
+}
+
+TEST(Reader, plainPipe) {
+  std::string text = numberedText(10000);
+  for (u64 bufferSize : {1lu, 100lu, 4096lu, 1lu << 20}) {
+    ASSERT_EQ(readPipe(text, bufferSize), text);
+  }
+  ASSERT_EQ(readPipe("", 4096), "");
+  ASSERT_EQ(readPipe("x", 4096), "x\n");
+}
+
+TEST(Reader, gzipPipe) {
+  std::string text = numberedText(10000);
+  std::string compressed = gzipText(text);
+  for (u64 bufferSize : {100lu, 4096lu, 1lu << 20}) {
+    ASSERT_EQ(readPipe(compressed, bufferSize), text);
+  }
+  ASSERT_EQ(readPipe(compressed + gzipText("+M\n"), 4096), text + "+M\n");
+}
+
+TEST(Reader, zstdPipe) {
+  std::string text = numberedText(10000);
+  std::string compressed = zstd(text);
+  for (u64 bufferSize : {100lu, 4096lu, 1lu << 20}) {
+    ASSERT_EQ(readPipe(compressed, bufferSize), text);
+  }
+  ASSERT_EQ(readPipe(compressed + zstd("+M\n"), 4096), text + "+M\n");
+}
+
+TEST(Reader, lz4Pipe) {
+  std::string text = numberedText(10000);
+  std::string compressed = lz4(text);
+  for (u64 bufferSize : {100lu, 4096lu, 1lu << 20}) {
+    ASSERT_EQ(readPipe(compressed, bufferSize), text);
+  }
+  ASSERT_EQ(readPipe(compressed + lz4("+M\n"), 4096), text + "+M\n");
+}
+
+TEST(Reader, truncatedPipe) {
+  std::string text = numberedText(10000);
+  for (const std::string& compressed :
+       {gzipText(text), zstd(text), lz4(text)}) {
+    ASSERT_THROW(readPipe(compressed.substr(0, compressed.size() / 2), 4096),
+                 ex::Exception);
+  }
+}
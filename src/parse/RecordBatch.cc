@@ -0,0 +1,132 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RecordBatch.h"
+
+RecordBatch::RecordBatch() {}
+
+RecordBatch::~RecordBatch() {}
+
+void RecordBatch::transactionStart(u64 _transId, u64 _transStart) {
+  Record& record = records_.emplace_back();
+  record.type = Type::TRANSACTION_START;
+  record.longs[0] = _transId;
+  record.longs[1] = _transStart;
+}
+
+void RecordBatch::transactionEnd(u64 _transId, u64 _transEnd) {
+  Record& record = records_.emplace_back();
+  record.type = Type::TRANSACTION_END;
+  record.longs[0] = _transId;
+  record.longs[1] = _transEnd;
+}
+
+void RecordBatch::messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst,
+                               u64 _transId, u32 _protocolClass,
+                               u32 _minHopCount, u32 _opCode) {
+  Record& record = records_.emplace_back();
+  record.type = Type::MESSAGE_START;
+  record.ints[0] = _msgId;
+  record.ints[1] = _msgSrc;
+  record.ints[2] = _msgDst;
+  record.ints[3] = _protocolClass;
+  record.ints[4] = _minHopCount;
+  record.ints[5] = _opCode;
+  record.longs[0] = _transId;
+}
+
+void RecordBatch::messageEnd() {
+  Record& record = records_.emplace_back();
+  record.type = Type::MESSAGE_END;
+}
+
+void RecordBatch::packetStart(u32 _pktId, u32 _pktHopCount) {
+  Record& record = records_.emplace_back();
+  record.type = Type::PACKET_START;
+  record.ints[0] = _pktId;
+  record.ints[1] = _pktHopCount;
+}
+
+void RecordBatch::packetEnd() {
+  Record& record = records_.emplace_back();
+  record.type = Type::PACKET_END;
+}
+
+void RecordBatch::flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) {
+  Record& record = records_.emplace_back();
+  record.type = Type::FLIT;
+  record.ints[0] = _flitId;
+  record.longs[0] = _flitSendTime;
+  record.longs[1] = _flitReceiveTime;
+}
+
+u64 RecordBatch::size() const {
+  return records_.size();
+}
+
+void RecordBatch::clear() {
+  records_.clear();
+}
+
+void RecordBatch::replay(RecordHandler* _handler) const {
+  for (const Record& record : records_) {
+    switch (record.type) {
+      case Type::TRANSACTION_START:
+        _handler->transactionStart(record.longs[0], record.longs[1]);
+        break;
+
+      case Type::TRANSACTION_END:
+        _handler->transactionEnd(record.longs[0], record.longs[1]);
+        break;
+
+      case Type::MESSAGE_START:
+        _handler->messageStart(record.ints[0], record.ints[1], record.ints[2],
+                               record.longs[0], record.ints[3], record.ints[4],
+                               record.ints[5]);
+        break;
+
+      case Type::MESSAGE_END:
+        _handler->messageEnd();
+        break;
+
+      case Type::PACKET_START:
+        _handler->packetStart(record.ints[0], record.ints[1]);
+        break;
+
+      case Type::PACKET_END:
+        _handler->packetEnd();
+        break;
+
+      case Type::FLIT:
+        _handler->flit(record.ints[0], record.longs[0], record.longs[1]);
+        break;
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_RECORDBATCH_H_
+#define PARSE_RECORDBATCH_H_
+
+#include <prim/prim.h>
+
+#include <vector>
+
+#include "parse/RecordHandler.h"
+
+// This class stores decoded records so they can be handed to another thread
+// and replayed into a handler later.
+class RecordBatch : public RecordHandler {
+ public:
+  RecordBatch();
+  ~RecordBatch() override;
+
+  void transactionStart(u64 _transId, u64 _transStart) override;
+  void transactionEnd(u64 _transId, u64 _transEnd) override;
+  void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst, u64 _transId,
+                    u32 _protocolClass, u32 _minHopCount,
+                    u32 _opCode) override;
+  void messageEnd() override;
+  void packetStart(u32 _pktId, u32 _pktHopCount) override;
+  void packetEnd() override;
+  void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) override;
+
+  u64 size() const;
+  void clear();
+
+  // feeds the stored records into the handler in order
+  void replay(RecordHandler* _handler) const;
+
+ private:
+  enum class Type : u8 {
+    TRANSACTION_START,
+    TRANSACTION_END,
+    MESSAGE_START,
+    MESSAGE_END,
+    PACKET_START,
+    PACKET_END,
+    FLIT
+  };
+
+  // fields are used according to the type in the order of the handler's
+  // arguments, u32s first
+  struct Record {
+    Type type;
+    u32 ints[6];
+    u64 longs[2];
+  };
+
+  std::vector<Record> records_;
+};
+
+#endif  // PARSE_RECORDBATCH_H_
@@ -0,0 +1,54 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_RECORDHANDLER_H_
+#define PARSE_RECORDHANDLER_H_
+
+#include <prim/prim.h>
+
+// This is the interface of everything that consumes the records of a message
+// log in file order.
+class RecordHandler {
+ public:
+  RecordHandler();
+  virtual ~RecordHandler();
+
+  virtual void transactionStart(u64 _transId, u64 _transStart) = 0;
+  virtual void transactionEnd(u64 _transId, u64 _transEnd) = 0;
+  virtual void messageStart(u32 _msgId, u32 _msgSrc, u32 _msgDst,
+                            u64 _transId, u32 _protocolClass,
+                            u32 _minHopCount, u32 _opCode) = 0;
+  virtual void messageEnd() = 0;
+  virtual void packetStart(u32 _pktId, u32 _pktHopCount) = 0;
+  virtual void packetEnd() = 0;
+  virtual void flit(u32 _flitId, u64 _flitSendTime, u64 _flitReceiveTime) = 0;
+};
+
+#endif  // PARSE_RECORDHANDLER_H_
@@ -0,0 +1,201 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RecordTable.h"
+
+#include <cassert>
+#include <cstring>
+
+const char TABLE_MAGIC[8] = {'R', 'T', 'A', 'B', '0', '0', '0', '1'};
+
+const char TABLE_EXTENSION[6] = ".rtab";
+
+// where the values of a column come from
+enum class Source { START, END, FIELD, MESSAGE_ID, PACKET_ID };
+
+struct Spec {
+  const char* name;
+  Source source;
+  Filter::Field field;  // of Source::FIELD
+};
+
+static const std::vector<Spec>& specs(Filter::Level _level) {
+  static const std::vector<Spec> transaction = {
+      {"transaction_id", Source::FIELD, Filter::TRANSACTION_ID},
+      {"application_id", Source::FIELD, Filter::APPLICATION_ID},
+      {"start", Source::START, Filter::NUM_FIELDS},
+      {"end", Source::END, Filter::NUM_FIELDS},
+      {"message_count", Source::FIELD, Filter::MESSAGE_COUNT},
+      {"packet_count", Source::FIELD, Filter::PACKET_COUNT},
+      {"flit_count", Source::FIELD, Filter::FLIT_COUNT}};
+  static const std::vector<Spec> message = {
+      {"transaction_id", Source::FIELD, Filter::TRANSACTION_ID},
+      {"message_id", Source::MESSAGE_ID, Filter::NUM_FIELDS},
+      {"application_id", Source::FIELD, Filter::APPLICATION_ID},
+      {"source", Source::FIELD, Filter::SOURCE_ID},
+      {"destination", Source::FIELD, Filter::DESTINATION_ID},
+      {"protocol_class", Source::FIELD, Filter::PROTOCOL_CLASS},
+      {"opcode", Source::FIELD, Filter::OPCODE_ID},
+      {"start", Source::START, Filter::NUM_FIELDS},
+      {"end", Source::END, Filter::NUM_FIELDS},
+      {"packet_count", Source::FIELD, Filter::PACKET_COUNT},
+      {"flit_count", Source::FIELD, Filter::FLIT_COUNT},
+      {"min_hop_count", Source::FIELD, Filter::MIN_HOP_COUNT}};
+  static const std::vector<Spec> packet = {
+      {"transaction_id", Source::FIELD, Filter::TRANSACTION_ID},
+      {"message_id", Source::MESSAGE_ID, Filter::NUM_FIELDS},
+      {"packet_id", Source::PACKET_ID, Filter::NUM_FIELDS},
+      {"application_id", Source::FIELD, Filter::APPLICATION_ID},
+      {"source", Source::FIELD, Filter::SOURCE_ID},
+      {"destination", Source::FIELD, Filter::DESTINATION_ID},
+      {"protocol_class", Source::FIELD, Filter::PROTOCOL_CLASS},
+      {"opcode", Source::FIELD, Filter::OPCODE_ID},
+      {"start", Source::START, Filter::NUM_FIELDS},
+      {"end", Source::END, Filter::NUM_FIELDS},
+      {"flit_count", Source::FIELD, Filter::FLIT_COUNT},
+      {"hop_count", Source::FIELD, Filter::HOP_COUNT},
+      {"min_hop_count", Source::FIELD, Filter::MIN_HOP_COUNT},
+      {"non_min_hop_count", Source::FIELD, Filter::NON_MIN_HOP_COUNT}};
+  switch (_level) {
+    case Filter::Level::TRANSACTION:
+      return transaction;
+    case Filter::Level::MESSAGE:
+      return message;
+    default:
+      return packet;
+  }
+}
+
+static u64 bits(f64 _value) {
+  u64 value;
+  std::memcpy(&value, &_value, sizeof(value));
+  return value;
+}
+
+RecordTable::RecordTable(Filter::Level _level)
+    : level_(_level), values_(specs(_level).size()) {}
+
+RecordTable::~RecordTable() {}
+
+std::vector<RecordTable::Column> RecordTable::columns(Filter::Level _level) {
+  std::vector<Column> columns;
+  for (const Spec& spec : specs(_level)) {
+    bool time = spec.source == Source::START || spec.source == Source::END;
+    columns.push_back({spec.name, time ? Type::F64 : Type::U64});
+  }
+  return columns;
+}
+
+Filter::Level RecordTable::level() const {
+  return level_;
+}
+
+u64 RecordTable::rows() const {
+  return values_.at(0).size();
+}
+
+void RecordTable::add(const Filter::Record& _record, u32 _msgId,
+                      u32 _pktId) {
+  assert(_record.level == level_);
+  const std::vector<Spec>& columns = specs(level_);
+  for (u32 col = 0; col < columns.size(); col++) {
+    u64 value = 0;
+    switch (columns[col].source) {
+      case Source::START:
+        value = bits(_record.times[0]);
+        break;
+      case Source::END:
+        value = bits(_record.times[1]);
+        break;
+      case Source::FIELD:
+        value = _record.ints[columns[col].field];
+        break;
+      case Source::MESSAGE_ID:
+        value = _msgId;
+        break;
+      case Source::PACKET_ID:
+        value = _pktId;
+        break;
+    }
+    values_[col].push_back(value);
+  }
+}
+
+void RecordTable::add(const Filter::Columns& _batch, u32 _row, u32 _msgId,
+                      u32 _pktId) {
+  assert(_batch.level == level_ && _row < _batch.size);
+  const std::vector<Spec>& columns = specs(level_);
+  for (u32 col = 0; col < columns.size(); col++) {
+    u64 value = 0;
+    switch (columns[col].source) {
+      case Source::START:
+        value = bits(_batch.times[0][_row]);
+        break;
+      case Source::END:
+        value = bits(_batch.times[1][_row]);
+        break;
+      case Source::FIELD:
+        value = _batch.ints[columns[col].field][_row];
+        break;
+      case Source::MESSAGE_ID:
+        value = _msgId;
+        break;
+      case Source::PACKET_ID:
+        value = _pktId;
+        break;
+    }
+    values_[col].push_back(value);
+  }
+}
+
+void RecordTable::append(const RecordTable& _other) {
+  assert(_other.level_ == level_);
+  for (u32 col = 0; col < values_.size(); col++) {
+    values_[col].insert(values_[col].end(), _other.values_[col].begin(),
+                        _other.values_[col].end());
+  }
+}
+
+void RecordTable::clear() {
+  for (std::vector<u64>& values : values_) {
+    values.clear();
+  }
+}
+
+const std::vector<u64>& RecordTable::values(u32 _column) const {
+  return values_.at(_column);
+}
+
+bool isTableFile(const std::string& _filename) {
+  u64 size = sizeof(TABLE_EXTENSION) - 1;
+  return _filename.size() > size &&
+         _filename.compare(_filename.size() - size, size, TABLE_EXTENSION) ==
+             0;
+}
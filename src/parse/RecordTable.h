@@ -0,0 +1,98 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_RECORDTABLE_H_
+#define PARSE_RECORDTABLE_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/Filter.h"
+
+// The record table format (.rtab) stores the records of one level column by
+// column so that analysis tools can map the file and use each column as an
+// array without parsing. A file starts with the 8 byte TABLE_MAGIC, the level
+// and the column count as u64s, and a 32 byte descriptor per column: its name
+// padded with zeros to 24 bytes and its type as a u64. Row groups follow until
+// the end of the file, each is its row count as a u64 followed by the values
+// of each column in turn. All values are 8 bytes wide and little-endian, so
+// every column is 8 byte aligned.
+//
+// Besides the fields of their records, message and packet tables hold the
+// message id and packet tables the packet id, so (transaction_id, message_id,
+// packet_id) joins the records of the levels.
+
+extern const char TABLE_MAGIC[8];
+
+// the file name extension that selects a record table over text
+extern const char TABLE_EXTENSION[6];
+
+// This class holds records of one level column by column.
+class RecordTable {
+ public:
+  enum class Type : u64 { U64, F64 };
+
+  struct Column {
+    const char* name;
+    Type type;
+  };
+
+  explicit RecordTable(Filter::Level _level = Filter::Level::TRANSACTION);
+  ~RecordTable();
+
+  // the columns of the table of each level
+  static std::vector<Column> columns(Filter::Level _level);
+
+  Filter::Level level() const;
+  u64 rows() const;
+
+  // appends a record, the ids are ignored by the levels that don't hold them
+  void add(const Filter::Record& _record, u32 _msgId, u32 _pktId);
+  void add(const Filter::Columns& _batch, u32 _row, u32 _msgId, u32 _pktId);
+
+  // appends the rows of a table of the same level
+  void append(const RecordTable& _other);
+
+  void clear();
+
+  // the values of a column, f64 values are stored as their bits
+  const std::vector<u64>& values(u32 _column) const;
+
+ private:
+  Filter::Level level_;
+  std::vector<std::vector<u64> > values_;  // [column][row]
+};
+
+// returns true if the filename ends with TABLE_EXTENSION
+bool isTableFile(const std::string& _filename);
+
+#endif  // PARSE_RECORDTABLE_H_
@@ -0,0 +1,157 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RecordTable.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "parse/TableWriter.h"
+
+static std::vector<u64> readWords(const std::string& _filename) {
+  std::ifstream file(_filename, std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_EQ(bytes.size() % sizeof(u64), 0u);
+  std::vector<u64> words(bytes.size() / sizeof(u64));
+  std::memcpy(words.data(), bytes.data(), bytes.size());
+  return words;
+}
+
+static f64 toF64(u64 _bits) {
+  f64 value;
+  std::memcpy(&value, &_bits, sizeof(value));
+  return value;
+}
+
+TEST(RecordTable, columns) {
+  // each level holds the ids that join it to the others
+  std::vector<RecordTable::Column> columns =
+      RecordTable::columns(Filter::Level::PACKET);
+  ASSERT_EQ(columns.size(), 14u);
+  ASSERT_STREQ(columns.at(0).name, "transaction_id");
+  ASSERT_STREQ(columns.at(1).name, "message_id");
+  ASSERT_STREQ(columns.at(2).name, "packet_id");
+  ASSERT_EQ(columns.at(8).type, RecordTable::Type::F64);
+  ASSERT_EQ(RecordTable::columns(Filter::Level::MESSAGE).size(), 12u);
+  ASSERT_EQ(RecordTable::columns(Filter::Level::TRANSACTION).size(), 7u);
+  for (const RecordTable::Column& column : columns) {
+    ASSERT_LT(std::strlen(column.name), 24u);
+  }
+}
+
+TEST(RecordTable, add) {
+  // records and batch rows give the same values
+  Filter::Columns batch(4);
+  RecordTable records(Filter::Level::MESSAGE);
+  for (u32 row = 0; row < 3; row++) {
+    Filter::Record record = {};
+    Filter::messageRecord(row, row + 1, (3lu << 56) | row, 1, 2, row * 1.5,
+                          row * 2.5, 3, 4, 5, &record);
+    records.add(record, 10 + row, 0);
+    batch.add(record);
+  }
+  RecordTable rows(Filter::Level::MESSAGE);
+  for (u32 row = 0; row < 3; row++) {
+    rows.add(batch, row, 10 + row, 0);
+  }
+  ASSERT_EQ(records.rows(), 3u);
+  ASSERT_EQ(rows.rows(), 3u);
+  std::vector<RecordTable::Column> columns =
+      RecordTable::columns(Filter::Level::MESSAGE);
+  for (u32 col = 0; col < columns.size(); col++) {
+    ASSERT_EQ(records.values(col), rows.values(col));
+  }
+  ASSERT_EQ(records.values(1), std::vector<u64>({10, 11, 12}));  // message_id
+  ASSERT_EQ(records.values(2), std::vector<u64>({3, 3, 3}));  // application
+  ASSERT_EQ(toF64(records.values(8).at(2)), 5.0);             // end
+
+  // tables are appended in order
+  records.append(rows);
+  ASSERT_EQ(records.rows(), 6u);
+  ASSERT_EQ(records.values(3).at(4), 1u);
+  records.clear();
+  ASSERT_EQ(records.rows(), 0u);
+}
+
+TEST(RecordTable, write) {
+  std::string filename = "RecordTable_TEST_write.rtab";
+  ASSERT_TRUE(isTableFile(filename));
+  ASSERT_FALSE(isTableFile("packets.csv"));
+  ASSERT_FALSE(isTableFile(".rtab"));
+
+  // more rows than a group
+  const u64 ROWS = TableWriter::GROUP_ROWS + 100;
+  {
+    TableWriter writer(filename, Filter::Level::TRANSACTION);
+    for (u64 row = 0; row < ROWS; row++) {
+      Filter::Record record = {};
+      Filter::transactionRecord(row, row * 0.5, row + 1.0, 1, 2, 3, &record);
+      writer.add(record);
+    }
+    writer.complete();
+  }
+
+  // header
+  std::vector<u64> words = readWords(filename);
+  ASSERT_EQ(std::memcmp(words.data(), TABLE_MAGIC, sizeof(TABLE_MAGIC)), 0);
+  ASSERT_EQ(words.at(1), (u64)Filter::Level::TRANSACTION);
+  u64 count = words.at(2);
+  ASSERT_EQ(count, 7u);
+  const char* name = reinterpret_cast<const char*>(&words.at(3 + 4 * 2));
+  ASSERT_STREQ(name, "start");
+  ASSERT_EQ(words.at(3 + 4 * 2 + 3), (u64)RecordTable::Type::F64);
+
+  // row groups
+  u64 pos = 3 + 4 * count;
+  u64 total = 0;
+  while (pos < words.size()) {
+    u64 rows = words.at(pos++);
+    ASSERT_GT(rows, 0u);
+    for (u64 row = 0; row < rows; row++) {
+      u64 id = total + row;
+      ASSERT_EQ(words.at(pos + row), id);                          // id
+      ASSERT_EQ(toF64(words.at(pos + 2 * rows + row)), id * 0.5);  // start
+      ASSERT_EQ(words.at(pos + 6 * rows + row), 3u);               // flits
+    }
+    pos += count * rows;
+    total += rows;
+  }
+  ASSERT_EQ(pos, words.size());
+  ASSERT_EQ(total, ROWS);
+  std::remove(filename.c_str());
+}
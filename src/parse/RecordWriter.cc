@@ -0,0 +1,246 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RecordWriter.h"
+
+#include <ex/Exception.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <cassert>
+#include <charconv>
+#include <utility>
+
+static bool endsWith(const std::string& _str, const std::string& _suffix) {
+  return _str.size() >= _suffix.size() &&
+         _str.compare(_str.size() - _suffix.size(), _suffix.size(),
+                      _suffix) == 0;
+}
+
+// compresses the text into a complete gzip member
+static std::string gzipChunk(const std::string& _text) {
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw ex::Exception("Unable to initialize zlib\n");
+  }
+  std::string out(deflateBound(&stream, _text.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(_text.data()));
+  stream.avail_in = _text.size();
+  stream.next_out = reinterpret_cast<Bytef*>(out.data());
+  stream.avail_out = out.size();
+  int ret = deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (ret != Z_STREAM_END) {
+    throw ex::Exception("Error while compressing output (zlib %d)\n", ret);
+  }
+  return out;
+}
+
+// compresses the text into a complete zstd frame
+static std::string zstdChunk(const std::string& _text) {
+  std::string out(ZSTD_compressBound(_text.size()), '\0');
+  size_t size = ZSTD_compress(out.data(), out.size(), _text.data(),
+                              _text.size(), ZSTD_CLEVEL_DEFAULT);
+  if (ZSTD_isError(size)) {
+    throw ex::Exception("Error while compressing output (%s)\n",
+                        ZSTD_getErrorName(size));
+  }
+  out.resize(size);
+  return out;
+}
+
+RecordWriter::RecordWriter(const std::string& _filename)
+    : filename_(_filename), done_(false) {
+  if (endsWith(filename_, ".gz")) {
+    compression_ = Compression::GZIP;
+  } else if (endsWith(filename_, ".zst")) {
+    compression_ = Compression::ZSTD;
+  } else {
+    compression_ = Compression::NONE;
+  }
+  file_ = std::fopen(filename_.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw ex::Exception("Unable to open output file: %s\n", filename_.c_str());
+  }
+  buffer_.reserve(CHUNK_SIZE);
+  writer_ = std::thread(&RecordWriter::writeLoop, this);
+}
+
+RecordWriter::~RecordWriter() {
+  if (file_ != nullptr) {
+    try {
+      flush();
+    } catch (...) {
+      // complete() reports errors
+    }
+    stop();
+    std::fclose(file_);
+  }
+}
+
+void RecordWriter::write(std::string_view _text) {
+  buffer_.append(_text);
+  if (buffer_.size() >= CHUNK_SIZE) {
+    flush();
+  }
+}
+
+void RecordWriter::flush() {
+  if (buffer_.empty()) {
+    return;
+  }
+
+  // wait for room before starting another chunk
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() {
+      return pending_.size() < MAX_PENDING || error_ != nullptr;
+    });
+  }
+  checkError();
+
+  // the chunk is compressed in the background
+  std::future<std::string> chunk;
+  switch (compression_) {
+    case Compression::NONE: {
+      std::promise<std::string> text;
+      text.set_value(std::move(buffer_));
+      chunk = text.get_future();
+      break;
+    }
+    case Compression::GZIP:
+      chunk = std::async(std::launch::async, gzipChunk, std::move(buffer_));
+      break;
+    case Compression::ZSTD:
+      chunk = std::async(std::launch::async, zstdChunk, std::move(buffer_));
+      break;
+  }
+  buffer_ = std::string();
+  buffer_.reserve(CHUNK_SIZE);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(chunk));
+  }
+  changed_.notify_all();
+}
+
+void RecordWriter::complete() {
+  flush();
+  stop();
+  FILE* file = file_;
+  file_ = nullptr;
+  if (std::fclose(file) != 0) {
+    throw ex::Exception("Error while writing output file: %s\n",
+                        filename_.c_str());
+  }
+  checkError();
+}
+
+void RecordWriter::writeLoop() {
+  // the writer thread mostly waits, so it blocks instead of spinning like the
+  // parse pipeline
+  bool failed = false;
+  while (true) {
+    std::future<std::string> chunk;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [this]() { return !pending_.empty() || done_; });
+      if (pending_.empty()) {
+        return;
+      }
+      chunk = std::move(pending_.front());
+    }
+
+    // the chunk stays pending until it is written
+    std::exception_ptr error;
+    try {
+      std::string data = chunk.get();
+      if (!failed &&
+          std::fwrite(data.data(), 1, data.size(), file_) != data.size()) {
+        throw ex::Exception("Error while writing output file: %s\n",
+                            filename_.c_str());
+      }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_.pop_front();
+      if (error && !failed) {
+        error_ = error;
+        failed = true;
+      }
+    }
+    changed_.notify_all();
+  }
+}
+
+void RecordWriter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  changed_.notify_all();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+void RecordWriter::checkError() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+void appendU64(u64 _value, std::string* _text) {
+  char chars[20];
+  std::to_chars_result res = std::to_chars(chars, chars + sizeof(chars),
+                                           _value);
+  assert(res.ec == std::errc());
+  _text->append(chars, res.ptr);
+}
+
+void appendTime(f64 _time, bool _fixed, std::string* _text) {
+  // the fixed text of the largest double has 309 integer digits
+  char chars[320];
+  std::to_chars_result res;
+  if (_fixed) {
+    res = std::to_chars(chars, chars + sizeof(chars), _time,
+                        std::chars_format::fixed, 6);
+  } else {
+    res = std::to_chars(chars, chars + sizeof(chars), _time);
+  }
+  assert(res.ec == std::errc());
+  _text->append(chars, res.ptr);
+}
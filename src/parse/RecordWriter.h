@@ -0,0 +1,97 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_RECORDWRITER_H_
+#define PARSE_RECORDWRITER_H_
+
+#include <prim/prim.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// This class buffers the text of an output file and writes it to the file in
+// large chunks. Full chunks are handed to a writer thread so that the caller
+// never waits on the file. Files named *.gz or *.zst are compressed chunk by
+// chunk in parallel, each chunk becoming its own gzip member or zstd frame,
+// and the members are written in order, which any gzip or zstd reader accepts
+// as one stream. At most MAX_PENDING chunks are in flight, beyond that
+// writing waits for the oldest chunk.
+class RecordWriter {
+ public:
+  static constexpr u64 CHUNK_SIZE = 4 << 20;
+  static const u32 MAX_PENDING = 8;
+
+  explicit RecordWriter(const std::string& _filename);
+  ~RecordWriter();  // flushes, errors are only reported by complete()
+
+  void write(std::string_view _text);
+
+  // hands the buffered text to the writer thread
+  void flush();
+
+  // writes everything and closes the file
+  void complete();
+
+ private:
+  enum class Compression { NONE, GZIP, ZSTD };
+
+  void writeLoop();
+  void stop();
+  void checkError();
+
+  const std::string filename_;
+  Compression compression_;
+  FILE* file_;
+  std::string buffer_;
+
+  // chunks in file order, the writer thread waits for each one
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<std::future<std::string> > pending_;
+  bool done_;
+  std::exception_ptr error_;  // the first error of the writer thread
+  std::thread writer_;
+};
+
+// appends the decimal text of the value
+void appendU64(u64 _value, std::string* _text);
+
+// appends the shortest text that reads back as the same time, or with _fixed
+// the 6 decimal text of std::to_string
+void appendTime(f64 _time, bool _fixed, std::string* _text);
+
+#endif  // PARSE_RECORDWRITER_H_
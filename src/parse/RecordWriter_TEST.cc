@@ -0,0 +1,178 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RecordWriter.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parse/TestData_TEST.h"
+
+// reads a file written as several gzip members
+static std::string readGzip(const std::string& _filename) {
+  gzFile file = gzopen(_filename.c_str(), "rb");
+  EXPECT_NE(file, nullptr);
+  std::string text;
+  char buf[1 << 16];
+  int size;
+  while ((size = gzread(file, buf, sizeof(buf))) > 0) {
+    text.append(buf, size);
+  }
+  gzclose(file);
+  return text;
+}
+
+// reads a file written as several zstd frames
+static std::string readZstd(const std::string& _filename) {
+  std::string data = readFile(_filename);
+  ZSTD_DCtx* context = ZSTD_createDCtx();
+  ZSTD_inBuffer in = {data.data(), data.size(), 0};
+  std::vector<char> buf(ZSTD_DStreamOutSize());
+  std::string text;
+  while (in.pos < in.size) {
+    ZSTD_outBuffer out = {buf.data(), buf.size(), 0};
+    size_t ret = ZSTD_decompressStream(context, &out, &in);
+    EXPECT_FALSE(ZSTD_isError(ret));
+    if (ZSTD_isError(ret)) {
+      break;
+    }
+    text.append(buf.data(), out.pos);
+  }
+  ZSTD_freeDCtx(context);
+  return text;
+}
+
+// writes more text than several chunks, returns the text
+static std::string writeRows(const std::string& _filename) {
+  std::string expected;
+  RecordWriter writer(_filename);
+  std::string line;
+  for (u64 row = 0; expected.size() <= 3 * RecordWriter::CHUNK_SIZE; row++) {
+    line.clear();
+    appendU64(row, &line);
+    line += ',';
+    appendTime(row * 0.25, false, &line);
+    line += '\n';
+    writer.write(line);
+    expected += line;
+  }
+  writer.complete();
+  return expected;
+}
+
+TEST(RecordWriter, appendU64) {
+  std::string text;
+  appendU64(0, &text);
+  text += ',';
+  appendU64(U64_MAX, &text);
+  ASSERT_EQ(text, "0,18446744073709551615");
+}
+
+TEST(RecordWriter, fixedTimes) {
+  // the fixed text matches std::to_string
+  std::mt19937_64 rnd(12345);
+  std::uniform_real_distribution<f64> small(0.0, 1.0);
+  for (u32 i = 0; i < 100000; i++) {
+    f64 time;
+    switch (i % 3) {
+      case 0:
+        time = (f64)(rnd() % 100000000);
+        break;
+      case 1:
+        time = (f64)(rnd() % 100000000) * 0.001;
+        break;
+      default:
+        time = small(rnd) * 1e12;
+        break;
+    }
+    std::string text;
+    appendTime(time, true, &text);
+    ASSERT_EQ(text, std::to_string(time));
+  }
+}
+
+TEST(RecordWriter, shortestTimes) {
+  std::string text;
+  appendTime(9190000.0, false, &text);
+  ASSERT_EQ(text, "9190000");
+  text.clear();
+  appendTime(0.5, false, &text);
+  ASSERT_EQ(text, "0.5");
+
+  // the shortest text reads back as the same time
+  std::mt19937_64 rnd(12345);
+  for (u32 i = 0; i < 100000; i++) {
+    f64 time = (f64)(rnd() % 100000000) * 0.001;
+    text.clear();
+    appendTime(time, false, &text);
+    ASSERT_EQ(std::strtod(text.c_str(), nullptr), time);
+  }
+}
+
+TEST(RecordWriter, write) {
+  // chunks are written in order
+  std::string filename = "RecordWriter_TEST_write.csv";
+  std::string expected = writeRows(filename);
+  ASSERT_EQ(readFile(filename), expected);
+  std::remove(filename.c_str());
+
+  // without complete() the destructor writes everything
+  {
+    RecordWriter writer(filename);
+    writer.write("1,2\n");
+  }
+  ASSERT_EQ(readFile(filename), "1,2\n");
+  std::remove(filename.c_str());
+}
+
+TEST(RecordWriter, compressed) {
+  std::string filename = "RecordWriter_TEST_compressed.csv.gz";
+  std::string expected = writeRows(filename);
+  ASSERT_EQ(readGzip(filename), expected);
+  std::remove(filename.c_str());
+
+  filename = "RecordWriter_TEST_compressed.csv.zst";
+  expected = writeRows(filename);
+  ASSERT_EQ(readZstd(filename), expected);
+  std::remove(filename.c_str());
+}
+
+TEST(RecordWriter, openError) {
+  ASSERT_THROW(RecordWriter("no/such/dir/out.csv"), ex::Exception);
+}
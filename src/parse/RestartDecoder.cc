@@ -0,0 +1,173 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/RestartDecoder.h"
+
+#include <ex/Exception.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+RestartDecoder::RestartDecoder(const std::string& _filename, u64 _pieceSize)
+    : filename_(_filename),
+      fd_(-1),
+      map_(nullptr),
+      mapSize_(0),
+      format_(Format::PLAIN),
+      pieceSize_(_pieceSize),
+      bit_(0),
+      textOffset_(0),
+      done_(false),
+      window_(Inflater::WINDOW_SIZE, 0),
+      windowSize_(0) {
+  fd_ = open(filename_.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw ex::Exception("Unable to open input file: %s\n", filename_.c_str());
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+    throw ex::Exception("Input file is not a regular file: %s\n",
+                        filename_.c_str());
+  }
+  mapSize_ = st.st_size;
+  if (mapSize_ > 0) {
+    void* map = mmap(nullptr, mapSize_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED) {
+      throw ex::Exception("Unable to map input file: %s\n", filename_.c_str());
+    }
+    map_ = static_cast<const u8*>(map);
+  }
+
+  format_ = detectFormat(reinterpret_cast<const char*>(map_), mapSize_);
+  if (format_ == Format::GZIP) {
+    inflater_ = std::make_unique<Inflater>(map_, mapSize_);
+    if (!inflater_->gzipHeader(0, &bit_)) {
+      throw ex::Exception("Invalid gzip header\n");
+    }
+  } else if (format_ != Format::PLAIN) {
+    throw ex::Exception("Only plain and gzip files can be indexed: %s\n",
+                        filename_.c_str());
+  }
+}
+
+RestartDecoder::~RestartDecoder() {
+  inflater_.reset();
+  if (map_ != nullptr) {
+    munmap(const_cast<u8*>(map_), mapSize_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+Format RestartDecoder::format() const {
+  return format_;
+}
+
+void RestartDecoder::seek(u64 _bit, u64 _textOffset,
+                          const std::vector<u8>& _window) {
+  bit_ = _bit;
+  textOffset_ = _textOffset;
+  done_ = false;
+  windowSize_ = 0;
+  slideWindow(_window.data(), _window.size());
+}
+
+bool RestartDecoder::read(std::vector<char>* _buffer) {
+  if (done_) {
+    return false;
+  }
+
+  if (format_ == Format::PLAIN) {
+    u64 pos = bit_ >> 3;
+    u64 size = std::min(pieceSize_, mapSize_ - std::min(pos, mapSize_));
+    _buffer->insert(_buffer->end(), map_ + pos, map_ + pos + size);
+    bit_ += size << 3;
+    textOffset_ += size;
+    done_ = (bit_ >> 3) == mapSize_;
+    return size > 0;
+  }
+
+  // decode up to the first deflate block boundary after a piece of input
+  Inflater::Output output;
+  u64 stop = (pieceSize_ << 3) < (mapSize_ << 3) - bit_
+                 ? bit_ + (pieceSize_ << 3)
+                 : U64_MAX;
+  const u8* window = window_.data() + (Inflater::WINDOW_SIZE - windowSize_);
+  if (!inflater_->decode(bit_, stop, window, windowSize_, &output)) {
+    throw ex::Exception("Error while decompressing input file: %s\n",
+                        filename_.c_str());
+  }
+  u64 offset = _buffer->size();
+  u64 size = output.size();
+  _buffer->resize(offset + size);
+  u8* dst = reinterpret_cast<u8*>(_buffer->data() + offset);
+  output.resolve(window_.data(), dst);
+  slideWindow(dst, size);
+  bit_ = output.endBit;
+  textOffset_ += size;
+  done_ = output.streamEnd;
+  if (!done_ && size == 0 && bit_ >= (mapSize_ << 3)) {
+    throw ex::Exception("Input file is truncated: %s\n", filename_.c_str());
+  }
+  return true;
+}
+
+u64 RestartDecoder::bit() const {
+  return bit_;
+}
+
+u64 RestartDecoder::textOffset() const {
+  return textOffset_;
+}
+
+void RestartDecoder::window(std::vector<u8>* _window) const {
+  if (format_ == Format::PLAIN) {
+    _window->clear();
+    return;
+  }
+  _window->assign(window_.end() - windowSize_, window_.end());
+}
+
+void RestartDecoder::slideWindow(const u8* _data, u64 _size) {
+  if (_size >= Inflater::WINDOW_SIZE) {
+    std::memcpy(window_.data(), _data + _size - Inflater::WINDOW_SIZE,
+                Inflater::WINDOW_SIZE);
+  } else {
+    std::memmove(window_.data(), window_.data() + _size,
+                 Inflater::WINDOW_SIZE - _size);
+    std::memcpy(window_.data() + Inflater::WINDOW_SIZE - _size, _data, _size);
+  }
+  windowSize_ = std::min<u64>(windowSize_ + _size, Inflater::WINDOW_SIZE);
+}
@@ -0,0 +1,85 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_RESTARTDECODER_H_
+#define PARSE_RESTARTDECODER_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parse/Codec.h"
+#include "parse/Inflater.h"
+
+// This class decodes the text of a plain or gzip message log from any restart
+// point. A restart point is a byte offset of a plain file or a deflate block
+// boundary of a gzip file together with the window preceding it. Every piece
+// of text ends at a restart point.
+class RestartDecoder {
+ public:
+  RestartDecoder(const std::string& _filename, u64 _pieceSize = 1 << 16);
+  ~RestartDecoder();
+
+  Format format() const;
+
+  // continues decoding at a restart point
+  void seek(u64 _bit, u64 _textOffset, const std::vector<u8>& _window);
+
+  // appends the next piece of text to _buffer, returns false at the end
+  bool read(std::vector<char>* _buffer);
+
+  // the restart point after the last piece
+  u64 bit() const;
+  u64 textOffset() const;
+  void window(std::vector<u8>* _window) const;
+
+ private:
+  void slideWindow(const u8* _data, u64 _size);
+
+  std::string filename_;
+  s32 fd_;
+  const u8* map_;
+  u64 mapSize_;
+  Format format_;
+  const u64 pieceSize_;
+  std::unique_ptr<Inflater> inflater_;
+
+  u64 bit_;
+  u64 textOffset_;
+  bool done_;
+
+  // the last WINDOW_SIZE bytes of text, zero padded at the front
+  std::vector<u8> window_;
+  u64 windowSize_;
+};
+
+#endif  // PARSE_RESTARTDECODER_H_
@@ -0,0 +1,156 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_SPSCRING_H_
+#define PARSE_SPSCRING_H_
+
+#include <prim/prim.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// This is a bounded lock-free ring buffer between exactly one producer thread
+// and one consumer thread. A side that finds the ring full or empty spins and
+// yields for a bounded number of rounds, then sleeps on a condition variable
+// until the other side moves an item or the ring is closed. The mutex is only
+// taken when a side actually sleeps.
+template <typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(u64 _capacity);
+  ~SpscRing();
+
+  // blocks while the ring is full, returns false if the ring was closed
+  bool push(T&& _item);
+
+  // blocks while the ring is empty, returns false once the ring is closed and
+  // drained
+  bool pop(T* _item);
+
+  // wakes up both sides, called by either side when it stops
+  void close();
+
+ private:
+  // returns once _ready() holds or the ring is closed
+  template <typename Ready>
+  void wait(Ready _ready);
+
+  // wakes up the other side if it is sleeping
+  void wake();
+
+  std::vector<T> slots_;
+  alignas(64) std::atomic<u64> head_;  // next slot to pop
+  alignas(64) std::atomic<u64> tail_;  // next slot to push
+  alignas(64) std::atomic<bool> closed_;
+  alignas(64) std::atomic<u32> sleepers_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(u64 _capacity)
+    : slots_(_capacity), head_(0), tail_(0), closed_(false), sleepers_(0) {}
+
+template <typename T>
+SpscRing<T>::~SpscRing() {}
+
+template <typename T>
+bool SpscRing<T>::push(T&& _item) {
+  u64 tail = tail_.load(std::memory_order_relaxed);
+  wait([&]() {
+    return tail - head_.load(std::memory_order_acquire) != slots_.size();
+  });
+  if (closed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  slots_[tail % slots_.size()] = std::move(_item);
+  tail_.store(tail + 1, std::memory_order_release);
+  wake();
+  return true;
+}
+
+template <typename T>
+bool SpscRing<T>::pop(T* _item) {
+  u64 head = head_.load(std::memory_order_relaxed);
+  wait([&]() { return tail_.load(std::memory_order_acquire) != head; });
+  // the producer may have pushed right before closing
+  if (tail_.load(std::memory_order_acquire) == head) {
+    return false;
+  }
+  *_item = std::move(slots_[head % slots_.size()]);
+  head_.store(head + 1, std::memory_order_release);
+  wake();
+  return true;
+}
+
+template <typename T>
+void SpscRing<T>::close() {
+  closed_.store(true, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(mutex_);
+  cond_.notify_all();
+}
+
+template <typename T>
+template <typename Ready>
+void SpscRing<T>::wait(Ready _ready) {
+  auto done = [&]() {
+    return _ready() || closed_.load(std::memory_order_acquire);
+  };
+  // spin briefly, then give the core to the other stages, then sleep
+  for (u64 spins = 0; spins < 128; spins++) {
+    if (done()) {
+      return;
+    }
+    if (spins >= 64) {
+      std::this_thread::yield();
+    }
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  // pairs with the fence in wake() so one side always sees the other
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cond_.wait(lock, done);
+  sleepers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template <typename T>
+void SpscRing<T>::wake() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleepers_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cond_.notify_all();
+  }
+}
+
+#endif  // PARSE_SPSCRING_H_
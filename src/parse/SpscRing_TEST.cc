@@ -0,0 +1,112 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/SpscRing.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+TEST(SpscRing, order) {
+  SpscRing<u64> ring(3);
+  const u64 count = 200000;
+  std::thread producer([&]() {
+    for (u64 i = 0; i < count; i++) {
+      ASSERT_TRUE(ring.push(u64(i)));
+    }
+    ring.close();
+  });
+  u64 value;
+  u64 expected = 0;
+  while (ring.pop(&value)) {
+    ASSERT_EQ(value, expected);
+    expected++;
+  }
+  producer.join();
+  ASSERT_EQ(expected, count);
+}
+
+TEST(SpscRing, drainAfterClose) {
+  SpscRing<std::unique_ptr<u64> > ring(4);
+  for (u64 i = 0; i < 4; i++) {
+    ASSERT_TRUE(ring.push(std::make_unique<u64>(i)));
+  }
+  ring.close();
+  ASSERT_FALSE(ring.push(std::make_unique<u64>(4)));
+  std::unique_ptr<u64> value;
+  for (u64 i = 0; i < 4; i++) {
+    ASSERT_TRUE(ring.pop(&value));
+    ASSERT_EQ(*value, i);
+  }
+  ASSERT_FALSE(ring.pop(&value));
+}
+
+TEST(SpscRing, consumerStops) {
+  SpscRing<u64> ring(2);
+  std::thread producer([&]() {
+    u64 i = 0;
+    while (ring.push(u64(i))) {
+      i++;
+    }
+  });
+  u64 value;
+  ASSERT_TRUE(ring.pop(&value));
+  ring.close();
+  producer.join();
+}
+
+TEST(SpscRing, sleepingSides) {
+  // long pauses on each side push the other one past its spin budget
+  SpscRing<u64> ring(2);
+  const u64 count = 20;
+  std::thread producer([&]() {
+    for (u64 i = 0; i < count; i++) {
+      if (i % 5 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+      ASSERT_TRUE(ring.push(u64(i)));
+    }
+    ring.close();
+  });
+  u64 value;
+  u64 expected = 0;
+  while (ring.pop(&value)) {
+    ASSERT_EQ(value, expected);
+    expected++;
+    if (expected % 7 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+  producer.join();
+  ASSERT_EQ(expected, count);
+}
@@ -0,0 +1,111 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/TableWriter.h"
+
+#include <ex/Exception.h>
+
+#include <cstring>
+#include <vector>
+
+TableWriter::TableWriter(const std::string& _filename, Filter::Level _level)
+    : filename_(_filename), group_(_level) {
+  file_ = std::fopen(filename_.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw ex::Exception("Unable to open output file: %s\n", filename_.c_str());
+  }
+
+  // header
+  std::vector<RecordTable::Column> columns = RecordTable::columns(_level);
+  u64 level = static_cast<u64>(_level);
+  u64 count = columns.size();
+  write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+  write(&level, sizeof(level));
+  write(&count, sizeof(count));
+  for (const RecordTable::Column& column : columns) {
+    char name[24] = {};
+    std::strncpy(name, column.name, sizeof(name) - 1);
+    u64 type = static_cast<u64>(column.type);
+    write(name, sizeof(name));
+    write(&type, sizeof(type));
+  }
+}
+
+TableWriter::~TableWriter() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+void TableWriter::add(const Filter::Record& _record) {
+  group_.add(_record, 0, 0);
+  flushIfFull();
+}
+
+void TableWriter::append(const RecordTable& _table) {
+  group_.append(_table);
+  flushIfFull();
+}
+
+void TableWriter::complete() {
+  flush();
+  if (std::fclose(file_) != 0) {
+    file_ = nullptr;
+    throw ex::Exception("Error while writing output file: %s\n",
+                        filename_.c_str());
+  }
+  file_ = nullptr;
+}
+
+void TableWriter::flushIfFull() {
+  if (group_.rows() >= GROUP_ROWS) {
+    flush();
+  }
+}
+
+void TableWriter::flush() {
+  u64 rows = group_.rows();
+  if (rows == 0) {
+    return;
+  }
+  u32 columns = RecordTable::columns(group_.level()).size();
+  write(&rows, sizeof(rows));
+  for (u32 col = 0; col < columns; col++) {
+    write(group_.values(col).data(), rows * sizeof(u64));
+  }
+  group_.clear();
+}
+
+void TableWriter::write(const void* _data, u64 _size) {
+  if (std::fwrite(_data, 1, _size, file_) != _size) {
+    throw ex::Exception("Error while writing output file: %s\n",
+                        filename_.c_str());
+  }
+}
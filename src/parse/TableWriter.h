@@ -0,0 +1,67 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_TABLEWRITER_H_
+#define PARSE_TABLEWRITER_H_
+
+#include <prim/prim.h>
+
+#include <cstdio>
+#include <string>
+
+#include "parse/Filter.h"
+#include "parse/RecordTable.h"
+
+// This class writes records of one level as a record table (.rtab). Rows are
+// collected into row groups of at least GROUP_ROWS rows.
+class TableWriter {
+ public:
+  static const u64 GROUP_ROWS = 1 << 16;
+
+  TableWriter(const std::string& _filename, Filter::Level _level);
+  ~TableWriter();
+
+  void add(const Filter::Record& _record);
+  void append(const RecordTable& _table);
+
+  // writes the last row group and closes the file
+  void complete();
+
+ private:
+  void flushIfFull();
+  void flush();
+  void write(const void* _data, u64 _size);
+
+  std::string filename_;
+  FILE* file_;
+  RecordTable group_;
+};
+
+#endif  // PARSE_TABLEWRITER_H_
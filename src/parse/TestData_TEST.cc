@@ -0,0 +1,159 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/TestData_TEST.h"
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "parse/Engine.h"
+#include "parse/Parser.h"
+#include "parse/Reader.h"
+
+std::string randomLog(u64 _transactions, u64 _maxOpen) {
+  std::mt19937_64 rnd(12345);
+  std::ostringstream log;
+  std::vector<u64> open;
+  u64 time = 1000;
+  for (u64 trans = 0; trans < _transactions || !open.empty();) {
+    if (trans < _transactions &&
+        (open.empty() || (open.size() < _maxOpen && rnd() % 2 == 0))) {
+      u64 transId = (trans % 3) << 56 | trans;
+      log << "+T," << transId << "," << time << "\n";
+      open.push_back(transId);
+      trans++;
+    }
+    u64 index = rnd() % open.size();
+    u64 transId = open.at(index);
+    if (rnd() % 3 == 0) {
+      log << "-T," << transId << "," << time + 200 << "\n";
+      open.erase(open.begin() + index);
+      continue;
+    }
+    log << " +M," << rnd() % 10 << "," << rnd() % 64 << "," << rnd() % 64
+        << "," << transId << "," << rnd() % 4 << "," << rnd() % 5 << ","
+        << rnd() % 10 << "\n";
+    u32 pkts = 1 + rnd() % 3;
+    for (u32 pkt = 0; pkt < pkts; pkt++) {
+      log << "  +P," << pkt << "," << rnd() % 8 << "\n";
+      u32 flits = 1 + rnd() % 4;
+      for (u32 flit = 0; flit < flits; flit++) {
+        log << "   F," << flit << "," << time + flit << ","
+            << time + flit + 10 + rnd() % 100 << "\n";
+      }
+      log << "  -P\n";
+    }
+    log << " -M\n";
+    time += rnd() % 5;
+  }
+  return log.str();
+}
+
+std::string numberedText(u64 _lines) {
+  std::string text;
+  for (u64 line = 0; line < _lines; line++) {
+    text += "   F," + std::to_string(line) + "," +
+            std::string(line % 300, 'x') + "\n";
+  }
+  return text;
+}
+
+std::string gzipText(const std::string& _text, s32 _level) {
+  z_stream stream = {};
+  EXPECT_EQ(deflateInit2(&stream, _level, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY),
+            Z_OK);
+  std::string out(deflateBound(&stream, _text.size()) + 64, '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(_text.data()));
+  stream.avail_in = _text.size();
+  stream.next_out = reinterpret_cast<Bytef*>(out.data());
+  stream.avail_out = out.size();
+  EXPECT_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return out;
+}
+
+std::string readFile(const std::string& _filename) {
+  std::ifstream file(_filename);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::string writeLog(const std::string& _name, const std::string& _data) {
+  std::string filename = testing::TempDir() + _name;
+  std::ofstream file(filename);
+  file << _data;
+  return filename;
+}
+
+void parseLog(const std::string& _input, Engine* _engine) {
+  Reader reader(_input);
+  Parser parser(_engine);
+  parser.parse(&reader);
+}
+
+std::vector<std::string> runQuery(const std::string& _input, Query _query,
+                                  const ParseLog& _parse, f64 _scalar) {
+  std::string prefix = testing::TempDir() + "engine_";
+  std::vector<std::string> names = {"t.csv", "m.csv", "p.csv", "l.csv",
+                                    "c.csv"};
+  _query.transactionsFile = prefix + names[0];
+  _query.messagesFile = prefix + names[1];
+  _query.packetsFile = prefix + names[2];
+  _query.latencyFile = prefix + names[3];
+  _query.hopCountFile = prefix + names[4];
+  {
+    Engine engine({_query}, _scalar, false);
+    _parse(_input, &engine);
+    engine.complete();
+  }
+  std::vector<std::string> outputs;
+  for (const std::string& name : names) {
+    outputs.push_back(readFile(prefix + name));
+    std::remove((prefix + name).c_str());
+  }
+  return outputs;
+}
+
+std::vector<std::string> runEngine(const std::string& _input,
+                                   const std::vector<std::string>& _filters,
+                                   const ParseLog& _parse, f64 _scalar) {
+  Query query;
+  query.filters = _filters;
+  return runQuery(_input, query, _parse, _scalar);
+}
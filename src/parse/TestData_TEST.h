@@ -0,0 +1,79 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_TESTDATA_TEST_H_
+#define PARSE_TESTDATA_TEST_H_
+
+#include <prim/prim.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "parse/Query.h"
+
+class Engine;
+
+// parses a log file into an engine
+typedef std::function<void(const std::string& _input, Engine* _engine)>
+    ParseLog;
+
+// makes a message log of random transactions that overlap each other, at most
+// _maxOpen of them at once, every call yields the same log
+std::string randomLog(u64 _transactions, u64 _maxOpen);
+
+// makes _lines numbered flit lines of varying length
+std::string numberedText(u64 _lines);
+
+// compresses _text as a single gzip member
+std::string gzipText(const std::string& _text, s32 _level = 6);
+
+// yields the contents of a file
+std::string readFile(const std::string& _filename);
+
+// writes _data to the temporary file _name, returns its path
+std::string writeLog(const std::string& _name, const std::string& _data);
+
+// parses the log with a single-threaded Parser
+void parseLog(const std::string& _input, Engine* _engine);
+
+// runs an engine over the log with the query and the transaction, message,
+// packet, latency, and hop count outputs, returns the contents of the outputs
+std::vector<std::string> runQuery(const std::string& _input, Query _query,
+                                  const ParseLog& _parse = parseLog,
+                                  f64 _scalar = 1.0);
+
+// the same for a query of the filters
+std::vector<std::string> runEngine(const std::string& _input,
+                                   const std::vector<std::string>& _filters,
+                                   const ParseLog& _parse = parseLog,
+                                   f64 _scalar = 1.0);
+
+#endif  // PARSE_TESTDATA_TEST_H_
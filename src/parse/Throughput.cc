@@ -0,0 +1,162 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Throughput.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+Throughput::Grouping Throughput::parseGrouping(const std::string& _name) {
+  if (_name == "none") {
+    return Grouping::NONE;
+  } else if (_name == "dst" || _name == "destination") {
+    return Grouping::DESTINATION;
+  } else if (_name == "app" || _name == "application") {
+    return Grouping::APPLICATION;
+  }
+  throw ex::Exception("Invalid throughput grouping: %s\n", _name.c_str());
+}
+
+Throughput::Throughput() : binWidth_(0.0), grouping_(Grouping::NONE) {}
+
+Throughput::Throughput(f64 _binWidth, Grouping _grouping)
+    : binWidth_(_binWidth), grouping_(_grouping) {
+  if (!(binWidth_ > 0) || std::isinf(binWidth_)) {
+    throw ex::Exception("The throughput bin width must be positive\n");
+  }
+}
+
+Throughput::~Throughput() {}
+
+f64 Throughput::binWidth() const {
+  return binWidth_;
+}
+
+Throughput::Grouping Throughput::grouping() const {
+  return grouping_;
+}
+
+void Throughput::add(Kind _kind, u64 _group, f64 _time, u64 _count) {
+  assert(binWidth_ > 0);
+  Series& series = this->series(grouping_ == Grouping::NONE ? 0 : _group);
+  bin(&series, (u64)(_time / binWidth_)).count[_kind] += _count;
+}
+
+void Throughput::merge(const Throughput& _other) {
+  for (const Series& from : _other.series_) {
+    if (from.counts.empty()) {
+      continue;
+    }
+    Series& to = series(from.group);
+
+    // cover the bins of the other series before adding them up
+    bin(&to, from.first);
+    bin(&to, from.first + from.counts.size() - 1);
+    Counts* counts = &to.counts[from.first - to.first];
+    for (const Counts& fromCounts : from.counts) {
+      for (u32 kind = 0; kind < NUM_KINDS; kind++) {
+        counts->count[kind] += fromCounts.count[kind];
+      }
+      counts++;
+    }
+  }
+}
+
+void Throughput::clear() {
+  series_.clear();
+  index_.clear();
+}
+
+std::vector<u64> Throughput::groups() const {
+  std::vector<u64> groups;
+  for (const Series& series : series_) {
+    groups.push_back(series.group);
+  }
+  std::sort(groups.begin(), groups.end());
+  return groups;
+}
+
+u64 Throughput::firstBin() const {
+  u64 first = U64_MAX;
+  for (const Series& series : series_) {
+    first = std::min(first, series.first);
+  }
+  return series_.empty() ? 0 : first;
+}
+
+u64 Throughput::endBin() const {
+  u64 end = 0;
+  for (const Series& series : series_) {
+    end = std::max(end, series.first + series.counts.size());
+  }
+  return end;
+}
+
+Throughput::Counts Throughput::counts(u64 _group, u64 _bin) const {
+  Counts counts = {};
+  if (_group < index_.size() && index_[_group] != 0) {
+    const Series& series = series_[index_[_group] - 1];
+    if (_bin >= series.first && _bin - series.first < series.counts.size()) {
+      counts = series.counts[_bin - series.first];
+    }
+  }
+  return counts;
+}
+
+Throughput::Series& Throughput::series(u64 _group) {
+  if (_group >= index_.size()) {
+    index_.resize(std::max<u64>(_group + 1, 2 * index_.size()), 0);
+  }
+  u32& index = index_[_group];
+  if (index == 0) {
+    series_.push_back({_group, 0, {}});
+    index = series_.size();
+  }
+  return series_[index - 1];
+}
+
+Throughput::Counts& Throughput::bin(Series* _series, u64 _bin) {
+  // the series grows at either end to cover the bin
+  std::vector<Counts>& counts = _series->counts;
+  if (counts.empty()) {
+    _series->first = _bin;
+  } else if (_bin < _series->first) {
+    counts.insert(counts.begin(), _series->first - _bin, Counts());
+    _series->first = _bin;
+  }
+  u64 offset = _bin - _series->first;
+  if (offset >= counts.size()) {
+    counts.resize(offset + 1, Counts());
+  }
+  return counts[offset];
+}
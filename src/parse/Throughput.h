@@ -0,0 +1,102 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_THROUGHPUT_H_
+#define PARSE_THROUGHPUT_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+// This class counts the flits, packets, messages, and transactions delivered
+// in each time bin [k*w, (k+1)*w), optionally split by a group such as the
+// destination terminal or the application. Each group holds a series of fixed
+// size counters that spans from its first to its last bin with deliveries, so
+// the memory depends on the time range and not on the number of records.
+class Throughput {
+ public:
+  // what the counts are split by
+  enum class Grouping { NONE, DESTINATION, APPLICATION };
+
+  // parses "none", "dst" or "destination", and "app" or "application"
+  static Grouping parseGrouping(const std::string& _name);
+
+  enum Kind : u32 { FLITS, PACKETS, MESSAGES, TRANSACTIONS, NUM_KINDS };
+
+  struct Counts {
+    u64 count[NUM_KINDS];
+  };
+
+  // an unused throughput without bins
+  Throughput();
+  Throughput(f64 _binWidth, Grouping _grouping);
+  ~Throughput();
+
+  f64 binWidth() const;
+  Grouping grouping() const;
+
+  // counts a delivery at a (scaled) time, the group is ignored without a
+  // grouping
+  void add(Kind _kind, u64 _group, f64 _time, u64 _count = 1);
+
+  void merge(const Throughput& _other);
+  void clear();
+
+  // the groups with deliveries in ascending order
+  std::vector<u64> groups() const;
+
+  // the bins [first, end) that hold all deliveries, empty without any
+  u64 firstBin() const;
+  u64 endBin() const;
+
+  // the counts of a group in a bin, zero outside of its series
+  Counts counts(u64 _group, u64 _bin) const;
+
+ private:
+  struct Series {
+    u64 group;
+    u64 first;  // bin of counts[0]
+    std::vector<Counts> counts;
+  };
+
+  Series& series(u64 _group);
+  Counts& bin(Series* _series, u64 _bin);
+
+  f64 binWidth_;
+  Grouping grouping_;
+
+  std::vector<Series> series_;
+
+  // group -> series index + 1, 0 for no series, grows with the largest group
+  std::vector<u32> index_;
+};
+
+#endif  // PARSE_THROUGHPUT_H_
@@ -0,0 +1,112 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Throughput.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <vector>
+
+TEST(Throughput, bins) {
+  Throughput throughput(10.0, Throughput::Grouping::NONE);
+  ASSERT_TRUE(throughput.groups().empty());
+  ASSERT_EQ(throughput.firstBin(), throughput.endBin());
+
+  // the group is ignored without a grouping
+  throughput.add(Throughput::FLITS, 7, 35.0, 4);
+  throughput.add(Throughput::PACKETS, 3, 39.9);
+  throughput.add(Throughput::MESSAGES, 0, 40.0);
+  throughput.add(Throughput::TRANSACTIONS, 0, 12.5);
+  ASSERT_EQ(throughput.groups(), std::vector<u64>({0}));
+  ASSERT_EQ(throughput.firstBin(), 1u);
+  ASSERT_EQ(throughput.endBin(), 5u);
+
+  Throughput::Counts counts = throughput.counts(0, 3);
+  ASSERT_EQ(counts.count[Throughput::FLITS], 4u);
+  ASSERT_EQ(counts.count[Throughput::PACKETS], 1u);
+  ASSERT_EQ(counts.count[Throughput::MESSAGES], 0u);
+  ASSERT_EQ(throughput.counts(0, 4).count[Throughput::MESSAGES], 1u);
+  ASSERT_EQ(throughput.counts(0, 1).count[Throughput::TRANSACTIONS], 1u);
+  ASSERT_EQ(throughput.counts(0, 2).count[Throughput::FLITS], 0u);
+  ASSERT_EQ(throughput.counts(0, 100).count[Throughput::FLITS], 0u);
+  ASSERT_EQ(throughput.counts(1, 3).count[Throughput::FLITS], 0u);
+
+  throughput.clear();
+  ASSERT_TRUE(throughput.groups().empty());
+}
+
+TEST(Throughput, groups) {
+  Throughput throughput(1.0, Throughput::Grouping::DESTINATION);
+  throughput.add(Throughput::PACKETS, 9, 100.5);
+  throughput.add(Throughput::PACKETS, 2, 3.0);
+  throughput.add(Throughput::PACKETS, 9, 0.0);
+  ASSERT_EQ(throughput.groups(), std::vector<u64>({2, 9}));
+  ASSERT_EQ(throughput.firstBin(), 0u);
+  ASSERT_EQ(throughput.endBin(), 101u);
+  ASSERT_EQ(throughput.counts(9, 0).count[Throughput::PACKETS], 1u);
+  ASSERT_EQ(throughput.counts(9, 100).count[Throughput::PACKETS], 1u);
+  ASSERT_EQ(throughput.counts(2, 3).count[Throughput::PACKETS], 1u);
+  ASSERT_EQ(throughput.counts(2, 0).count[Throughput::PACKETS], 0u);
+}
+
+TEST(Throughput, merge) {
+  // the counts don't depend on how deliveries are split among throughputs
+  Throughput all(5.0, Throughput::Grouping::APPLICATION);
+  Throughput first(5.0, Throughput::Grouping::APPLICATION);
+  Throughput second(5.0, Throughput::Grouping::APPLICATION);
+  for (u32 i = 0; i < 1000; i++) {
+    f64 time = 1000.0 + (i * 37) % 500 - (i % 3) * 200.0;
+    all.add(Throughput::FLITS, i % 4, time, 1 + i % 5);
+    ((i % 7 < 3) ? first : second).add(Throughput::FLITS, i % 4, time,
+                                       1 + i % 5);
+  }
+  first.merge(second);
+  ASSERT_EQ(first.groups(), all.groups());
+  ASSERT_EQ(first.firstBin(), all.firstBin());
+  ASSERT_EQ(first.endBin(), all.endBin());
+  for (u64 group : all.groups()) {
+    for (u64 bin = all.firstBin(); bin < all.endBin(); bin++) {
+      ASSERT_EQ(first.counts(group, bin).count[Throughput::FLITS],
+                all.counts(group, bin).count[Throughput::FLITS]);
+    }
+  }
+}
+
+TEST(Throughput, parseGrouping) {
+  ASSERT_EQ(Throughput::parseGrouping("none"), Throughput::Grouping::NONE);
+  ASSERT_EQ(Throughput::parseGrouping("dst"),
+            Throughput::Grouping::DESTINATION);
+  ASSERT_EQ(Throughput::parseGrouping("application"),
+            Throughput::Grouping::APPLICATION);
+  ASSERT_THROW(Throughput::parseGrouping("src"), ex::Exception);
+  ASSERT_THROW(Throughput(0.0, Throughput::Grouping::NONE), ex::Exception);
+}
@@ -0,0 +1,145 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/TrafficMatrix.h"
+
+#include <algorithm>
+
+TrafficMatrix::Cell::Cell()
+    : src(0),
+      dst(0),
+      messages(0),
+      msgLatencySum(0.0),
+      msgLatencyMax(0.0),
+      packets(0),
+      flits(0),
+      pktLatencySum(0.0),
+      pktLatencyMax(0.0),
+      pktLatencies(SKETCH_ERROR, SKETCH_BUCKETS) {}
+
+TrafficMatrix::Cell::~Cell() {}
+
+TrafficMatrix::TrafficMatrix() : dim_(0) {}
+
+TrafficMatrix::~TrafficMatrix() {}
+
+void TrafficMatrix::addMessage(u32 _src, u32 _dst, f64 _latency) {
+  Cell& cell = this->cell(_src, _dst);
+  cell.messages++;
+  cell.msgLatencySum += _latency;
+  cell.msgLatencyMax = std::max(cell.msgLatencyMax, _latency);
+}
+
+void TrafficMatrix::addPacket(u32 _src, u32 _dst, u32 _flits,
+                              f64 _latency) {
+  Cell& cell = this->cell(_src, _dst);
+  cell.packets++;
+  cell.flits += _flits;
+  cell.pktLatencySum += _latency;
+  cell.pktLatencyMax = std::max(cell.pktLatencyMax, _latency);
+  cell.pktLatencies.add(_latency);
+}
+
+void TrafficMatrix::merge(const TrafficMatrix& _other) {
+  for (const Cell& from : _other.cells_) {
+    Cell& to = cell(from.src, from.dst);
+    to.messages += from.messages;
+    to.msgLatencySum += from.msgLatencySum;
+    to.msgLatencyMax = std::max(to.msgLatencyMax, from.msgLatencyMax);
+    to.packets += from.packets;
+    to.flits += from.flits;
+    to.pktLatencySum += from.pktLatencySum;
+    to.pktLatencyMax = std::max(to.pktLatencyMax, from.pktLatencyMax);
+    to.pktLatencies.merge(from.pktLatencies);
+  }
+}
+
+void TrafficMatrix::clear() {
+  cells_.clear();
+  dim_ = 0;
+  dense_.clear();
+  sparse_.reset();
+}
+
+std::vector<const TrafficMatrix::Cell*> TrafficMatrix::cells() const {
+  std::vector<const Cell*> cells;
+  for (const Cell& cell : cells_) {
+    cells.push_back(&cell);
+  }
+  std::sort(cells.begin(), cells.end(), [](const Cell* _a, const Cell* _b) {
+    return _a->src != _b->src ? _a->src < _b->src : _a->dst < _b->dst;
+  });
+  return cells;
+}
+
+TrafficMatrix::Cell& TrafficMatrix::cell(u32 _src, u32 _dst) {
+  u32 terminal = std::max(_src, _dst);
+  if (!sparse_ && terminal >= dim_) {
+    growDense(terminal);
+  }
+  u32* index;
+  if (sparse_) {
+    index = sparse_->emplace((static_cast<u64>(_src) << 32) | _dst);
+  } else {
+    index = &dense_[static_cast<u64>(_src) * dim_ + _dst];
+  }
+  if (*index == 0) {
+    cells_.emplace_back();
+    cells_.back().src = _src;
+    cells_.back().dst = _dst;
+    *index = cells_.size();
+  }
+  return cells_[*index - 1];
+}
+
+void TrafficMatrix::growDense(u32 _terminal) {
+  // the index doubles to cover the terminal or gives way to the hash table
+  u32 dim = std::max(dim_, 16u);
+  while (dim <= _terminal && dim < DENSE_TERMINALS) {
+    dim *= 2;
+  }
+  if (_terminal < dim) {
+    dense_.assign(static_cast<u64>(dim) * dim, 0);
+  } else {
+    dense_.clear();
+    dense_.shrink_to_fit();
+    sparse_ = std::make_unique<FlatTable<u32> >(2 * cells_.size());
+  }
+  dim_ = dim;
+  for (u32 index = 0; index < cells_.size(); index++) {
+    const Cell& cell = cells_[index];
+    if (sparse_) {
+      *sparse_->emplace((static_cast<u64>(cell.src) << 32) | cell.dst) =
+          index + 1;
+    } else {
+      dense_[static_cast<u64>(cell.src) * dim_ + cell.dst] = index + 1;
+    }
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_TRAFFICMATRIX_H_
+#define PARSE_TRAFFICMATRIX_H_
+
+#include <prim/prim.h>
+
+#include <memory>
+#include <vector>
+
+#include "parse/FlatTable.h"
+#include "parse/QuantileSketch.h"
+
+// This class aggregates messages and packets by their source and destination.
+// Only the pairs with traffic get a cell. While the terminal ids are below
+// DENSE_TERMINALS the cells are found through a dense source x destination
+// index, which grows with the largest id seen, beyond that through a hash
+// table of the pairs.
+class TrafficMatrix {
+ public:
+  static const u32 DENSE_TERMINALS = 1024;
+
+  // the packet latency percentiles of a cell are within this relative error
+  // as long as they are within a ratio of gamma^SKETCH_BUCKETS (about 167) of
+  // its largest latency, gamma = (1 + error) / (1 - error); lower latencies
+  // share the lowest bucket, whose estimate is only bounded by the minimum.
+  // A cell's sketch takes at most 1 KiB.
+  static constexpr f64 SKETCH_ERROR = 0.02;
+  static const u32 SKETCH_BUCKETS = 128;
+
+  struct Cell {
+    Cell();
+    ~Cell();
+
+    u32 src;
+    u32 dst;
+    u64 messages;
+    f64 msgLatencySum;
+    f64 msgLatencyMax;
+    u64 packets;
+    u64 flits;
+    f64 pktLatencySum;
+    f64 pktLatencyMax;
+    QuantileSketch pktLatencies;
+  };
+
+  TrafficMatrix();
+  ~TrafficMatrix();
+
+  void addMessage(u32 _src, u32 _dst, f64 _latency);
+  void addPacket(u32 _src, u32 _dst, u32 _flits, f64 _latency);
+
+  void merge(const TrafficMatrix& _other);
+  void clear();
+
+  // the cells in order of source and destination
+  std::vector<const Cell*> cells() const;
+
+ private:
+  Cell& cell(u32 _src, u32 _dst);
+  void growDense(u32 _terminal);
+
+  std::vector<Cell> cells_;
+
+  // [src * dim_ + dst] -> cell index + 1, 0 for no cell
+  u32 dim_;
+  std::vector<u32> dense_;
+
+  // (src << 32 | dst) -> cell index + 1, replaces the dense index
+  std::unique_ptr<FlatTable<u32> > sparse_;
+};
+
+#endif  // PARSE_TRAFFICMATRIX_H_
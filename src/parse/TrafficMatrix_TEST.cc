@@ -0,0 +1,130 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/TrafficMatrix.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+// adds the same traffic between terminals [0, _terminals) shifted by _offset
+static void addTraffic(u32 _terminals, u32 _offset, TrafficMatrix* _matrix) {
+  std::mt19937_64 rnd(12345);
+  for (u32 i = 0; i < 20000; i++) {
+    u32 src = _offset + rnd() % _terminals;
+    u32 dst = _offset + rnd() % _terminals;
+    f64 latency = 1.0 + rnd() % 1000;
+    _matrix->addMessage(src, dst, 2 * latency);
+    _matrix->addPacket(src, dst, 1 + i % 4, latency);
+  }
+}
+
+TEST(TrafficMatrix, cells) {
+  TrafficMatrix matrix;
+  ASSERT_TRUE(matrix.cells().empty());
+  matrix.addPacket(3, 1, 4, 10.0);
+  matrix.addPacket(3, 1, 2, 30.0);
+  matrix.addMessage(3, 1, 40.0);
+  matrix.addPacket(0, 2, 1, 5.0);
+
+  // in order of source and destination
+  std::vector<const TrafficMatrix::Cell*> cells = matrix.cells();
+  ASSERT_EQ(cells.size(), 2u);
+  ASSERT_EQ(cells[0]->src, 0u);
+  ASSERT_EQ(cells[0]->dst, 2u);
+  ASSERT_EQ(cells[0]->messages, 0u);
+  const TrafficMatrix::Cell& cell = *cells[1];
+  ASSERT_EQ(cell.src, 3u);
+  ASSERT_EQ(cell.dst, 1u);
+  ASSERT_EQ(cell.messages, 1u);
+  ASSERT_EQ(cell.msgLatencyMax, 40.0);
+  ASSERT_EQ(cell.packets, 2u);
+  ASSERT_EQ(cell.flits, 6u);
+  ASSERT_EQ(cell.pktLatencySum, 40.0);
+  ASSERT_EQ(cell.pktLatencyMax, 30.0);
+  ASSERT_EQ(cell.pktLatencies.count(), 2u);
+
+  matrix.clear();
+  ASSERT_TRUE(matrix.cells().empty());
+}
+
+TEST(TrafficMatrix, sparse) {
+  // terminal ids past the dense index give the same cells
+  TrafficMatrix dense;
+  TrafficMatrix sparse;
+  u32 offset = TrafficMatrix::DENSE_TERMINALS * 4;
+  addTraffic(50, 0, &dense);
+  addTraffic(50, offset, &sparse);
+  std::vector<const TrafficMatrix::Cell*> expected = dense.cells();
+  std::vector<const TrafficMatrix::Cell*> cells = sparse.cells();
+  ASSERT_EQ(cells.size(), expected.size());
+  for (u32 index = 0; index < cells.size(); index++) {
+    ASSERT_EQ(cells[index]->src, expected[index]->src + offset);
+    ASSERT_EQ(cells[index]->dst, expected[index]->dst + offset);
+    ASSERT_EQ(cells[index]->packets, expected[index]->packets);
+    ASSERT_EQ(cells[index]->flits, expected[index]->flits);
+    ASSERT_EQ(cells[index]->msgLatencySum, expected[index]->msgLatencySum);
+  }
+}
+
+TEST(TrafficMatrix, merge) {
+  // merging partial matrices gives the matrix of all the traffic
+  TrafficMatrix all;
+  addTraffic(100, 0, &all);
+  addTraffic(2000, 0, &all);
+
+  TrafficMatrix first;
+  TrafficMatrix second;
+  addTraffic(100, 0, &first);
+  addTraffic(2000, 0, &second);
+  first.merge(second);
+
+  std::vector<const TrafficMatrix::Cell*> expected = all.cells();
+  std::vector<const TrafficMatrix::Cell*> cells = first.cells();
+  ASSERT_EQ(cells.size(), expected.size());
+  for (u32 index = 0; index < cells.size(); index++) {
+    const TrafficMatrix::Cell& cell = *cells[index];
+    const TrafficMatrix::Cell& other = *expected[index];
+    ASSERT_EQ(cell.src, other.src);
+    ASSERT_EQ(cell.dst, other.dst);
+    ASSERT_EQ(cell.messages, other.messages);
+    ASSERT_EQ(cell.packets, other.packets);
+    ASSERT_EQ(cell.flits, other.flits);
+    ASSERT_EQ(cell.msgLatencyMax, other.msgLatencyMax);
+    ASSERT_EQ(cell.pktLatencyMax, other.pktLatencyMax);
+    ASSERT_NEAR(cell.pktLatencySum, other.pktLatencySum, 1e-6);
+    ASSERT_EQ(cell.pktLatencies.count(), other.pktLatencies.count());
+    ASSERT_EQ(cell.pktLatencies.quantile(0.5),
+              other.pktLatencies.quantile(0.5));
+  }
+}
@@ -0,0 +1,215 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Transient.h"
+
+#include <ex/Exception.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "parse/Aggregate.h"
+#include "parse/RecordWriter.h"
+
+/*** Transient bins ***/
+
+TransientBins::TransientBins()
+    : recvTime_(false), width_(0.0), latencySketch_(0.0) {}
+
+TransientBins::TransientBins(const Transient& _transient, f64 _start,
+                             f64 _end, f64 _latencySketch)
+    : recvTime_(_transient.recvTime_), latencySketch_(_latencySketch) {
+  // bin edges, a fixed width makes the last bin the remainder
+  u64 bins = _transient.bins_;
+  width_ = (_end - _start) / _transient.bins_;
+  if (_transient.binWidth_ > 0) {
+    bins = std::max<u64>(1, (u64)std::ceil((_end - _start) /
+                                           _transient.binWidth_));
+    width_ = _transient.binWidth_;
+  }
+  for (u64 idx = 0; idx < bins; idx++) {
+    edges_.push_back(_start + idx * width_);
+  }
+  edges_.push_back(_end);
+
+  hops_.resize(bins);
+  if (latencySketch_ > 0.0) {
+    sketches_.assign(bins, QuantileSketch(latencySketch_));
+  } else {
+    latencies_.resize(bins);
+  }
+}
+
+TransientBins::~TransientBins() {}
+
+u64 TransientBins::size() const {
+  return hops_.size();
+}
+
+void TransientBins::add(const PacketSample& _sample) {
+  f64 time = recvTime_ ? _sample.end : _sample.start;
+  if (edges_.empty() || !(time >= edges_.front() && time <= edges_.back())) {
+    return;
+  }
+  u64 idx = size() - 1;
+  if (time < edges_.back()) {
+    idx = std::min<u64>(idx, (u64)((time - edges_.front()) / width_));
+  }
+  while (time < edges_[idx]) {
+    idx--;
+  }
+  while (idx + 1 < size() && time >= edges_[idx + 1]) {
+    idx++;
+  }
+  hops_[idx].add(_sample.hopCount, _sample.minHopCount,
+                 _sample.nonMinHopCount);
+  if (latencySketch_ > 0.0) {
+    sketches_[idx].add(_sample.end - _sample.start);
+  } else {
+    latencies_[idx].push_back(_sample.end - _sample.start);
+  }
+}
+
+void TransientBins::merge(TransientBins* _other) {
+  assert(edges_ == _other->edges_);
+  for (u64 idx = 0; idx < size(); idx++) {
+    hops_[idx].merge(_other->hops_[idx]);
+    _other->hops_[idx] = HopCounts();
+    if (latencySketch_ > 0.0) {
+      sketches_[idx].merge(_other->sketches_[idx]);
+      _other->sketches_[idx].clear();
+    } else {
+      latencies_[idx].insert(latencies_[idx].end(),
+                             _other->latencies_[idx].begin(),
+                             _other->latencies_[idx].end());
+      _other->latencies_[idx].clear();
+    }
+  }
+}
+
+/*** Transient class ***/
+
+Transient::Transient(const std::string& _filename, bool _recvTime, u32 _bins,
+                     f64 _binWidth, f64 _start, f64 _end)
+    : filename_(_filename),
+      recvTime_(_recvTime),
+      bins_(_bins),
+      binWidth_(_binWidth),
+      start_(_start),
+      end_(_end) {
+  if (bins_ == 0 && binWidth_ <= 0) {
+    throw ex::Exception("The number of bins must be positive\n");
+  }
+  if (start_ >= 0 && end_ >= 0 && start_ > end_) {
+    throw ex::Exception("Invalid bin bounds: %f > %f\n", start_, end_);
+  }
+}
+
+Transient::~Transient() {}
+
+TransientBins Transient::bins(f64 _latencySketch) const {
+  if (start_ < 0 || end_ < 0) {
+    return TransientBins();
+  }
+  return TransientBins(*this, start_, end_, _latencySketch);
+}
+
+void Transient::write(TransientBins* _bins) const {
+  RecordWriter outFile(filename_);
+  u64 bins = _bins->size();
+
+  // the columns of each bin
+  const std::vector<std::vector<std::string> > AVERAGES = {
+      {"AveHops"},
+      {"AveMinHops", "PerMinimal"},
+      {"AveNonMinHops", "PerNonMinimal"}};
+  const std::string PER_HOPS[] = {"PerHops", "PerMinHops", "PerNonMinHops"};
+  std::vector<std::map<std::string, std::string> > values(bins);
+  std::set<u32> perHops[3];
+  Columns columns;
+  for (u64 idx = 0; idx < bins; idx++) {
+    hopCountColumns(_bins->hops_[idx], &columns);
+    for (const auto& column : columns) {
+      for (u32 family = 0; family < 3; family++) {
+        const std::string& prefix = PER_HOPS[family];
+        if (column.first.size() > prefix.size() &&
+            column.first.compare(0, prefix.size(), prefix) == 0 &&
+            std::isdigit(column.first.at(prefix.size()))) {
+          perHops[family].insert(
+              std::stoul(column.first.substr(prefix.size())));
+        }
+      }
+      values[idx].insert(column);
+    }
+    if (_bins->latencySketch_ > 0.0) {
+      latencyColumns(_bins->sketches_[idx], &columns);
+    } else {
+      latencyColumns(&_bins->latencies_[idx], &columns);
+    }
+    values[idx].insert(columns.begin(), columns.end());
+  }
+
+  // the header of the grid, hop histograms are in hop count order
+  if (bins > 0) {
+    std::vector<std::string> names;
+    for (u32 family = 0; family < 3; family++) {
+      names.insert(names.end(), AVERAGES[family].begin(),
+                   AVERAGES[family].end());
+      for (u32 hopCount : perHops[family]) {
+        names.push_back(PER_HOPS[family] + std::to_string(hopCount));
+      }
+    }
+    for (const auto& column : columns) {
+      names.push_back(column.first);
+    }
+
+    std::string line = "Time";
+    for (const std::string& name : names) {
+      line += "," + name;
+    }
+    outFile.write(line + "\n");
+
+    // one row per bin, missing columns are nan
+    for (u64 idx = 0; idx < bins; idx++) {
+      line = std::to_string(_bins->edges_[idx]);
+      for (const std::string& name : names) {
+        auto it = values[idx].find(name);
+        line += "," + ((it != values[idx].end()) ? it->second : "nan");
+      }
+      outFile.write(line + "\n");
+    }
+  }
+  outFile.complete();
+}
@@ -0,0 +1,107 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_TRANSIENT_H_
+#define PARSE_TRANSIENT_H_
+
+#include <prim/prim.h>
+
+#include <string>
+#include <vector>
+
+#include "parse/Partial.h"
+#include "parse/QuantileSketch.h"
+
+class Transient;
+
+// The packet hop count and latency aggregates of the bins of a transient.
+// Latencies are kept exactly or, with a positive relative error, summarized
+// by a sketch per bin so the memory only depends on the number of bins.
+class TransientBins {
+ public:
+  // no bins
+  TransientBins();
+  // the bins of the transient spanning [_start, _end]
+  TransientBins(const Transient& _transient, f64 _start, f64 _end,
+                f64 _latencySketch);
+  ~TransientBins();
+
+  u64 size() const;
+
+  // adds a packet to the bin holding its send or receive time, if any, the
+  // last bin also holds the end bound
+  void add(const PacketSample& _sample);
+
+  // moves the samples of bins with the same edges into this one
+  void merge(TransientBins* _other);
+
+ private:
+  friend class Transient;
+
+  bool recvTime_;
+  f64 width_;
+  std::vector<f64> edges_;  // [bin] start, and the end of the last bin
+  f64 latencySketch_;
+  std::vector<HopCounts> hops_;
+  std::vector<std::vector<f64> > latencies_;
+  std::vector<QuantileSketch> sketches_;
+};
+
+// This class writes the packet hop count and latency aggregates of each time
+// bin as one row of a grid. Packets are assigned to the bin [a,b) holding
+// their send or receive time, the last bin [a,b] is closed so that it holds
+// the packets at the end bound like an inclusive time filter. The bounds are
+// known before the log is parsed, so packets are binned as they complete.
+class Transient {
+ public:
+  // _bins is ignored if _binWidth is positive, negative bounds (left unknown
+  // for a log without flits) give no bins
+  Transient(const std::string& _filename, bool _recvTime, u32 _bins,
+            f64 _binWidth, f64 _start, f64 _end);
+  ~Transient();
+
+  // the empty bins between the bounds
+  TransientBins bins(f64 _latencySketch) const;
+
+  // writes the grid of the bins
+  void write(TransientBins* _bins) const;
+
+ private:
+  friend class TransientBins;
+
+  const std::string filename_;
+  const bool recvTime_;
+  const u32 bins_;
+  const f64 binWidth_;
+  const f64 start_;
+  const f64 end_;
+};
+
+#endif  // PARSE_TRANSIENT_H_
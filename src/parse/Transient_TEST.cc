@@ -0,0 +1,219 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/Transient.h"
+
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+#include <strop/strop.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "parse/TestData_TEST.h"
+
+// reads a csv text into one map of column names to values per row
+static std::vector<std::map<std::string, std::string> > readGrid(
+    const std::string& _text) {
+  std::vector<std::string> lines = strop::split(_text, '\n');
+  std::vector<std::string> names = strop::split(lines.at(0), ',');
+  std::vector<std::map<std::string, std::string> > rows;
+  for (u64 idx = 1; idx < lines.size(); idx++) {
+    if (lines[idx].empty()) {
+      continue;
+    }
+    std::vector<std::string> values = strop::split(lines[idx], ',');
+    EXPECT_EQ(values.size(), names.size());
+    rows.emplace_back();
+    for (u64 col = 0; col < names.size(); col++) {
+      rows.back()[names[col]] = values.at(col);
+    }
+  }
+  return rows;
+}
+
+// bins the samples and writes the grid
+static void write(const Transient& _transient,
+                  const std::vector<PacketSample>& _samples) {
+  TransientBins bins = _transient.bins(0.0);
+  for (const PacketSample& sample : _samples) {
+    bins.add(sample);
+  }
+  _transient.write(&bins);
+}
+
+TEST(Transient, binsMatchFilteredRuns) {
+  std::string input = writeLog("transient.mpf", randomLog(400, 8));
+  std::string filename = testing::TempDir() + "transient_grid.csv";
+
+  for (const char* time : {"send", "recv"}) {
+    SCOPED_TRACE(time);
+    Query query;
+    query.filters = {"-pc=1"};
+    query.transient = std::make_shared<Transient>(
+        filename, std::string(time) == "recv", 4, 0.0, 1000.0, 1800.0);
+    runQuery(input, query);
+    std::vector<std::map<std::string, std::string> > grid =
+        readGrid(readFile(filename));
+    ASSERT_EQ(grid.size(), 4u);
+
+    // each bin matches a run filtered to its time range, the times are whole
+    // ticks so the closed last bin ends half a tick later
+    for (u32 bin = 0; bin < 4; bin++) {
+      std::string filter = "+" + std::string(time) + "=" +
+                           std::to_string(1000 + bin * 200) + "-" +
+                           std::to_string(1200 + bin * 200 +
+                                          ((bin == 3) ? 0.5 : 0.0));
+      std::vector<std::string> outputs = runEngine(input, {"-pc=1", filter});
+      ASSERT_EQ(grid[bin].at("Time"), std::to_string(1000.0 + bin * 200));
+      for (u32 output : {3u, 4u}) {  // latency and hop count
+        std::map<std::string, std::string> row =
+            readGrid(outputs[output]).at(0);
+        ASSERT_EQ(row.at("Type"), "Packet");
+        row.erase("Type");
+        for (const auto& column : row) {
+          ASSERT_EQ(grid[bin].at(column.first), column.second)
+              << "bin " << bin << " column " << column.first;
+        }
+      }
+    }
+  }
+
+  std::remove(filename.c_str());
+  std::remove(input.c_str());
+}
+
+TEST(Transient, binWidth) {
+  std::string filename = testing::TempDir() + "transient_width.csv";
+  std::vector<PacketSample> samples = {{0.0, 4.0, 2, 2, 0},
+                                       {9.9, 12.0, 3, 2, 1},
+                                       {10.0, 11.0, 2, 2, 0},
+                                       {25.0, 30.0, 2, 2, 0}};
+  Transient transient(filename, false, 1, 10.0, 0.0, 25.0);
+  write(transient, samples);
+
+  // the last bin holds the end bound
+  std::vector<std::map<std::string, std::string> > grid =
+      readGrid(readFile(filename));
+  ASSERT_EQ(grid.size(), 3u);
+  ASSERT_EQ(grid[0].at("Time"), "0.000000");
+  ASSERT_EQ(grid[0].at("Count"), "2");
+  ASSERT_EQ(grid[0].at("Maximum"), "4.000000");
+  ASSERT_EQ(grid[0].at("PerNonMinimal"), "0.500000");
+  ASSERT_EQ(grid[0].at("PerNonMinHops1"), "0.500000");
+  ASSERT_EQ(grid[1].at("Time"), "10.000000");
+  ASSERT_EQ(grid[1].at("Count"), "1");
+  ASSERT_EQ(grid[1].at("PerNonMinHops1"), "nan");
+  ASSERT_EQ(grid[2].at("Time"), "20.000000");
+  ASSERT_EQ(grid[2].at("Count"), "1");
+  ASSERT_EQ(grid[2].at("AveHops"), "2.000000");
+  ASSERT_EQ(grid[2].at("Maximum"), "5.000000");
+  std::remove(filename.c_str());
+}
+
+TEST(Transient, emptyLog) {
+  std::string filename = testing::TempDir() + "transient_empty.csv";
+  Transient transient(filename, true, 40, 0.0, -1.0, -1.0);
+  TransientBins bins = transient.bins(0.0);
+  ASSERT_EQ(bins.size(), 0u);
+  transient.write(&bins);
+  ASSERT_EQ(readFile(filename), "");
+  std::remove(filename.c_str());
+}
+
+TEST(Transient, mergedBins) {
+  // bins filled in parts and merged match bins filled from all samples
+  std::string prefix = testing::TempDir() + "transient_merged_";
+  std::mt19937_64 rnd(12345);
+  std::vector<PacketSample> samples;
+  for (u32 i = 0; i < 1000; i++) {
+    f64 start = (f64)(rnd() % 4000) / 100;
+    samples.push_back({start, start + 1 + rnd() % 50, (u32)(1 + i % 5),
+                       (u32)(1 + i % 3), (u32)(i % 2)});
+  }
+  Transient transient(prefix + "parts.csv", true, 7, 0.0, 5.0, 75.0);
+  TransientBins first = transient.bins(0.0);
+  TransientBins second = transient.bins(0.0);
+  ASSERT_EQ(first.size(), 7u);
+  for (u32 i = 0; i < samples.size(); i++) {
+    ((i % 3 == 0) ? first : second).add(samples[i]);
+  }
+  first.merge(&second);
+  transient.write(&first);
+  write(Transient(prefix + "all.csv", true, 7, 0.0, 5.0, 75.0), samples);
+  ASSERT_EQ(readFile(prefix + "parts.csv"), readFile(prefix + "all.csv"));
+
+  // sketched bins estimate the latencies
+  TransientBins sketched = transient.bins(0.01);
+  for (const PacketSample& sample : samples) {
+    sketched.add(sample);
+  }
+  Transient(prefix + "sketch.csv", true, 7, 0.0, 5.0, 75.0)
+      .write(&sketched);
+  std::vector<std::map<std::string, std::string> > exact =
+      readGrid(readFile(prefix + "all.csv"));
+  std::vector<std::map<std::string, std::string> > grid =
+      readGrid(readFile(prefix + "sketch.csv"));
+  ASSERT_EQ(grid.size(), 7u);
+  for (u32 bin = 0; bin < 7; bin++) {
+    ASSERT_EQ(grid[bin].at("Count"), exact[bin].at("Count"));
+    ASSERT_EQ(grid[bin].at("AveHops"), exact[bin].at("AveHops"));
+    ASSERT_EQ(grid[bin].at("RelativeError"), "0.010000");
+    f64 median = std::stod(exact[bin].at("Median"));
+    ASSERT_NEAR(std::stod(grid[bin].at("Median")), median, 0.01 * median);
+  }
+
+  for (const char* name : {"parts.csv", "all.csv", "sketch.csv"}) {
+    std::remove((prefix + name).c_str());
+  }
+}
+
+TEST(Transient, compressed) {
+  // the grid is compressed like the other outputs
+  std::string prefix = testing::TempDir() + "transient_compressed";
+  std::vector<PacketSample> samples = {{0.0, 4.0, 2, 2, 0},
+                                       {9.9, 12.0, 3, 2, 1}};
+  write(Transient(prefix + ".csv", false, 2, 0.0, 0.0, 20.0), samples);
+  write(Transient(prefix + ".csv.gz", false, 2, 0.0, 0.0, 20.0), samples);
+  gzFile file = gzopen((prefix + ".csv.gz").c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+  char buf[1 << 16];
+  int size = gzread(file, buf, sizeof(buf));
+  gzclose(file);
+  ASSERT_GT(size, 0);
+  ASSERT_EQ(std::string(buf, size), readFile(prefix + ".csv"));
+  std::remove((prefix + ".csv").c_str());
+  std::remove((prefix + ".csv.gz").c_str());
+}
@@ -0,0 +1,88 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/ZstdCodec.h"
+
+#include <ex/Exception.h>
+
+#include <utility>
+
+ZstdCodec::ZstdCodec(std::unique_ptr<InputStream> _input, u64 _pieceSize)
+    : input_(std::move(_input)),
+      pieceSize_(_pieceSize),
+      stream_(ZSTD_createDStream()),
+      inBuffer_(ZSTD_DStreamInSize()),
+      in_({inBuffer_.data(), 0, 0}),
+      inputEnd_(false),
+      frameOpen_(false) {
+  if (stream_ == nullptr || ZSTD_isError(ZSTD_initDStream(stream_))) {
+    throw ex::Exception("Unable to initialize zstd\n");
+  }
+}
+
+ZstdCodec::~ZstdCodec() {
+  ZSTD_freeDStream(stream_);
+}
+
+bool ZstdCodec::read(std::vector<char>* _buffer) {
+  // decompress until the piece is full or the input is exhausted
+  u64 size = _buffer->size();
+  _buffer->resize(size + pieceSize_);
+  ZSTD_outBuffer out = {_buffer->data() + size, pieceSize_, 0};
+  while (out.pos < out.size) {
+    if (in_.pos == in_.size && !inputEnd_) {
+      u64 bytes = input_->read(inBuffer_.data(), inBuffer_.size());
+      inputEnd_ = (bytes == 0);
+      in_ = {inBuffer_.data(), bytes, 0};
+    }
+    u64 pos = out.pos;
+    u64 consumed = in_.pos;
+    size_t ret = ZSTD_decompressStream(stream_, &out, &in_);
+    if (ZSTD_isError(ret)) {
+      throw ex::Exception("Error while decompressing input file: %s (%s)\n",
+                          input_->filename().c_str(),
+                          ZSTD_getErrorName(ret));
+    }
+    if (in_.pos != consumed || out.pos != pos) {
+      // an idle call reports the next frame's header size, not an open frame
+      frameOpen_ = (ret != 0);
+    }
+    if (inputEnd_ && out.pos == pos) {
+      // everything has been flushed
+      if (frameOpen_) {
+        throw ex::Exception("Input file is truncated: %s\n",
+                            input_->filename().c_str());
+      }
+      break;
+    }
+  }
+  _buffer->resize(size + out.pos);
+  return out.pos > 0 || !inputEnd_;
+}
@@ -0,0 +1,62 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PARSE_ZSTDCODEC_H_
+#define PARSE_ZSTDCODEC_H_
+
+#include <prim/prim.h>
+#include <zstd.h>
+
+#include <memory>
+#include <vector>
+
+#include "parse/Codec.h"
+
+// This class decompresses zstd input sequentially. Multiple frames and
+// skippable frames (e.g., the seek table of the seekable format) are
+// supported.
+class ZstdCodec : public Codec {
+ public:
+  ZstdCodec(std::unique_ptr<InputStream> _input, u64 _pieceSize);
+  ~ZstdCodec() override;
+
+  bool read(std::vector<char>* _buffer) override;
+
+ private:
+  std::unique_ptr<InputStream> input_;
+  const u64 pieceSize_;
+  ZSTD_DStream* stream_;
+  std::vector<char> inBuffer_;
+  ZSTD_inBuffer in_;
+  bool inputEnd_;
+  bool frameOpen_;
+};
+
+#endif  // PARSE_ZSTDCODEC_H_
@@ -32,54 +32,138 @@
 
 #include <ex/Exception.h>
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
-u64 toU64(const std::string& _str) {
+// numbers are copied onto the stack to be null terminated for strto*()
+const u64 MAX_NUMBER_SIZE = 64;
+
+static const char* terminate(std::string_view _str, char* _buf) {
+  u64 size = std::min<u64>(_str.size(), MAX_NUMBER_SIZE - 1);
+  std::memcpy(_buf, _str.data(), size);
+  _buf[size] = '\0';
+  return _buf;
+}
+
+u64 toU64(std::string_view _str) {
+  char buf[MAX_NUMBER_SIZE];
   char* end;
-  const char* cstr = _str.c_str();
+  const char* cstr = terminate(_str, buf);
   u64 val = strtoul(cstr, &end, 0);
   if ((end - cstr) < static_cast<s64>(_str.size())) {
-    throw ex::Exception("non u64: %s\n", _str.c_str());
+    throw ex::Exception("non u64: %s\n", std::string(_str).c_str());
   }
   return val;
 }
 
-u32 toU32(const std::string& _str) {
+u32 toU32(std::string_view _str) {
+  char buf[MAX_NUMBER_SIZE];
   char* end;
-  const char* cstr = _str.c_str();
+  const char* cstr = terminate(_str, buf);
   u32 val = strtol(cstr, &end, 0);
   if ((end - cstr) < static_cast<s64>(_str.size())) {
-    throw ex::Exception("non u32: %s\n", _str.c_str());
+    throw ex::Exception("non u32: %s\n", std::string(_str).c_str());
   }
   return val;
 }
 
-f64 toF64(const std::string& _str) {
+f64 toF64(std::string_view _str) {
+  char buf[MAX_NUMBER_SIZE];
   char* end;
-  const char* cstr = _str.c_str();
+  const char* cstr = terminate(_str, buf);
   f64 val = strtod(cstr, &end);
   if ((end - cstr) < static_cast<s64>(_str.size())) {
-    throw ex::Exception("non f64: %s\n", _str.c_str());
+    throw ex::Exception("non f64: %s\n", std::string(_str).c_str());
   }
   return val;
 }
 
-u64 split(const std::string& _str, std::vector<std::string>* _words) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// checks that all 8 bytes are ASCII digits
+static bool isEightDigits(u64 _chunk) {
+  return (((_chunk & 0xF0F0F0F0F0F0F0F0) |
+           (((_chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+          0x3333333333333333);
+}
+
+// converts 8 ASCII digits to their value using SWAR multiplies
+static u64 eightDigits(u64 _chunk) {
+  _chunk -= 0x3030303030303030;
+  _chunk = (_chunk * 10) + (_chunk >> 8);
+  _chunk = (((_chunk & 0x000000FF000000FF) * 0x000F424000000064) +
+            (((_chunk >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >>
+           32;
+  return _chunk;
+}
+#endif
+
+bool parseU64(std::string_view _str, u64* _val) {
+  const char* str = _str.data();
+  u64 size = _str.size();
+  if (size == 0) {
+    return false;
+  }
+  u64 val = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  // 16 digits can't overflow, so they are converted 8 at a time
+  while (size >= 8 && val < 100000000) {
+    u64 chunk;
+    std::memcpy(&chunk, str, 8);
+    if (!isEightDigits(chunk)) {
+      return false;
+    }
+    val = (val * 100000000) + eightDigits(chunk);
+    str += 8;
+    size -= 8;
+  }
+#endif
+  for (; size > 0; str++, size--) {
+    u8 digit = static_cast<u8>(*str - '0');
+    if (digit > 9 || __builtin_mul_overflow(val, 10, &val) ||
+        __builtin_add_overflow(val, digit, &val)) {
+      return false;
+    }
+  }
+  *_val = val;
+  return true;
+}
+
+bool parseU32(std::string_view _str, u32* _val) {
+  u64 val;
+  if (!parseU64(_str, &val) || val > U32_MAX) {
+    return false;
+  }
+  *_val = static_cast<u32>(val);
+  return true;
+}
+
+bool parseF64(std::string_view _str, f64* _val) {
+  const char* end = _str.data() + _str.size();
+  std::from_chars_result res = std::from_chars(_str.data(), end, *_val);
+  return res.ec == std::errc() && res.ptr == end;
+}
+
+u64 split(std::string_view _str, std::string_view* _words, u64 _maxWords) {
   char delimiter = ',';
   u64 count = 0;
   u64 pos = 0;
   u64 idx;
-  std::string token;
-  while ((idx = _str.find(delimiter, pos)) != std::string::npos) {
-    token = _str.substr(pos, idx - pos);
-    _words->push_back(token);
+  while ((idx = _str.find(delimiter, pos)) != std::string_view::npos) {
+    if (count < _maxWords) {
+      _words[count] = _str.substr(pos, idx - pos);
+    }
     pos = idx + 1;
     count++;
   }
   if (pos < _str.size()) {
-    token = _str.substr(pos, _str.size() - pos);
-    _words->push_back(token);
+    if (count < _maxWords) {
+      _words[count] = _str.substr(pos, _str.size() - pos);
+    }
     count++;
   }
   return count;
@@ -33,15 +33,24 @@
 
 #include <prim/prim.h>
 
-#include <string>
-#include <vector>
+#include <string_view>
 
-u64 toU64(const std::string& _str);
+u64 toU64(std::string_view _str);
 
-u32 toU32(const std::string& _str);
+u32 toU32(std::string_view _str);
 
-f64 toF64(const std::string& _str);
+f64 toF64(std::string_view _str);
 
-u64 split(const std::string& _str, std::vector<std::string>* _words);
+// these parse plain decimal numbers without allocating or throwing, they return
+// false if the string isn't a valid number of the type
+bool parseU64(std::string_view _str, u64* _val);
+
+bool parseU32(std::string_view _str, u32* _val);
+
+bool parseF64(std::string_view _str, f64* _val);
+
+// splits the string on commas into at most _maxWords views, returns the total
+// number of words found
+u64 split(std::string_view _str, std::string_view* _words, u64 _maxWords);
 
 #endif  // PARSE_UTIL_H_
@@ -0,0 +1,103 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <prim/prim.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "parse/Reader.h"
+#include "parse/util.h"
+
+// compares the legacy strtoul based number parsing against the hot path parser
+// on every number field of an input file
+s32 main(s32 _argc, char** _argv) {
+  if (_argc != 2) {
+    std::fprintf(stderr, "usage: %s <inputfile>\n", _argv[0]);
+    return -1;
+  }
+
+  // gather all the number fields into one contiguous buffer
+  std::string text;
+  std::vector<std::pair<u64, u64> > fields;
+  Reader reader(_argv[1]);
+  std::string_view line;
+  std::string_view words[8];
+  while (reader.nextLine(&line)) {
+    u64 wordCount = std::min<u64>(split(line, words, 8), 8);
+    for (u64 w = 1; w < wordCount; w++) {
+      fields.push_back(std::make_pair(text.size(), words[w].size()));
+      text.append(words[w]);
+    }
+  }
+  std::vector<std::string_view> numbers;
+  for (const auto& field : fields) {
+    numbers.push_back(std::string_view(text).substr(field.first, field.second));
+  }
+
+  const u32 ITERATIONS = 20;
+  f64 legacyBest = F64_POS_INF;
+  f64 fastBest = F64_POS_INF;
+  u64 legacySum = 0;
+  u64 fastSum = 0;
+  for (u32 iter = 0; iter < ITERATIONS; iter++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::string_view number : numbers) {
+      legacySum += toU64(number);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (std::string_view number : numbers) {
+      u64 val = 0;
+      parseU64(number, &val);
+      fastSum += val;
+    }
+    auto end = std::chrono::steady_clock::now();
+    legacyBest = std::min(
+        legacyBest, std::chrono::duration<f64>(middle - start).count());
+    fastBest =
+        std::min(fastBest, std::chrono::duration<f64>(end - middle).count());
+  }
+  if (legacySum != fastSum) {
+    std::fprintf(stderr, "parsers disagree!\n");
+    return -1;
+  }
+
+  f64 count = static_cast<f64>(numbers.size());
+  std::printf("fields:   %lu\n", numbers.size());
+  std::printf("toU64:    %.2f ns/field\n", legacyBest / count * 1e9);
+  std::printf("parseU64: %.2f ns/field\n", fastBest / count * 1e9);
+  std::printf("speedup:  %.2fx\n", legacyBest / fastBest);
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "parse/util.h"
+
+#include <ex/Exception.h>
+#include <gtest/gtest.h>
+#include <prim/prim.h>
+
+TEST(util, toU64) {
+  ASSERT_EQ(toU64("0"), 0lu);
+  ASSERT_EQ(toU64("123"), 123lu);
+  ASSERT_EQ(toU64("0x10"), 16lu);
+  ASSERT_THROW(toU64("12a"), ex::Exception);
+}
+
+TEST(util, parseU64) {
+  u64 val;
+  ASSERT_TRUE(parseU64("0", &val));
+  ASSERT_EQ(val, 0lu);
+  ASSERT_TRUE(parseU64("9180000", &val));
+  ASSERT_EQ(val, 9180000lu);
+  ASSERT_TRUE(parseU64("60129542237", &val));
+  ASSERT_EQ(val, 60129542237lu);
+  ASSERT_TRUE(parseU64("1234567890123456789", &val));
+  ASSERT_EQ(val, 1234567890123456789lu);
+  ASSERT_TRUE(parseU64("18446744073709551615", &val));
+  ASSERT_EQ(val, U64_MAX);
+  ASSERT_TRUE(parseU64("000000000000000000000042", &val));
+  ASSERT_EQ(val, 42lu);
+
+  ASSERT_FALSE(parseU64("18446744073709551616", &val));
+  ASSERT_FALSE(parseU64("99999999999999999999", &val));
+  ASSERT_FALSE(parseU64("", &val));
+  ASSERT_FALSE(parseU64("-1", &val));
+  ASSERT_FALSE(parseU64("12a", &val));
+  ASSERT_FALSE(parseU64("1234567a", &val));
+  ASSERT_FALSE(parseU64("12345678:", &val));
+  ASSERT_FALSE(parseU64(" 12", &val));
+}
+
+TEST(util, parseU32) {
+  u32 val;
+  ASSERT_TRUE(parseU32("4294967295", &val));
+  ASSERT_EQ(val, U32_MAX);
+  ASSERT_FALSE(parseU32("4294967296", &val));
+  ASSERT_FALSE(parseU32("x", &val));
+}
+
+TEST(util, parseF64) {
+  f64 val;
+  ASSERT_TRUE(parseF64("1.5", &val));
+  ASSERT_EQ(val, 1.5);
+  ASSERT_TRUE(parseF64("100", &val));
+  ASSERT_EQ(val, 100.0);
+  ASSERT_FALSE(parseF64("1.5x", &val));
+  ASSERT_FALSE(parseF64("", &val));
+}
+
+TEST(util, split) {
+  std::string_view words[4];
+  ASSERT_EQ(split("+T,1,2", words, 4), 3lu);
+  ASSERT_EQ(words[0], "+T");
+  ASSERT_EQ(words[1], "1");
+  ASSERT_EQ(words[2], "2");
+
+  ASSERT_EQ(split("a,,b,", words, 4), 3lu);
+  ASSERT_EQ(words[1], "");
+  ASSERT_EQ(words[2], "b");
+
+  ASSERT_EQ(split("a,b,c,d,e,f", words, 4), 6lu);
+  ASSERT_EQ(words[3], "d");
+
+  ASSERT_EQ(split("", words, 4), 0lu);
+}